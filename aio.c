@@ -0,0 +1,445 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+#include "aio.h"
+
+// Configuração global
+static int cfg_engine = AIO_ENGINE_NONE;
+static unsigned cfg_depth = AIO_DEFAULT_DEPTH;
+static unsigned cfg_chunk = AIO_DEFAULT_CHUNK;
+
+#define REQ_READ 0
+#define REQ_WRITE 1
+
+// Uma operação de E/S em voo
+struct aio_req {
+    int op;
+    int fd;
+    void *buf;
+    size_t len;
+    off_t off;
+    ssize_t res;              // Bytes transferidos ou -errno
+    struct iovec iov;
+    struct aio_req *next;     // Encadeamento nas filas do pool de threads
+};
+
+// Interface comum dos motores
+struct aio_engine {
+    int type;
+    int (*submit)(struct aio_engine *e, struct aio_req *req);
+    struct aio_req *(*wait)(struct aio_engine *e);   // Bloqueia até uma conclusão
+    void (*destroy)(struct aio_engine *e);
+};
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// --- MOTOR IO_URING (SYSCALLS DIRETAS) ---
+
+struct uring_engine {
+    struct aio_engine base;
+    int fd;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_ptr, *cq_ptr;
+    size_t sq_len, cq_len, sqes_len;
+    unsigned to_submit;       // SQEs preenchidas e ainda não entregues ao kernel
+};
+
+static int uring_submit(struct aio_engine *e, struct aio_req *req) {
+    struct uring_engine *r = (struct uring_engine *)e;
+
+    unsigned tail = *r->sq_tail;
+    unsigned idx = tail & *r->sq_mask;
+    struct io_uring_sqe *sqe = &r->sqes[idx];
+
+    req->iov.iov_base = req->buf;
+    req->iov.iov_len = req->len;
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = (req->op == REQ_READ) ? IORING_OP_READV : IORING_OP_WRITEV;
+    sqe->fd = req->fd;
+    sqe->addr = (uint64_t)(uintptr_t)&req->iov;
+    sqe->len = 1;
+    sqe->off = (uint64_t)req->off;
+    sqe->user_data = (uint64_t)(uintptr_t)req;
+
+    r->sq_array[idx] = idx;
+    __atomic_store_n(r->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    r->to_submit++;
+    return 0;
+}
+
+static struct aio_req *uring_wait(struct aio_engine *e) {
+    struct uring_engine *r = (struct uring_engine *)e;
+
+    while (1) {
+        unsigned head = *r->cq_head;
+        unsigned tail = __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE);
+        if (head != tail) {
+            struct io_uring_cqe *cqe = &r->cqes[head & *r->cq_mask];
+            struct aio_req *req = (struct aio_req *)(uintptr_t)cqe->user_data;
+            req->res = cqe->res;
+            __atomic_store_n(r->cq_head, head + 1, __ATOMIC_RELEASE);
+            return req;
+        }
+
+        // Entrega as SQEs pendentes e espera pelo menos uma conclusão
+        int ret = (int)syscall(__NR_io_uring_enter, r->fd, r->to_submit, 1,
+                               IORING_ENTER_GETEVENTS, NULL, 0);
+        if (ret < 0) {
+            if (errno == EINTR) continue;
+            perror("io_uring_enter");
+            return NULL;
+        }
+        r->to_submit = ((unsigned)ret >= r->to_submit) ? 0 : r->to_submit - (unsigned)ret;
+    }
+}
+
+static void uring_destroy(struct aio_engine *e) {
+    struct uring_engine *r = (struct uring_engine *)e;
+    if (r->sqes) munmap(r->sqes, r->sqes_len);
+    if (r->cq_ptr && r->cq_ptr != r->sq_ptr) munmap(r->cq_ptr, r->cq_len);
+    if (r->sq_ptr) munmap(r->sq_ptr, r->sq_len);
+    close(r->fd);
+    free(r);
+}
+
+static struct aio_engine *uring_create(unsigned depth) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+
+    int fd = (int)syscall(__NR_io_uring_setup, depth, &p);
+    if (fd < 0) return NULL;
+
+    struct uring_engine *r = calloc(1, sizeof(*r));
+    if (!r) { close(fd); return NULL; }
+    r->fd = fd;
+
+    r->sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r->cq_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    int single_mmap = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap && r->cq_len > r->sq_len) r->sq_len = r->cq_len;
+
+    r->sq_ptr = mmap(NULL, r->sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     fd, IORING_OFF_SQ_RING);
+    if (r->sq_ptr == MAP_FAILED) { r->sq_ptr = NULL; uring_destroy(&r->base); return NULL; }
+
+    if (single_mmap) {
+        r->cq_ptr = r->sq_ptr;
+    } else {
+        r->cq_ptr = mmap(NULL, r->cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         fd, IORING_OFF_CQ_RING);
+        if (r->cq_ptr == MAP_FAILED) { r->cq_ptr = NULL; uring_destroy(&r->base); return NULL; }
+    }
+
+    r->sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+    r->sqes = mmap(NULL, r->sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   fd, IORING_OFF_SQES);
+    if (r->sqes == MAP_FAILED) { r->sqes = NULL; uring_destroy(&r->base); return NULL; }
+
+    unsigned char *sq = r->sq_ptr, *cq = r->cq_ptr;
+    r->sq_head = (unsigned *)(sq + p.sq_off.head);
+    r->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+    r->sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+    r->sq_array = (unsigned *)(sq + p.sq_off.array);
+    r->cq_head = (unsigned *)(cq + p.cq_off.head);
+    r->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+    r->cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+    r->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+
+    r->base.type = AIO_ENGINE_URING;
+    r->base.submit = uring_submit;
+    r->base.wait = uring_wait;
+    r->base.destroy = uring_destroy;
+    return &r->base;
+}
+
+// --- MOTOR POOL DE THREADS (FALLBACK) ---
+
+struct pool_engine {
+    struct aio_engine base;
+    pthread_t *threads;
+    unsigned nthreads;
+    pthread_mutex_t lock;
+    pthread_cond_t sq_cond, cq_cond;
+    struct aio_req *sq_head, *sq_tail;   // Submetidas
+    struct aio_req *cq_head, *cq_tail;   // Concluídas
+    int stop;
+};
+
+static void *pool_worker(void *arg) {
+    struct pool_engine *p = arg;
+
+    pthread_mutex_lock(&p->lock);
+    while (1) {
+        while (!p->stop && !p->sq_head) pthread_cond_wait(&p->sq_cond, &p->lock);
+        if (!p->sq_head) break;
+
+        struct aio_req *req = p->sq_head;
+        p->sq_head = req->next;
+        if (!p->sq_head) p->sq_tail = NULL;
+        pthread_mutex_unlock(&p->lock);
+
+        ssize_t ret = (req->op == REQ_READ) ? pread(req->fd, req->buf, req->len, req->off)
+                                            : pwrite(req->fd, req->buf, req->len, req->off);
+        req->res = (ret < 0) ? -errno : ret;
+
+        pthread_mutex_lock(&p->lock);
+        req->next = NULL;
+        if (p->cq_tail) p->cq_tail->next = req; else p->cq_head = req;
+        p->cq_tail = req;
+        pthread_cond_signal(&p->cq_cond);
+    }
+    pthread_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+static int pool_submit(struct aio_engine *e, struct aio_req *req) {
+    struct pool_engine *p = (struct pool_engine *)e;
+    req->next = NULL;
+    pthread_mutex_lock(&p->lock);
+    if (p->sq_tail) p->sq_tail->next = req; else p->sq_head = req;
+    p->sq_tail = req;
+    pthread_cond_signal(&p->sq_cond);
+    pthread_mutex_unlock(&p->lock);
+    return 0;
+}
+
+static struct aio_req *pool_wait(struct aio_engine *e) {
+    struct pool_engine *p = (struct pool_engine *)e;
+    pthread_mutex_lock(&p->lock);
+    while (!p->cq_head) pthread_cond_wait(&p->cq_cond, &p->lock);
+    struct aio_req *req = p->cq_head;
+    p->cq_head = req->next;
+    if (!p->cq_head) p->cq_tail = NULL;
+    pthread_mutex_unlock(&p->lock);
+    return req;
+}
+
+static void pool_destroy(struct aio_engine *e) {
+    struct pool_engine *p = (struct pool_engine *)e;
+    pthread_mutex_lock(&p->lock);
+    p->stop = 1;
+    pthread_cond_broadcast(&p->sq_cond);
+    pthread_mutex_unlock(&p->lock);
+    for (unsigned i = 0; i < p->nthreads; i++) pthread_join(p->threads[i], NULL);
+    pthread_mutex_destroy(&p->lock);
+    pthread_cond_destroy(&p->sq_cond);
+    pthread_cond_destroy(&p->cq_cond);
+    free(p->threads);
+    free(p);
+}
+
+static struct aio_engine *pool_create(unsigned depth) {
+    struct pool_engine *p = calloc(1, sizeof(*p));
+    if (!p) return NULL;
+
+    p->threads = calloc(depth, sizeof(pthread_t));
+    if (!p->threads) { free(p); return NULL; }
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->sq_cond, NULL);
+    pthread_cond_init(&p->cq_cond, NULL);
+
+    p->base.type = AIO_ENGINE_THREADS;
+    p->base.submit = pool_submit;
+    p->base.wait = pool_wait;
+    p->base.destroy = pool_destroy;
+
+    for (unsigned i = 0; i < depth; i++) {
+        if (pthread_create(&p->threads[i], NULL, pool_worker, p) != 0) break;
+        p->nthreads++;
+    }
+    if (p->nthreads == 0) { pool_destroy(&p->base); return NULL; }
+    return &p->base;
+}
+
+// Cria o motor pedido; io_uring cai para o pool de threads se o kernel recusar
+static struct aio_engine *engine_create(int type, unsigned depth) {
+    if (type == AIO_ENGINE_URING) {
+        struct aio_engine *e = uring_create(depth);
+        if (e) return e;
+        printf("[AIO] io_uring indisponivel (%s), usando pool de threads.\n", strerror(errno));
+    }
+    return pool_create(depth);
+}
+
+// --- CONFIGURAÇÃO ---
+
+void aio_configure(int engine, unsigned depth, unsigned chunk_size) {
+    cfg_engine = engine;
+    if (depth == 0) depth = AIO_DEFAULT_DEPTH;
+    if (depth > AIO_MAX_DEPTH) depth = AIO_MAX_DEPTH;
+    cfg_depth = depth;
+    if (chunk_size < AIO_ALIGN) chunk_size = AIO_DEFAULT_CHUNK;
+    cfg_chunk = (chunk_size + AIO_ALIGN - 1) / AIO_ALIGN * AIO_ALIGN;
+}
+
+int aio_enabled(void) {
+    return cfg_engine != AIO_ENGINE_NONE;
+}
+
+const char *aio_engine_name(int engine) {
+    switch (engine) {
+        case AIO_ENGINE_URING: return "io_uring";
+        case AIO_ENGINE_THREADS: return "threads";
+        default: return "sync";
+    }
+}
+
+// --- CÓPIA COM FILA PROFUNDA ---
+
+// Cada slot transporta um pedaço: lê da origem para o buffer e depois grava no destino
+struct copy_slot {
+    struct aio_req req;       // Primeiro membro: permite voltar do req para o slot
+    unsigned char *buf;
+    unsigned long chunk_off;  // Deslocamento relativo ao início da cópia
+    size_t chunk_len;
+    size_t filled;
+    size_t written;
+    int busy;
+};
+
+static void slot_read(struct aio_engine *e, struct copy_slot *s, int fd, off_t base) {
+    s->req.op = REQ_READ;
+    s->req.fd = fd;
+    s->req.buf = s->buf + s->filled;
+    s->req.len = s->chunk_len - s->filled;
+    s->req.off = base + (off_t)(s->chunk_off + s->filled);
+    e->submit(e, &s->req);
+}
+
+static void slot_write(struct aio_engine *e, struct copy_slot *s, int fd, off_t base) {
+    s->req.op = REQ_WRITE;
+    s->req.fd = fd;
+    s->req.buf = s->buf + s->written;
+    s->req.len = s->filled - s->written;
+    s->req.off = base + (off_t)(s->chunk_off + s->written);
+    e->submit(e, &s->req);
+}
+
+int aio_copy(int src_fd, off_t src_off, int dst_fd, off_t dst_off,
+             unsigned long len, struct aio_stats *stats) {
+    struct aio_stats st;
+    memset(&st, 0, sizeof(st));
+    st.engine = cfg_engine;
+
+    if (len == 0) {
+        if (stats) *stats = st;
+        return 0;
+    }
+    if (src_fd < 0 || dst_fd < 0) return -1;   // FILE* sem descritor (ex.: volume em faixas)
+
+    unsigned long chunks = (len + cfg_chunk - 1) / cfg_chunk;
+    unsigned nslots = (chunks < cfg_depth) ? (unsigned)chunks : cfg_depth;
+
+    struct aio_engine *e = engine_create(cfg_engine, nslots);
+    if (!e) {
+        printf("Erro: nao foi possivel iniciar o motor de E/S assincrona.\n");
+        return -1;
+    }
+    st.engine = e->type;
+
+    struct copy_slot *slots = calloc(nslots, sizeof(struct copy_slot));
+    int error = (slots == NULL);
+    for (unsigned i = 0; !error && i < nslots; i++) {
+        if (posix_memalign((void **)&slots[i].buf, AIO_ALIGN, cfg_chunk) != 0) error = 1;
+    }
+
+    unsigned long next = 0;
+    unsigned inflight = 0;
+    double depth_sum = 0;
+    unsigned long samples = 0;
+    uint64_t t0 = now_ns();
+
+    while (!error && (next < len || inflight > 0)) {
+        // Mantém todos os slots ocupados
+        for (unsigned i = 0; i < nslots && next < len; i++) {
+            struct copy_slot *s = &slots[i];
+            if (s->busy) continue;
+            s->chunk_off = next;
+            s->chunk_len = (len - next < cfg_chunk) ? (size_t)(len - next) : cfg_chunk;
+            s->filled = 0;
+            s->written = 0;
+            s->busy = 1;
+            next += s->chunk_len;
+            slot_read(e, s, src_fd, src_off);
+            inflight++;
+        }
+
+        depth_sum += inflight;
+        samples++;
+        if (inflight > st.max_depth) st.max_depth = inflight;
+
+        struct aio_req *req = e->wait(e);
+        if (!req) { error = 1; break; }
+        inflight--;
+        st.ops++;
+
+        struct copy_slot *s = (struct copy_slot *)req;
+        if (req->res < 0) {
+            printf("Erro de E/S assincrona: %s\n", strerror((int)-req->res));
+            error = 1;
+            break;
+        }
+
+        if (req->op == REQ_READ) {
+            if (req->res == 0) {
+                printf("Erro: fim inesperado da origem.\n");
+                error = 1;
+                break;
+            }
+            s->filled += (size_t)req->res;
+            if (s->filled < s->chunk_len) slot_read(e, s, src_fd, src_off);   // Leitura curta
+            else slot_write(e, s, dst_fd, dst_off);
+            inflight++;
+        } else {
+            s->written += (size_t)req->res;
+            st.bytes += (unsigned long)req->res;
+            if (s->written < s->filled) {
+                slot_write(e, s, dst_fd, dst_off);   // Escrita curta
+                inflight++;
+            } else {
+                s->busy = 0;
+            }
+        }
+    }
+
+    // Em caso de erro, espera o que ainda está em voo antes de liberar os buffers
+    while (inflight > 0 && e->wait(e)) inflight--;
+
+    st.elapsed_ns = now_ns() - t0;
+    st.avg_depth = samples ? depth_sum / samples : 0;
+
+    e->destroy(e);
+    if (slots) {
+        for (unsigned i = 0; i < nslots; i++) free(slots[i].buf);
+        free(slots);
+    }
+
+    if (stats) *stats = st;
+    return error ? -1 : 0;
+}
+
+void aio_print_stats(const struct aio_stats *stats) {
+    double secs = stats->elapsed_ns / 1e9;
+    double mbps = (secs > 0) ? (stats->bytes / (1024.0 * 1024.0)) / secs : 0;
+    printf("[AIO %s] %lu bytes em %.3f ms | %.1f MB/s | QD media %.2f (max %u) | %lu ops\n",
+           aio_engine_name(stats->engine), stats->bytes, stats->elapsed_ns / 1e6, mbps,
+           stats->avg_depth, stats->max_depth, stats->ops);
+}
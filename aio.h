@@ -0,0 +1,42 @@
+#ifndef AIO_H
+#define AIO_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+// --- CONFIGURAÇÕES DO MOTOR ASSÍNCRONO ---
+#define AIO_ENGINE_NONE    0   // Caminho síncrono original (stdio)
+#define AIO_ENGINE_URING   1   // io_uring via syscalls diretas
+#define AIO_ENGINE_THREADS 2   // Pool de threads com pread/pwrite
+
+#define AIO_DEFAULT_DEPTH 8
+#define AIO_DEFAULT_CHUNK (1024 * 1024)
+#define AIO_MAX_DEPTH 256
+#define AIO_ALIGN 4096
+
+// --- ESTRUTURAS ---
+
+// Resultado de uma transferência
+struct aio_stats {
+    int engine;               // Motor efetivamente usado
+    unsigned long bytes;
+    uint64_t elapsed_ns;
+    unsigned long ops;        // Leituras + escritas concluídas
+    double avg_depth;         // Profundidade média da fila observada
+    unsigned max_depth;
+};
+
+// --- PROTÓTIPOS DAS FUNÇÕES ---
+
+// Configuração global (lida de SACS_AIO / SACS_AIO_DEPTH pelo main)
+void aio_configure(int engine, unsigned depth, unsigned chunk_size);
+int aio_enabled(void);
+const char *aio_engine_name(int engine);
+
+// Copia len bytes de src_fd:src_off para dst_fd:dst_off mantendo várias operações em voo.
+// Retorna 0 em sucesso, -1 em erro de E/S.
+int aio_copy(int src_fd, off_t src_off, int dst_fd, off_t dst_off,
+             unsigned long len, struct aio_stats *stats);
+void aio_print_stats(const struct aio_stats *stats);
+
+#endif // AIO_H
@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include "sacs.h"
+
+// Benchmark das políticas de alocação: envelhece um volume com criações e remoções
+// aleatórias e compara vazão e fragmentação resultante.
+// Uso: sacs_bench_alloc [imagem] [operacoes] [semente]
+// A saída das funções da API vai para stdout; o relatório vai para stderr.
+
+#define BENCH_SECTORS 262144   // 128 MB com setores de 512 bytes
+#define BENCH_BLOCK 3          // Blocos de 4 KB
+#define BENCH_DIRS 16
+#define BENCH_MAX_LIVE (BENCH_DIRS * 100)
+
+struct live_file {
+    int dir;
+    char name[17];
+};
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Varre o bitmap e mede a fragmentação do espaço livre
+static void measure_free_space(FILE *fp, struct superblock *sup, unsigned *free_blocks,
+                               unsigned *free_runs, unsigned *largest) {
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    unsigned long bytes = (sup->total_blocks + 7) / 8;
+    unsigned char *bm = calloc(1, bytes);
+    fseek(fp, (unsigned long)sup->bitmap_start * real_block_size, SEEK_SET);
+    fread(bm, 1, bytes, fp);
+
+    unsigned run = 0;
+    *free_blocks = *free_runs = *largest = 0;
+    for (unsigned b = 0; b < sup->total_blocks; b++) {
+        if (!get_bit(bm, b)) {
+            (*free_blocks)++;
+            run++;
+        } else if (run) {
+            (*free_runs)++;
+            if (run > *largest) *largest = run;
+            run = 0;
+        }
+    }
+    if (run) {
+        (*free_runs)++;
+        if (run > *largest) *largest = run;
+    }
+    free(bm);
+}
+
+static void run_policy(const char *image, int policy, unsigned ops, unsigned seed) {
+    format_sacs(image, SACS, BENCH_SECTORS, 9, BENCH_BLOCK, 4);
+    FILE *fp = fopen(image, "r+b");
+    struct superblock sup;
+    if (!fp || !mount_sacs(fp, &sup, policy)) {
+        fprintf(stderr, "Erro ao montar %s\n", image);
+        if (fp) fclose(fp);
+        return;
+    }
+    unsigned real_block_size = (1 << sup.sector_size) << sup.block_size;
+
+    struct dir_entry root, dirs[BENCH_DIRS];
+    fseek(fp, (unsigned long)sup.root_start * real_block_size, SEEK_SET);
+    read_entry(fp, &root);
+
+    for (int d = 0; d < BENCH_DIRS; d++) {
+        char name[17];
+        snprintf(name, sizeof(name), "d%02d", d);
+        create_dir(fp, &root, &sup, name);
+        dirs[d] = root;
+        change_directory(fp, &dirs[d], &sup, name);
+    }
+
+    struct live_file *live = calloc(BENCH_MAX_LIVE, sizeof(struct live_file));
+    unsigned live_count = 0, serial = 0, creates = 0, deletes = 0, failures = 0;
+    unsigned long used_bytes = 0;
+    unsigned long capacity = (unsigned long)sup.total_blocks * real_block_size;
+    srand(seed);
+
+    double t0 = now_sec();
+    for (unsigned op = 0; op < ops; op++) {
+        int do_create = live_count == 0 ||
+                        (live_count < BENCH_MAX_LIVE && used_bytes < capacity * 8 / 10 && rand() % 100 < 60);
+        if (do_create) {
+            int d = rand() % BENCH_DIRS;
+            // 1 a 64 blocos, com viés para arquivos menores
+            unsigned blocks = 1 + (unsigned)(rand() % 64) * (unsigned)(rand() % 64) / 64;
+            unsigned size = blocks * real_block_size - (unsigned)(rand() % (real_block_size / 2));
+            struct live_file *f = &live[live_count];
+            f->dir = d;
+            snprintf(f->name, sizeof(f->name), "f%u", serial++);
+
+            unsigned before = dirs[d].size;
+            create_file(fp, &dirs[d], &sup, f->name, size, NULL);
+            if (dirs[d].size != before) {
+                live_count++;
+                used_bytes += (unsigned long)blocks * real_block_size;
+                creates++;
+            } else {
+                failures++;
+            }
+        } else {
+            unsigned idx = (unsigned)rand() % live_count;
+            struct live_file *f = &live[idx];
+            struct dir_entry entry;
+            if (find_entry(fp, &dirs[f->dir], f->name, real_block_size, &entry) >= 0) {
+                used_bytes -= (unsigned long)((entry.size + real_block_size - 1) / real_block_size) * real_block_size;
+            }
+            delete_item(fp, &dirs[f->dir], &sup, f->name);
+            live[idx] = live[--live_count];
+            deletes++;
+        }
+    }
+    fflush(fp);
+    double elapsed = now_sec() - t0;
+
+    // Distância média entre o arquivo e o bloco do diretório pai
+    double dist_sum = 0;
+    for (unsigned i = 0; i < live_count; i++) {
+        struct dir_entry entry;
+        if (find_entry(fp, &dirs[live[i].dir], live[i].name, real_block_size, &entry) >= 0) {
+            long dist = (long)entry.start_block - (long)dirs[live[i].dir].start_block;
+            dist_sum += (dist < 0) ? -dist : dist;
+        }
+    }
+
+    unsigned free_blocks, free_runs, largest;
+    measure_free_space(fp, &sup, &free_blocks, &free_runs, &largest);
+    double frag = free_blocks ? 1.0 - (double)largest / free_blocks : 0;
+
+    fprintf(stderr, "%-11s %9.0f %7u %7u %6u %8u %7u %8u %6.3f %10.0f\n",
+            alloc_policy_name(policy), ops / elapsed, creates, deletes, failures,
+            free_blocks, free_runs, largest, frag, live_count ? dist_sum / live_count : 0);
+
+    free(live);
+    fclose(fp);
+}
+
+int main(int argc, char **argv) {
+    const char *image = (argc > 1) ? argv[1] : "bench_alloc.img";
+    unsigned ops = (argc > 2) ? (unsigned)strtoul(argv[2], NULL, 10) : 20000;
+    unsigned seed = (argc > 3) ? (unsigned)strtoul(argv[3], NULL, 10) : 42;
+
+    fprintf(stderr, "%-11s %9s %7s %7s %6s %8s %7s %8s %6s %10s\n",
+            "Politica", "ops/s", "creates", "deletes", "falhas", "livres", "trechos", "maior", "frag", "dist_pai");
+    int policies[] = { ALLOC_BEST_FIT, ALLOC_NEXT_FIT, ALLOC_SEGREGATED, ALLOC_LOCALITY };
+    for (int p = 0; p < 4; p++) {
+        run_policy(image, policies[p], ops, seed);
+    }
+    remove(image);
+    return 0;
+}
@@ -0,0 +1,142 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "sacs.h"
+#include "dio.h"
+
+// Benchmark da E/S direta: importa e exporta um arquivo grande com e sem O_DIRECT e
+// compara a vazão (incluindo o fsync) e quanto de cada arquivo ficou no page cache.
+// Uso: sacs_bench_direct [imagem] [MB] [tamanho_do_bloco]
+// A saída das funções da API vai para stdout; o relatório vai para stderr.
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Páginas do arquivo residentes no page cache (MB)
+static double resident_mb(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    struct stat sb;
+    fstat(fd, &sb);
+    if (sb.st_size == 0) { close(fd); return 0; }
+
+    long page = sysconf(_SC_PAGESIZE);
+    size_t pages = (sb.st_size + page - 1) / page;
+    void *map = mmap(NULL, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    unsigned char *vec = malloc(pages);
+    unsigned long resident = 0;
+    if (map != MAP_FAILED && vec && mincore(map, sb.st_size, vec) == 0) {
+        for (size_t i = 0; i < pages; i++) resident += vec[i] & 1;
+    }
+    if (map != MAP_FAILED) munmap(map, sb.st_size);
+    free(vec);
+    close(fd);
+    return resident * (double)page / (1024.0 * 1024.0);
+}
+
+// Grava no disco e tira o arquivo do page cache, para cada rodada começar fria
+static void drop_cache(const char *path) {
+    int fd = open(path, O_RDWR);
+    if (fd < 0) return;
+    fsync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+static void sync_file(const char *path) {
+    int fd = open(path, O_RDWR);
+    if (fd < 0) return;
+    fdatasync(fd);
+    close(fd);
+}
+
+static void make_source(const char *path, unsigned mb) {
+    FILE *f = fopen(path, "wb");
+    unsigned char *chunk = malloc(1024 * 1024);
+    for (unsigned i = 0; i < 1024 * 1024; i++) chunk[i] = (unsigned char)(i * 31 + 7);
+    for (unsigned i = 0; i < mb; i++) {
+        chunk[0] = (unsigned char)i;
+        fwrite(chunk, 1, 1024 * 1024, f);
+    }
+    fwrite(chunk, 1, 1234, f);   // Cauda desalinhada
+    free(chunk);
+    fclose(f);
+}
+
+static void run_mode(const char *image, const char *source, const char *dest, int direct, unsigned mb) {
+    dio_configure(direct, DIO_DEFAULT_BUFFER);
+    const char *label = direct ? "direto" : "buffer";
+
+    FILE *fp = fopen(image, "r+b");
+    struct superblock sup;
+    if (!fp || !mount_sacs(fp, &sup, ALLOC_BEST_FIT)) {
+        fprintf(stderr, "Erro ao montar %s\n", image);
+        if (fp) fclose(fp);
+        return;
+    }
+    unsigned real_block_size = (1 << sup.sector_size) << sup.block_size;
+    struct dir_entry root;
+    fseek(fp, (unsigned long)sup.root_start * real_block_size, SEEK_SET);
+    read_entry(fp, &root);
+
+    // Importação: origem e imagem frias
+    delete_item(fp, &root, &sup, strrchr(source, '/') ? strrchr(source, '/') + 1 : (char *)source);
+    fflush(fp);
+    drop_cache(source);
+    drop_cache(image);
+    double t0 = now_sec();
+    import_file(fp, &root, &sup, (char *)source);
+    fflush(fp);
+    sync_file(image);
+    double t_import = now_sec() - t0;
+    double src_res = resident_mb(source), img_res = resident_mb(image);
+
+    // Exportação: imagem fria, destino novo
+    remove(dest);
+    drop_cache(image);
+    t0 = now_sec();
+    export_file(fp, &root, &sup, strrchr(source, '/') ? strrchr(source, '/') + 1 : (char *)source, (char *)dest);
+    sync_file(dest);
+    double t_export = now_sec() - t0;
+    double img_res2 = resident_mb(image), dst_res = resident_mb(dest);
+
+    fprintf(stderr, "%-7s %12.1f %10.1f %10.1f %12.1f %10.1f %10.1f\n", label,
+            mb / t_import, src_res, img_res, mb / t_export, img_res2, dst_res);
+    fclose(fp);
+}
+
+int main(int argc, char **argv) {
+    const char *image = (argc > 1) ? argv[1] : "bench_direct.img";
+    unsigned mb = (argc > 2) ? (unsigned)strtoul(argv[2], NULL, 10) : 256;
+    unsigned short block = (argc > 3) ? (unsigned short)strtoul(argv[3], NULL, 10) : 3;
+    if (mb == 0) mb = 256;
+
+    char source[256], dest[256];
+    snprintf(source, sizeof(source), "%s.src", image);
+    snprintf(dest, sizeof(dest), "%s.out", image);
+
+    make_source(source, mb);
+    uint64_t sectors = ((uint64_t)mb + 16) * 2048 * 2;   // Espaço para o arquivo e folga
+    format_sacs(image, SACS_V2, sectors, 9, block, 4);
+
+    fprintf(stderr, "%u MB, blocos de %u bytes (cache em MB apos cada fase)\n", mb, (512u << block));
+    fprintf(stderr, "%-7s %12s %10s %10s %12s %10s %10s\n",
+            "Modo", "import MB/s", "cache src", "cache img", "export MB/s", "cache img", "cache dst");
+    run_mode(image, source, dest, 0, mb);
+    run_mode(image, source, dest, 1, mb);
+
+    remove(source);
+    remove(dest);
+    remove(image);
+    return 0;
+}
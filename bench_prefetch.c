@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include "sacs.h"
+#include "prefetch.h"
+
+// Benchmark de leitura antecipada com cache frio: exporta um arquivo grande e lista uma
+// árvore de diretórios espalhados entre arquivos, com e sem prefetch. Antes de cada
+// medida as páginas da imagem são descartadas do page cache (POSIX_FADV_DONTNEED).
+// Uso: sacs_bench_prefetch [imagem] [MB do arquivo] [diretórios]
+// A saída das funções da API vai para /dev/null; o relatório vai para stderr.
+
+#define BENCH_SECTORS 2097152   // 1 GB com setores de 512 bytes
+#define BENCH_BLOCK_SHIFT 3     // Blocos de 4 KB
+#define BENCH_ROOT_BLOCKS 64
+#define BENCH_SUBDIRS 8
+#define BENCH_FILLER (64 * 1024)   // Arquivo entre subdiretórios, para espalhá-los
+#define BENCH_RUNS 3
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void drop_cache(FILE *fp) {
+    fflush(fp);
+    fsync(fileno(fp));
+    posix_fadvise(fileno(fp), 0, 0, POSIX_FADV_DONTNEED);
+}
+
+static int build_volume(const char *image, unsigned file_mb, unsigned dirs, FILE **out_fp,
+                        struct superblock *sup, struct dir_entry *root) {
+    format_sacs(image, SACS_V2, BENCH_SECTORS, 9, BENCH_BLOCK_SHIFT, BENCH_ROOT_BLOCKS);
+    FILE *fp = fopen(image, "r+b");
+    if (!fp || !mount_sacs(fp, sup, ALLOC_BEST_FIT)) {
+        if (fp) fclose(fp);
+        return 0;
+    }
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    fseek(fp, (unsigned long)sup->root_start * real_block_size, SEEK_SET);
+    read_entry(fp, root);
+
+    // Arquivo grande: origem esparsa, o conteúdo não importa
+    char tmp_dir[] = "/tmp/sacs_bench_XXXXXX";
+    char src[64];
+    if (!mkdtemp(tmp_dir)) {
+        fclose(fp);
+        return 0;
+    }
+    snprintf(src, sizeof(src), "%s/grande", tmp_dir);
+    FILE *f = fopen(src, "wb");
+    int ok = f && ftruncate(fileno(f), (off_t)file_mb << 20) == 0;
+    if (f) fclose(f);
+    if (ok) import_file(fp, root, sup, src);
+    remove(src);
+    rmdir(tmp_dir);
+    if (!ok || find_entry(fp, root, "grande", real_block_size, NULL) < 0) {
+        fclose(fp);
+        return 0;
+    }
+
+    char *filler = calloc(1, BENCH_FILLER);
+    char name[17];
+    for (unsigned i = 0; i < dirs; i++) {
+        struct dir_entry dir;
+        snprintf(name, sizeof(name), "d%u", i);
+        create_dir(fp, root, sup, name);
+        if (find_entry(fp, root, name, real_block_size, &dir) < 0) break;
+        for (unsigned j = 0; j < BENCH_SUBDIRS; j++) {
+            snprintf(name, sizeof(name), "s%u", j);
+            create_dir(fp, &dir, sup, name);
+            snprintf(name, sizeof(name), "f%u", j);
+            create_file(fp, &dir, sup, name, BENCH_FILLER, filler);
+        }
+    }
+    free(filler);
+
+    *out_fp = fp;
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    const char *image = (argc > 1) ? argv[1] : "bench_prefetch.img";
+    unsigned file_mb = (argc > 2) ? (unsigned)strtoul(argv[2], NULL, 10) : 256;
+    unsigned dirs = (argc > 3) ? (unsigned)strtoul(argv[3], NULL, 10) : 200;
+
+    if (!freopen("/dev/null", "w", stdout)) return 1;
+
+    FILE *fp;
+    struct superblock sup;
+    struct dir_entry root;
+    if (!build_volume(image, file_mb, dirs, &fp, &sup, &root)) {
+        fprintf(stderr, "Erro ao preparar %s\n", image);
+        return 1;
+    }
+
+    fprintf(stderr, "%-9s %4s %12s %12s\n", "prefetch", "exec", "export MB/s", "list ms");
+    for (int enabled = 0; enabled <= 1; enabled++) {
+        prefetch_configure(enabled, PREFETCH_DEFAULT_MAX);
+        for (int run = 0; run < BENCH_RUNS; run++) {
+            drop_cache(fp);
+            double t0 = now_sec();
+            export_file(fp, &root, &sup, "grande", "/dev/null");
+            double t_export = now_sec() - t0;
+
+            drop_cache(fp);
+            t0 = now_sec();
+            list_recursive(fp, &root, &sup, 0);
+            double t_list = now_sec() - t0;
+
+            fprintf(stderr, "%-9s %4d %12.1f %12.1f\n", enabled ? "ligado" : "desligado", run + 1,
+                    file_mb / t_export, t_list * 1e3);
+        }
+    }
+
+    fclose(fp);
+    remove(image);
+    return 0;
+}
@@ -0,0 +1,165 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include "sacs_client.h"
+
+// Gerador de carga para o sacsd: N clientes, cada um com a própria conexão e o próprio
+// diretório, executam uma mistura de operações durante um tempo fixo.
+// Mistura: 40% lookup, 30% read do arquivo inteiro, 10% list, 20% import + delete.
+// Uso: sacs_bench_server <socket> [segundos] [tamanho] [clientes ...]
+//   padrão: 3 segundos, arquivos de 4096 bytes, 1 2 4 8 16 clientes
+
+#define BENCH_FILES 16
+#define LAT_BUCKETS 32   // Latência por potência de 2 em microssegundos
+
+enum { B_LOOKUP, B_READ, B_LIST, B_IMPORT, B_DELETE, B_OPS };
+static const char *bench_op_names[B_OPS] = { "lookup", "read", "list", "import", "delete" };
+
+struct bench_client {
+    pthread_t tid;
+    const char *socket_path;
+    unsigned id;
+    unsigned file_size;
+    double seconds;
+    unsigned long ops[B_OPS];
+    unsigned long errors;
+    unsigned long lat[B_OPS][LAT_BUCKETS];
+};
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void account(struct bench_client *bc, int op, double t0, long st) {
+    unsigned long us = (unsigned long)((now_sec() - t0) * 1e6);
+    unsigned b = us ? 64 - __builtin_clzl(us) : 0;
+    if (b >= LAT_BUCKETS) b = LAT_BUCKETS - 1;
+    bc->lat[op][b]++;
+    bc->ops[op]++;
+    if (st < 0) bc->errors++;
+}
+
+static void *client_main(void *arg) {
+    struct bench_client *bc = arg;
+    struct sacs_client *c = sacsc_connect(bc->socket_path);
+    if (!c) {
+        fprintf(stderr, "Cliente %u: falha ao conectar em '%s'\n", bc->id, bc->socket_path);
+        bc->errors++;
+        return NULL;
+    }
+
+    char dir[32], path[64];
+    char *data = malloc(bc->file_size ? bc->file_size : 1);
+    memset(data, 'a' + bc->id % 26, bc->file_size);
+    snprintf(dir, sizeof(dir), "/lg%u", bc->id);
+    sacsc_delete(c, dir, 1);
+    if (sacsc_mkdir(c, dir) != SACSD_OK) bc->errors++;
+    // Diretórios têm um bloco: com blocos pequenos cabem menos arquivos. Uma entrada
+    // fica livre para os temporários do import + delete
+    unsigned files = 0;
+    while (files < BENCH_FILES) {
+        snprintf(path, sizeof(path), "%s/f%u", dir, files);
+        if (sacsc_import(c, path, data, bc->file_size) != SACSD_OK) break;
+        files++;
+    }
+    if (files < BENCH_FILES && files > 1) {
+        snprintf(path, sizeof(path), "%s/f%u", dir, --files);
+        sacsc_delete(c, path, 0);
+    }
+    if (files == 0) bc->errors++;
+
+    unsigned seed = bc->id * 2654435761u + 1;
+    unsigned tmp = 0;
+    struct dir_entry entry;
+    double end = now_sec() + bc->seconds;
+    while (now_sec() < end) {
+        unsigned r = rand_r(&seed) % 100;
+        snprintf(path, sizeof(path), "%s/f%u", dir, rand_r(&seed) % (files ? files : 1));
+        double t0 = now_sec();
+        if (r < 40) {
+            account(bc, B_LOOKUP, t0, sacsc_lookup(c, path, &entry));
+        } else if (r < 70) {
+            long n = sacsc_read(c, path, data, bc->file_size, 0);
+            account(bc, B_READ, t0, (n == (long)bc->file_size) ? 0 : -1);
+        } else if (r < 80) {
+            struct dir_entry *entries;
+            long n = sacsc_list(c, dir, &entries);
+            free(entries);
+            account(bc, B_LIST, t0, n);
+        } else {
+            snprintf(path, sizeof(path), "%s/t%u", dir, tmp++);
+            account(bc, B_IMPORT, t0, sacsc_import(c, path, data, bc->file_size));
+            t0 = now_sec();
+            account(bc, B_DELETE, t0, sacsc_delete(c, path, 0));
+        }
+    }
+
+    sacsc_delete(c, dir, 1);
+    sacsc_disconnect(c);
+    free(data);
+    return NULL;
+}
+
+// Percentil a partir do histograma: limite superior do balde, em microssegundos
+static unsigned long percentile(const unsigned long *lat, unsigned long total, double p) {
+    unsigned long want = (unsigned long)(total * p), seen = 0;
+    for (unsigned b = 0; b < LAT_BUCKETS; b++) {
+        seen += lat[b];
+        if (seen > want) return 1ul << b;
+    }
+    return 1ul << (LAT_BUCKETS - 1);
+}
+
+static void run_clients(const char *socket_path, unsigned clients, double seconds, unsigned file_size) {
+    struct bench_client *bc = calloc(clients, sizeof(*bc));
+    double t0 = now_sec();
+    for (unsigned i = 0; i < clients; i++) {
+        bc[i].socket_path = socket_path;
+        bc[i].id = i;
+        bc[i].file_size = file_size;
+        bc[i].seconds = seconds;
+        pthread_create(&bc[i].tid, NULL, client_main, &bc[i]);
+    }
+    for (unsigned i = 0; i < clients; i++) pthread_join(bc[i].tid, NULL);
+    double elapsed = now_sec() - t0;
+
+    unsigned long ops[B_OPS] = {0}, lat[B_OPS][LAT_BUCKETS] = {{0}}, all = 0, errors = 0;
+    for (unsigned i = 0; i < clients; i++) {
+        errors += bc[i].errors;
+        for (int op = 0; op < B_OPS; op++) {
+            ops[op] += bc[i].ops[op];
+            all += bc[i].ops[op];
+            for (unsigned b = 0; b < LAT_BUCKETS; b++) lat[op][b] += bc[i].lat[op][b];
+        }
+    }
+
+    printf("%3u clientes: %10.0f ops/s  (%lu ops, %lu erros)\n", clients, all / elapsed, all, errors);
+    for (int op = 0; op < B_OPS; op++) {
+        if (!ops[op]) continue;
+        printf("    %-7s %10.0f ops/s  p50 <= %6lu us  p99 <= %6lu us\n", bench_op_names[op],
+               ops[op] / elapsed, percentile(lat[op], ops[op], 0.50), percentile(lat[op], ops[op], 0.99));
+    }
+    free(bc);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        printf("Uso: %s <socket> [segundos] [tamanho] [clientes ...]\n", argv[0]);
+        return 1;
+    }
+    double seconds = (argc > 2) ? atof(argv[2]) : 3.0;
+    unsigned file_size = (argc > 3) ? (unsigned)strtoul(argv[3], NULL, 10) : 4096;
+
+    if (argc > 4) {
+        for (int i = 4; i < argc; i++) run_clients(argv[1], (unsigned)atoi(argv[i]), seconds, file_size);
+    } else {
+        unsigned sweep[] = { 1, 2, 4, 8, 16 };
+        for (int i = 0; i < 5; i++) run_clients(argv[1], sweep[i], seconds, file_size);
+    }
+    return 0;
+}
@@ -0,0 +1,228 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "sacs.h"
+#include "stripe.h"
+
+// Clona uma imagem SACS copiando só os blocos alocados no bitmap; o resto do
+// destino fica como buraco (arquivo esparso). "trim" faz o mesmo no lugar: abre
+// buracos nos blocos livres de uma imagem existente.
+// Uso: sacs_clone <origem> <destino>
+//      sacs_clone trim <imagem>
+
+#define CLONE_CHUNK (4 * 1024 * 1024)
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Lê o bitmap inteiro da imagem montada
+static unsigned char *load_bitmap(FILE *fp, struct superblock *sup, unsigned real_block_size) {
+    unsigned long bytes = (unsigned long)sup->bitmap_size * real_block_size;
+    unsigned char *bm = malloc(bytes);
+    if (!bm) return NULL;
+    fseeko(fp, (off_t)sup->bitmap_start * real_block_size, SEEK_SET);
+    if (fread(bm, 1, bytes, fp) != bytes) {
+        free(bm);
+        return NULL;
+    }
+    return bm;
+}
+
+#define BIT(bm, b) (((bm)[(b) >> 3] >> ((b) & 7)) & 1)
+
+// Próximo trecho de blocos com o bit igual a 'used' a partir de *pos.
+// Retorna o tamanho do trecho (0 no fim); bytes inteiros iguais são pulados de uma vez.
+static uint64_t next_run(const unsigned char *bm, uint64_t total, uint64_t *pos, int used) {
+    unsigned char skip = used ? 0x00 : 0xFF;
+    unsigned char full = used ? 0xFF : 0x00;
+    uint64_t b = *pos;
+
+    while (b < total) {
+        if ((b & 7) == 0 && bm[b >> 3] == skip) { b += 8; continue; }
+        if (BIT(bm, b) == used) break;
+        b++;
+    }
+    if (b >= total) {
+        *pos = total;
+        return 0;
+    }
+
+    uint64_t start = b;
+    while (b < total) {
+        if ((b & 7) == 0 && b + 8 <= total && bm[b >> 3] == full) { b += 8; continue; }
+        if (BIT(bm, b) != used) break;
+        b++;
+    }
+    *pos = start;
+    return b - start;
+}
+
+// --- CLONE ---
+
+struct clone_stats {
+    uint64_t runs, copied, holes_skipped;
+};
+
+// Copia [off, off+len) da origem; trechos que já são buracos na origem são pulados
+static int copy_range(FILE *src, int src_fd, int dst_fd, off_t off, off_t len,
+                      unsigned char *buf, struct clone_stats *st) {
+    off_t end = off + len;
+    while (off < end) {
+        off_t data = off, hole = end;
+        if (src_fd >= 0) {
+            data = lseek(src_fd, off, SEEK_DATA);
+            if (data < 0 || data >= end) {   // Só buraco até o fim do trecho
+                st->holes_skipped += end - off;
+                return 1;
+            }
+            hole = lseek(src_fd, data, SEEK_HOLE);
+            if (hole < 0 || hole > end) hole = end;
+            st->holes_skipped += data - off;
+        }
+
+        for (off_t pos = data; pos < hole; ) {
+            size_t chunk = (hole - pos < CLONE_CHUNK) ? (size_t)(hole - pos) : CLONE_CHUNK;
+            ssize_t r;
+            if (src_fd >= 0) {
+                r = pread(src_fd, buf, chunk, pos);
+            } else {
+                fseeko(src, pos, SEEK_SET);
+                r = (ssize_t)fread(buf, 1, chunk, src);
+            }
+            if (r <= 0) return 0;
+            for (ssize_t w = 0; w < r; ) {
+                ssize_t n = pwrite(dst_fd, buf + w, (size_t)(r - w), pos + w);
+                if (n <= 0) return 0;
+                w += n;
+            }
+            pos += r;
+            st->copied += (uint64_t)r;
+        }
+        off = hole;
+    }
+    return 1;
+}
+
+static int clone_image(const char *src_path, const char *dst_path) {
+    FILE *src = volume_open(src_path, "rb");
+    struct superblock sup;
+    if (!src || !read_superblock(src, &sup)) {
+        printf("Erro: '%s' nao e um volume SACS.\n", src_path);
+        if (src) fclose(src);
+        return 1;
+    }
+    unsigned real_block_size = (1 << sup.sector_size) << sup.block_size;
+    unsigned char *bm = load_bitmap(src, &sup, real_block_size);
+    unsigned char *buf = malloc(CLONE_CHUNK);
+    int dst_fd = open(dst_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (!bm || !buf || dst_fd < 0) {
+        printf("Erro: Falha ao preparar a copia para '%s'.\n", dst_path);
+        free(bm);
+        free(buf);
+        if (dst_fd >= 0) close(dst_fd);
+        fclose(src);
+        return 1;
+    }
+
+    // Destino com o tamanho final e todo em buraco; só os blocos alocados recebem dados
+    off_t image_size = (off_t)sup.total_blocks * real_block_size;
+    int src_fd = stripe_is(src) ? -1 : fileno(src);
+    struct clone_stats st = { 0, 0, 0 };
+    int ok = ftruncate(dst_fd, image_size) == 0;
+    double t0 = now_sec();
+
+    uint64_t pos = 0, len;
+    while (ok && (len = next_run(bm, sup.total_blocks, &pos, 1)) > 0) {
+        ok = copy_range(src, src_fd, dst_fd, (off_t)pos * real_block_size, (off_t)len * real_block_size, buf, &st);
+        st.runs++;
+        pos += len;
+    }
+    if (ok) ok = fsync(dst_fd) == 0;
+    double elapsed = now_sec() - t0;
+
+    struct stat sb;
+    fstat(dst_fd, &sb);
+    close(dst_fd);
+    fclose(src);
+    free(bm);
+    free(buf);
+
+    if (!ok) {
+        printf("Erro: Falha de E/S ao clonar: %s\n", strerror(errno));
+        return 1;
+    }
+    printf("\n--- CLONE %s -> %s ---\n", src_path, dst_path);
+    printf("Imagem: %lu bytes | Copiados: %" PRIu64 " bytes em %" PRIu64 " trechos | Buracos na origem: %" PRIu64 " bytes\n",
+           (unsigned long)image_size, st.copied, st.runs, st.holes_skipped);
+    printf("Ocupado no destino: %lu bytes | %.3f s\n", (unsigned long)sb.st_blocks * 512, elapsed);
+    return 0;
+}
+
+// --- TRIM ---
+
+static int trim_image(const char *path) {
+    FILE *fp = fopen(path, "r+b");
+    struct superblock sup;
+    if (!fp || !read_superblock(fp, &sup)) {
+        printf("Erro: '%s' nao e um volume SACS%s.\n", path, strchr(path, STRIPE_SEPARATOR) ? " simples" : "");
+        if (fp) fclose(fp);
+        return 1;
+    }
+    unsigned real_block_size = (1 << sup.sector_size) << sup.block_size;
+    unsigned char *bm = load_bitmap(fp, &sup, real_block_size);
+    if (!bm) {
+        printf("Erro: Falha ao ler o bitmap.\n");
+        fclose(fp);
+        return 1;
+    }
+    int fd = fileno(fp);
+
+    struct stat before, after;
+    fstat(fd, &before);
+    double t0 = now_sec();
+
+    uint64_t pos = 0, len, runs = 0, punched = 0;
+    int ok = 1;
+    while ((len = next_run(bm, sup.total_blocks, &pos, 0)) > 0) {
+        if (fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                      (off_t)pos * real_block_size, (off_t)len * real_block_size) != 0) {
+            printf("Erro: O sistema de arquivos nao aceitou abrir buracos: %s\n", strerror(errno));
+            ok = 0;
+            break;
+        }
+        punched += len * real_block_size;
+        runs++;
+        pos += len;
+    }
+    fsync(fd);
+    fstat(fd, &after);
+    double elapsed = now_sec() - t0;
+
+    free(bm);
+    fclose(fp);
+    printf("\n--- TRIM %s ---\n", path);
+    printf("Blocos livres descartados: %" PRIu64 " bytes em %" PRIu64 " trechos | %.3f s\n", punched, runs, elapsed);
+    printf("Ocupado: %lu -> %lu bytes\n", (unsigned long)before.st_blocks * 512, (unsigned long)after.st_blocks * 512);
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 3 && strcmp(argv[1], "trim") == 0) return trim_image(argv[2]);
+    if (argc < 3) {
+        printf("Uso: %s <origem> <destino>\n", argv[0]);
+        printf("     %s trim <imagem>\n", argv[0]);
+        return 1;
+    }
+    return clone_image(argv[1], argv[2]);
+}
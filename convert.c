@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "sacs.h"
+#include "stripe.h"
+
+// Converte offline um volume v1 (campos de 32 bits) para o formato v2 (64 bits).
+// Uso: sacs_convert <origem_v1> <destino_v2>
+// O destino é formatado com a mesma geometria; a árvore é recriada pela API
+// e os dados são copiados arquivo a arquivo.
+
+static FILE *src;
+static unsigned src_block_size;
+static unsigned long converted_files, converted_dirs, failures;
+
+// Lê a entrada i de um diretório v1
+static int read_v1_entry(uint64_t dir_block, unsigned i, struct dir_entry *out) {
+    struct dir_entry_v1 raw;
+    fseeko(src, (off_t)dir_block * src_block_size + (off_t)i * ENTRY_SIZE_V1, SEEK_SET);
+    if (fread(&raw, sizeof(raw), 1, src) != 1) return 0;
+    entry_from_v1(&raw, out);
+    return 1;
+}
+
+// Copia os bytes de um arquivo v1 para o extent já alocado no destino
+static int copy_data(FILE *dst, struct dir_entry *from, struct dir_entry *to, unsigned dst_block_size) {
+    unsigned char *buffer = malloc(src_block_size);
+    if (!buffer) return 0;
+
+    uint64_t offset = 0;
+    while (offset < from->size) {
+        size_t chunk = (from->size - offset < src_block_size) ? from->size - offset : src_block_size;
+        fseeko(src, (off_t)entry_data_pos(from, src_block_size) + offset, SEEK_SET);
+        if (fread(buffer, 1, chunk, src) != chunk) { free(buffer); return 0; }
+        fseeko(dst, (off_t)entry_data_pos(to, dst_block_size) + offset, SEEK_SET);
+        fwrite(buffer, 1, chunk, dst);
+        offset += chunk;
+    }
+    free(buffer);
+    return 1;
+}
+
+// Recria no diretório 'dst_dir' o conteúdo do diretório v1 em (block, length)
+static void copy_dir(FILE *dst, struct superblock *dst_sup, struct dir_entry *dst_dir,
+                     uint64_t block, uint64_t length) {
+    unsigned dst_block_size = (1 << dst_sup->sector_size) << dst_sup->block_size;
+    unsigned max_entries = (length * src_block_size) / ENTRY_SIZE_V1;
+    struct dir_entry entry;
+    char name[17];
+
+    for (unsigned i = 0; i < max_entries; i++) {
+        if (!read_v1_entry(block, i, &entry)) break;
+        if (entry.status != STATUS_VALID) continue;
+        if (strcmp(entry.file_name, ".") == 0 || strcmp(entry.file_name, "..") == 0) continue;
+
+        memcpy(name, entry.file_name, sizeof(name));
+        name[16] = '\0';
+
+        if (entry.file_type == TYPE_DIR) {
+            // Entradas v2 têm o dobro do tamanho: o diretório precisa de mais blocos
+            unsigned used = 0;
+            unsigned child_max = (entry.length * src_block_size) / ENTRY_SIZE_V1;
+            struct dir_entry child_entry;
+            for (unsigned k = 0; k < child_max; k++) {
+                if (read_v1_entry(entry.start_block, k, &child_entry) && child_entry.status == STATUS_VALID) used = k + 1;
+            }
+            unsigned blocks = ((uint64_t)used * ENTRY_SIZE_V2 + dst_block_size - 1) / dst_block_size;
+
+            if (!create_dir_blocks(dst, dst_dir, dst_sup, name, blocks)) {
+                failures++;
+                continue;
+            }
+            struct dir_entry child = *dst_dir;
+            if (!change_directory(dst, &child, dst_sup, name)) {
+                failures++;
+                continue;
+            }
+            copy_dir(dst, dst_sup, &child, entry.start_block, entry.length);
+            converted_dirs++;
+
+            // Recarrega o pai: os tamanhos mudaram durante a recursão
+            char dir_name[17];
+            memcpy(dir_name, dst_dir->file_name, sizeof(dir_name));
+            fseeko(dst, (off_t)dst_dir->start_block * dst_block_size, SEEK_SET);
+            read_entry(dst, dst_dir);
+            memcpy(dst_dir->file_name, dir_name, sizeof(dir_name));
+        } else if (is_regular_file(&entry)) {
+            struct dir_entry created;
+            uint64_t before = dst_dir->size;
+            create_file(dst, dst_dir, dst_sup, name, entry.size, NULL);
+            if (dst_dir->size == before && entry.size > 0) {
+                failures++;
+                continue;
+            }
+            if (find_entry(dst, dst_dir, name, dst_block_size, &created) < 0 ||
+                !copy_data(dst, &entry, &created, dst_block_size)) {
+                printf("Erro: Falha ao copiar dados de '%s'.\n", name);
+                failures++;
+                continue;
+            }
+            converted_files++;
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        printf("Uso: %s <origem_v1> <destino_v2>\n", argv[0]);
+        return 1;
+    }
+
+    src = volume_open(argv[1], "rb");
+    if (!src) { perror("Erro ao abrir origem"); return 1; }
+
+    struct superblock src_sup;
+    int version = read_superblock(src, &src_sup);
+    if (version != 1) {
+        printf("Erro: '%s' %s.\n", argv[1], version == 2 ? "ja esta no formato v2" : "nao e um volume SACS");
+        fclose(src);
+        return 1;
+    }
+    src_block_size = (1 << src_sup.sector_size) << src_sup.block_size;
+    if (src_sup.snap_table) {
+        printf("Aviso: Snapshots de '%s' nao sao convertidos; apenas a arvore atual.\n", argv[1]);
+    }
+
+    // Mesma geometria; a raiz dobra de tamanho para caber as mesmas entradas
+    uint64_t sectors = src_sup.total_blocks << src_sup.block_size;
+    format_sacs(argv[2], SACS_V2, sectors, src_sup.sector_size, src_sup.block_size, src_sup.root_size * 2);
+
+    FILE *dst = volume_open(argv[2], "r+b");
+    struct superblock dst_sup;
+    if (!dst || !mount_sacs(dst, &dst_sup, ALLOC_BEST_FIT)) {
+        printf("Erro: Falha ao montar '%s'.\n", argv[2]);
+        if (dst) fclose(dst);
+        fclose(src);
+        return 1;
+    }
+    unsigned dst_block_size = (1 << dst_sup.sector_size) << dst_sup.block_size;
+
+    struct dir_entry root;
+    fseeko(dst, (off_t)dst_sup.root_start * dst_block_size, SEEK_SET);
+    read_entry(dst, &root);
+    strcpy(root.file_name, "/");
+
+    copy_dir(dst, &dst_sup, &root, src_sup.root_start, src_sup.root_size);
+
+    fclose(dst);
+    fclose(src);
+
+    printf("\n--- CONVERSAO v1 -> v2 ---\n");
+    printf("Arquivos: %lu | Diretorios: %lu | Falhas: %lu\n", converted_files, converted_dirs, failures);
+    return failures ? 1 : 0;
+}
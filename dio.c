@@ -0,0 +1,290 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "dio.h"
+
+// Configuração global
+static int cfg_enabled = 0;
+static unsigned cfg_buffer = DIO_DEFAULT_BUFFER;
+
+// Pool com dois buffers alinhados, reaproveitado entre transferências: enquanto um é
+// escrito no destino o outro recebe a próxima leitura
+static unsigned char *pool_buf = NULL;
+static size_t pool_size = 0;
+
+#define ALIGN_DOWN(x) ((x) & ~((off_t)DIO_ALIGN - 1))
+#define ALIGN_UP(x) ALIGN_DOWN((x) + DIO_ALIGN - 1)
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// --- CONFIGURAÇÃO ---
+
+void dio_configure(int enabled, unsigned buffer_size) {
+    cfg_enabled = enabled;
+    if (buffer_size < DIO_MIN_BUFFER) buffer_size = DIO_DEFAULT_BUFFER;
+    cfg_buffer = (buffer_size + DIO_ALIGN - 1) / DIO_ALIGN * DIO_ALIGN;
+}
+
+int dio_enabled(void) {
+    return cfg_enabled;
+}
+
+// Cada buffer do pool tem folga de um alinhamento para a leitura deslocada
+static size_t pool_stride(void) {
+    return (size_t)cfg_buffer + DIO_ALIGN;
+}
+
+static unsigned char *pool_get(void) {
+    size_t need = 2 * pool_stride();
+    if (pool_buf && pool_size >= need) return pool_buf;
+
+    free(pool_buf);
+    pool_buf = NULL;
+    pool_size = 0;
+    if (posix_memalign((void **)&pool_buf, DIO_ALIGN, need) != 0) {
+        pool_buf = NULL;
+        return NULL;
+    }
+    pool_size = need;
+    return pool_buf;
+}
+
+// Abre de novo o arquivo por trás de fd, agora com O_DIRECT
+static int reopen_direct(int fd, int flags) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/self/fd/%d", fd);
+    return open(path, flags | O_DIRECT);
+}
+
+// --- CÓPIA ---
+
+// Trechos desalinhados (cabeça e cauda) passam pelos descritores originais, com page cache
+static int copy_buffered(int src_fd, off_t src_off, int dst_fd, off_t dst_off,
+                         size_t len, unsigned char *buf, struct dio_stats *st) {
+    size_t done = 0;
+    while (done < len) {
+        size_t chunk = (len - done < cfg_buffer) ? len - done : cfg_buffer;
+        ssize_t r = pread(src_fd, buf, chunk, src_off + (off_t)done);
+        if (r <= 0) return -1;
+        for (ssize_t w = 0; w < r; ) {
+            ssize_t n = pwrite(dst_fd, buf + w, (size_t)(r - w), dst_off + (off_t)done + w);
+            if (n <= 0) return -1;
+            w += n;
+            st->ops++;
+        }
+        done += (size_t)r;
+        st->ops++;
+    }
+    st->buffered_bytes += len;
+    return 0;
+}
+
+// --- ESCRITOR ---
+// Uma thread escreve o pedaço anterior enquanto o chamador lê o próximo. Há no máximo
+// um pedaço entregue e ainda não escrito; os dois buffers do pool se alternam.
+
+struct dio_writer {
+    pthread_t tid;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int fd;
+    unsigned char *buf;           // Pedaço entregue (NULL: nada pendente)
+    size_t n;
+    off_t pos;
+    int stop;
+    int result;                   // 0, -1 ou DIO_FALLBACK: o primeiro erro encerra a cópia
+    unsigned long bytes, ops;
+};
+
+static void *dio_writer_main(void *arg) {
+    struct dio_writer *w = arg;
+    pthread_mutex_lock(&w->lock);
+    for (;;) {
+        while (!w->buf && !w->stop) pthread_cond_wait(&w->cond, &w->lock);
+        if (!w->buf) break;
+        unsigned char *buf = w->buf;
+        size_t n = w->n;
+        off_t pos = w->pos;
+        pthread_mutex_unlock(&w->lock);
+
+        int result = 0;
+        unsigned long ops = 0;
+        for (size_t done = 0; done < n; ) {
+            ssize_t r = pwrite(w->fd, buf + done, n - done, pos + (off_t)done);
+            if (r < 0 && errno == EINVAL) { result = DIO_FALLBACK; break; }
+            if (r <= 0) { printf("Erro de E/S direta: %s\n", strerror(errno)); result = -1; break; }
+            done += (size_t)r;
+            ops++;
+        }
+
+        pthread_mutex_lock(&w->lock);
+        w->ops += ops;
+        if (result == 0) w->bytes += n;
+        else if (w->result == 0) w->result = result;
+        w->buf = NULL;
+        pthread_cond_broadcast(&w->cond);
+    }
+    pthread_mutex_unlock(&w->lock);
+    return NULL;
+}
+
+// Espera o pedaço pendente terminar. Retorna o estado de erro do escritor
+static int dio_writer_wait(struct dio_writer *w) {
+    pthread_mutex_lock(&w->lock);
+    while (w->buf) pthread_cond_wait(&w->cond, &w->lock);
+    int result = w->result;
+    pthread_mutex_unlock(&w->lock);
+    return result;
+}
+
+static void dio_writer_submit(struct dio_writer *w, unsigned char *buf, size_t n, off_t pos) {
+    pthread_mutex_lock(&w->lock);
+    w->buf = buf;
+    w->n = n;
+    w->pos = pos;
+    pthread_cond_broadcast(&w->cond);
+    pthread_mutex_unlock(&w->lock);
+}
+
+static void dio_writer_stop(struct dio_writer *w) {
+    pthread_mutex_lock(&w->lock);
+    w->stop = 1;
+    pthread_cond_broadcast(&w->cond);
+    pthread_mutex_unlock(&w->lock);
+    pthread_join(w->tid, NULL);
+    pthread_mutex_destroy(&w->lock);
+    pthread_cond_destroy(&w->cond);
+}
+
+int dio_copy(int src_fd, off_t src_off, int dst_fd, off_t dst_off,
+             unsigned long len, struct dio_stats *stats) {
+    struct dio_stats st;
+    memset(&st, 0, sizeof(st));
+    if (stats) *stats = st;
+    if (len == 0) return 0;
+    if (src_fd < 0 || dst_fd < 0) return DIO_FALLBACK;   // Sem descritor real (ex.: FILE* em memória)
+
+    unsigned char *pool = pool_get();
+    if (!pool) {
+        printf("Erro: sem memoria para o buffer de E/S direta.\n");
+        return -1;
+    }
+    unsigned char *bufs[2] = { pool, pool + pool_stride() };
+
+    int dsrc = reopen_direct(src_fd, O_RDONLY);
+    int ddst = (dsrc < 0) ? -1 : reopen_direct(dst_fd, O_WRONLY);
+    if (dsrc < 0 || ddst < 0) {
+        printf("[DIO] O_DIRECT recusado (%s).\n", strerror(errno));
+        if (dsrc >= 0) close(dsrc);
+        return DIO_FALLBACK;
+    }
+
+    // O destino define o alinhamento: [head_end, body_end) é escrito com O_DIRECT
+    off_t dst_end = dst_off + (off_t)len;
+    off_t head_end = ALIGN_UP(dst_off);
+    if (head_end > dst_end) head_end = dst_end;
+    off_t body_end = ALIGN_DOWN(dst_end);
+    if (body_end < head_end) body_end = head_end;
+
+    int result = 0;
+    uint64_t t0 = now_ns();
+
+    if (copy_buffered(src_fd, src_off, dst_fd, dst_off, (size_t)(head_end - dst_off), bufs[0], &st) != 0) {
+        result = -1;
+    }
+
+    struct dio_writer w;
+    memset(&w, 0, sizeof(w));
+    w.fd = ddst;
+    pthread_mutex_init(&w.lock, NULL);
+    pthread_cond_init(&w.cond, NULL);
+    int threaded = 0;
+    if (result == 0 && head_end < body_end) {
+        threaded = (pthread_create(&w.tid, NULL, dio_writer_main, &w) == 0);
+        if (!threaded) {
+            printf("Erro: falha ao criar a thread de escrita.\n");
+            result = -1;
+        }
+    }
+    if (!threaded) {
+        pthread_mutex_destroy(&w.lock);
+        pthread_cond_destroy(&w.cond);
+    }
+
+    unsigned turn = 0;
+    for (off_t pos = head_end; threaded && pos < body_end; turn ^= 1) {
+        size_t n = (body_end - pos < (off_t)cfg_buffer) ? (size_t)(body_end - pos) : cfg_buffer;
+        unsigned char *buf = bufs[turn];
+
+        // A origem é lida alinhada por baixo; o deslocamento é corrigido em memória.
+        // O buffer da vez foi escrito dois pedaços atrás: o escritor já terminou com ele
+        off_t src_pos = src_off + (pos - dst_off);
+        off_t src_aligned = ALIGN_DOWN(src_pos);
+        size_t shift = (size_t)(src_pos - src_aligned);
+        size_t want = (size_t)ALIGN_UP((off_t)(shift + n));
+
+        size_t got = 0;
+        while (got < shift + n) {
+            ssize_t r = pread(dsrc, buf + got, want - got, src_aligned + (off_t)got);
+            if (r < 0 && errno == EINVAL) { result = DIO_FALLBACK; break; }
+            if (r < 0) { printf("Erro de E/S direta: %s\n", strerror(errno)); result = -1; break; }
+            if (r == 0) { printf("Erro: fim inesperado da origem.\n"); result = -1; break; }
+            got += (size_t)r;
+            st.ops++;
+        }
+        if (result != 0) break;
+
+        if (shift) {
+            memmove(buf, buf + shift, n);
+            st.realigned++;
+        }
+
+        // Entrega só depois que o pedaço anterior terminou: a escrita dele correu junto com esta leitura
+        result = dio_writer_wait(&w);
+        if (result != 0) break;
+        dio_writer_submit(&w, buf, n, pos);
+        pos += (off_t)n;
+    }
+
+    if (threaded) {
+        int wres = dio_writer_wait(&w);
+        if (result == 0) result = wres;
+        dio_writer_stop(&w);
+        st.direct_bytes += w.bytes;
+        st.ops += w.ops;
+    }
+
+    if (result == 0 &&
+        copy_buffered(src_fd, src_off + (body_end - dst_off), dst_fd, body_end,
+                      (size_t)(dst_end - body_end), bufs[0], &st) != 0) {
+        result = -1;
+    }
+    if (result == DIO_FALLBACK) printf("[DIO] O_DIRECT recusado pelo sistema de arquivos.\n");
+
+    close(dsrc);
+    close(ddst);
+
+    st.bytes = st.direct_bytes + st.buffered_bytes;
+    st.elapsed_ns = now_ns() - t0;
+    if (stats) *stats = st;
+    return result;
+}
+
+void dio_print_stats(const struct dio_stats *stats) {
+    double secs = stats->elapsed_ns / 1e9;
+    double mbps = (secs > 0) ? (stats->bytes / (1024.0 * 1024.0)) / secs : 0;
+    printf("[DIO] %lu bytes em %.3f ms | %.1f MB/s | direto %lu, com buffer %lu | %lu realinhados | %lu ops\n",
+           stats->bytes, stats->elapsed_ns / 1e6, mbps, stats->direct_bytes, stats->buffered_bytes,
+           stats->realigned, stats->ops);
+}
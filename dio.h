@@ -0,0 +1,38 @@
+#ifndef DIO_H
+#define DIO_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+// --- CONFIGURAÇÕES DA E/S DIRETA ---
+#define DIO_ALIGN 4096                       // Alinhamento de buffers, offsets e tamanhos
+#define DIO_DEFAULT_BUFFER (4 * 1024 * 1024) // Tamanho do buffer do pool
+#define DIO_MIN_BUFFER (64 * 1024)
+#define DIO_FALLBACK 1                       // O_DIRECT recusado: o chamador usa o caminho com buffer
+
+// --- ESTRUTURAS ---
+
+// Resultado de uma transferência direta
+struct dio_stats {
+    unsigned long bytes;          // Total copiado
+    unsigned long direct_bytes;   // Parte alinhada, sem passar pelo page cache
+    unsigned long buffered_bytes; // Cabeça e cauda desalinhadas
+    unsigned long realigned;      // Pedaços deslocados em memória (origem e destino desalinhados entre si)
+    uint64_t elapsed_ns;
+    unsigned long ops;
+};
+
+// --- PROTÓTIPOS DAS FUNÇÕES ---
+
+// Configuração global (lida de SACS_DIRECT / SACS_DIRECT_BUFFER pelo main)
+void dio_configure(int enabled, unsigned buffer_size);
+int dio_enabled(void);
+
+// Copia len bytes de src_fd:src_off para dst_fd:dst_off com O_DIRECT.
+// Retorna 0 em sucesso, -1 em erro de E/S e DIO_FALLBACK se o sistema de arquivos
+// recusar O_DIRECT (nada foi perdido: a cópia pode ser refeita pelo caminho normal).
+int dio_copy(int src_fd, off_t src_off, int dst_fd, off_t dst_off,
+             unsigned long len, struct dio_stats *stats);
+void dio_print_stats(const struct dio_stats *stats);
+
+#endif // DIO_H
@@ -0,0 +1,391 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sched.h>
+#include <fnmatch.h>
+#include <pthread.h>
+#include "find.h"
+#include "stripe.h"
+
+// Busca paralela: cada diretório é uma tarefa. Cada thread tem sua própria fila;
+// a dona empilha e desempilha pelo fim (LIFO, aproveita o bloco recém-lido) e as
+// ociosas roubam pelo início (FIFO, pegam os diretórios mais rasos, com mais trabalho).
+
+#define NAME_FIELD 17
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// --- PADRÃO ---
+
+#define MATCH_NONE -1         // Literal maior que o campo de nome: nunca casa
+#define MATCH_ANY 0           // Sem padrão ou "*"
+#define MATCH_EXACT 1         // Sem metacaracteres: compara o campo de 17 bytes inteiro
+#define MATCH_PREFIX 2        // "abc*": só o prefixo
+#define MATCH_GLOB 3          // Prefixo literal filtra, fnmatch decide
+
+struct matcher {
+    int kind;
+    char literal[NAME_FIELD];    // Nome exato ou prefixo literal, completado com zeros
+    size_t prefix_len;
+    const char *pattern;
+};
+
+static void matcher_init(struct matcher *m, const char *pattern) {
+    memset(m, 0, sizeof(*m));
+    m->pattern = pattern;
+    if (!pattern || !*pattern || strcmp(pattern, "*") == 0) {
+        m->kind = MATCH_ANY;
+        return;
+    }
+
+    size_t len = strlen(pattern);
+    size_t lit = strcspn(pattern, "*?[\\");
+    m->prefix_len = (lit < NAME_FIELD - 1) ? lit : NAME_FIELD - 1;
+    memcpy(m->literal, pattern, m->prefix_len);
+
+    if (lit == len) {
+        m->kind = (len < NAME_FIELD) ? MATCH_EXACT : MATCH_NONE;
+    } else if (lit == len - 1 && pattern[lit] == '*') {
+        m->kind = MATCH_PREFIX;
+    } else {
+        m->kind = MATCH_GLOB;
+    }
+}
+
+// Os nomes no disco são completados com zeros (prepare_dir_entry), então a igualdade
+// exata é um memcmp de tamanho fixo, que o compilador resolve em poucas comparações largas
+static int matcher_test(const struct matcher *m, const char *name) {
+    switch (m->kind) {
+        case MATCH_ANY: return 1;
+        case MATCH_EXACT: return memcmp(name, m->literal, NAME_FIELD) == 0;
+        case MATCH_PREFIX: return memcmp(name, m->literal, m->prefix_len) == 0;
+        case MATCH_GLOB:
+            if (memcmp(name, m->literal, m->prefix_len) != 0) return 0;
+            {
+                char buf[NAME_FIELD + 1];
+                memcpy(buf, name, NAME_FIELD);
+                buf[NAME_FIELD] = '\0';
+                return fnmatch(m->pattern, buf, 0) == 0;
+            }
+        default: return 0;
+    }
+}
+
+// --- FILAS DE TAREFAS ---
+
+struct find_task {
+    uint64_t block, length;
+    char *path;
+};
+
+struct task_deque {
+    pthread_mutex_t lock;
+    struct find_task *items;
+    unsigned head, tail, cap;    // [head, tail) ocupado
+};
+
+struct find_ctx {
+    FILE *fp;
+    int fd;                      // -1: lê pelo FILE* sob trava (volume em faixas)
+    pthread_mutex_t io_lock;
+    pthread_mutex_t emit_lock;
+    unsigned real_block_size;
+    struct matcher match;
+    const struct find_query *query;
+    find_emit_fn emit;
+    void *emit_ctx;
+    struct task_deque *queues;
+    unsigned nthreads;
+    long pending;                // Tarefas criadas e ainda não concluídas
+    int error;
+    unsigned long dirs, entries, matches, steals;
+};
+
+static int deque_push(struct task_deque *q, struct find_task task) {
+    pthread_mutex_lock(&q->lock);
+    if (q->head > 0 && q->tail == q->cap) {
+        memmove(q->items, q->items + q->head, (q->tail - q->head) * sizeof(*q->items));
+        q->tail -= q->head;
+        q->head = 0;
+    }
+    if (q->tail == q->cap) {
+        unsigned cap = q->cap ? q->cap * 2 : 64;
+        struct find_task *items = realloc(q->items, cap * sizeof(*items));
+        if (!items) {
+            pthread_mutex_unlock(&q->lock);
+            return 0;
+        }
+        q->items = items;
+        q->cap = cap;
+    }
+    q->items[q->tail++] = task;
+    pthread_mutex_unlock(&q->lock);
+    return 1;
+}
+
+// Dona: pega a mais recente
+static int deque_pop(struct task_deque *q, struct find_task *out) {
+    int ok = 0;
+    pthread_mutex_lock(&q->lock);
+    if (q->tail > q->head) {
+        *out = q->items[--q->tail];
+        ok = 1;
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok;
+}
+
+// Ladra: pega a mais antiga
+static int deque_steal(struct task_deque *q, struct find_task *out) {
+    int ok = 0;
+    pthread_mutex_lock(&q->lock);
+    if (q->tail > q->head) {
+        *out = q->items[q->head++];
+        ok = 1;
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok;
+}
+
+// --- LEITURA DE DIRETÓRIOS ---
+
+static int read_dir_blocks(struct find_ctx *c, uint64_t block, uint64_t length, unsigned char *buf) {
+    size_t bytes = (size_t)length * c->real_block_size;
+    off_t off = (off_t)block * c->real_block_size;
+
+    if (c->fd >= 0) {
+        size_t done = 0;
+        while (done < bytes) {
+            ssize_t r = pread(c->fd, buf + done, bytes - done, off + (off_t)done);
+            if (r <= 0) return 0;
+            done += (size_t)r;
+        }
+        return 1;
+    }
+
+    pthread_mutex_lock(&c->io_lock);
+    fseeko(c->fp, off, SEEK_SET);
+    size_t got = fread(buf, 1, bytes, c->fp);
+    pthread_mutex_unlock(&c->io_lock);
+    return got == bytes;
+}
+
+static void decode_entry(const unsigned char *raw, struct dir_entry *entry) {
+    if (ENTRY_SIZE == ENTRY_SIZE_V2) {
+        memcpy(entry, raw, sizeof(*entry));
+    } else {
+        struct dir_entry_v1 old;
+        memcpy(&old, raw, sizeof(old));
+        entry_from_v1(&old, entry);
+    }
+}
+
+static int query_accepts(struct find_ctx *c, const struct dir_entry *entry) {
+    const struct find_query *q = c->query;
+    if (q->type == FIND_TYPE_DIR && entry->file_type != TYPE_DIR) return 0;
+    if (q->type == FIND_TYPE_FILE && entry->file_type == TYPE_DIR) return 0;
+    if (entry->size < q->min_size) return 0;
+    if (q->max_size && entry->size > q->max_size) return 0;
+    return matcher_test(&c->match, entry->file_name);
+}
+
+// Processa um diretório: emite os resultados e enfileira os subdiretórios
+static void process_dir(struct find_ctx *c, unsigned self, struct find_task *task,
+                        unsigned char **buf, size_t *buf_size) {
+    size_t bytes = (size_t)task->length * c->real_block_size;
+    if (bytes > *buf_size) {
+        unsigned char *grown = realloc(*buf, bytes);
+        if (!grown) { c->error = 1; return; }
+        *buf = grown;
+        *buf_size = bytes;
+    }
+    if (!read_dir_blocks(c, task->block, task->length, *buf)) {
+        c->error = 1;
+        return;
+    }
+    __atomic_add_fetch(&c->dirs, 1, __ATOMIC_RELAXED);
+
+    unsigned max_entries = bytes / ENTRY_SIZE;
+    unsigned long seen = 0;
+    size_t base_len = strlen(task->path);
+    char path[FIND_MAX_PATH];
+
+    for (unsigned i = 0; i < max_entries; i++) {
+        const unsigned char *raw = *buf + (size_t)i * ENTRY_SIZE;
+        if (raw[0] != STATUS_VALID) continue;   // status é o primeiro byte nos dois formatos
+
+        struct dir_entry entry;
+        decode_entry(raw, &entry);
+        if (entry.file_name[0] == '.' &&
+            (entry.file_name[1] == '\0' || (entry.file_name[1] == '.' && entry.file_name[2] == '\0'))) continue;
+        seen++;
+
+        int accepted = query_accepts(c, &entry);
+        if (!accepted && entry.file_type != TYPE_DIR) continue;
+
+        size_t name_len = strnlen(entry.file_name, 16);
+        if (base_len + 1 + name_len >= sizeof(path)) continue;
+        memcpy(path, task->path, base_len);
+        size_t len = base_len;
+        if (len == 0 || path[len - 1] != '/') path[len++] = '/';
+        memcpy(path + len, entry.file_name, name_len);
+        path[len + name_len] = '\0';
+
+        if (accepted) {
+            pthread_mutex_lock(&c->emit_lock);
+            c->matches++;
+            if (c->emit) c->emit(path, &entry, c->emit_ctx);
+            pthread_mutex_unlock(&c->emit_lock);
+        }
+
+        if (entry.file_type == TYPE_DIR) {
+            struct find_task sub = { entry.start_block, entry.length, strdup(path) };
+            if (!sub.path) { c->error = 1; continue; }
+            __atomic_add_fetch(&c->pending, 1, __ATOMIC_ACQ_REL);
+            if (!deque_push(&c->queues[self], sub)) {
+                free(sub.path);
+                __atomic_sub_fetch(&c->pending, 1, __ATOMIC_ACQ_REL);
+                c->error = 1;
+            }
+        }
+    }
+    __atomic_add_fetch(&c->entries, seen, __ATOMIC_RELAXED);
+}
+
+struct worker_arg {
+    struct find_ctx *ctx;
+    unsigned id;
+};
+
+static void *find_worker(void *arg) {
+    struct worker_arg *w = arg;
+    struct find_ctx *c = w->ctx;
+    unsigned char *buf = NULL;
+    size_t buf_size = 0;
+    unsigned victim = w->id;
+
+    while (1) {
+        struct find_task task;
+        int got = deque_pop(&c->queues[w->id], &task);
+
+        // Fila própria vazia: tenta roubar das outras, em rodízio
+        for (unsigned k = 1; !got && k < c->nthreads; k++) {
+            victim = (victim + 1) % c->nthreads;
+            if (victim == w->id) continue;
+            got = deque_steal(&c->queues[victim], &task);
+            if (got) __atomic_add_fetch(&c->steals, 1, __ATOMIC_RELAXED);
+        }
+
+        if (!got) {
+            if (__atomic_load_n(&c->pending, __ATOMIC_ACQUIRE) == 0) break;
+            sched_yield();
+            continue;
+        }
+
+        if (!c->error) process_dir(c, w->id, &task, &buf, &buf_size);
+        free(task.path);
+        __atomic_sub_fetch(&c->pending, 1, __ATOMIC_ACQ_REL);
+    }
+    free(buf);
+    return NULL;
+}
+
+// --- API ---
+
+long sacs_find(FILE *fp, struct dir_entry *start, struct superblock *sup, const char *start_path,
+               const struct find_query *query, find_emit_fn emit, void *ctx, struct find_stats *stats) {
+    struct find_ctx c;
+    memset(&c, 0, sizeof(c));
+    c.fp = fp;
+    c.fd = stripe_is(fp) ? -1 : fileno(fp);
+    c.real_block_size = (1 << sup->sector_size) << sup->block_size;
+    c.query = query;
+    c.emit = emit;
+    c.emit_ctx = ctx;
+    matcher_init(&c.match, query->pattern);
+    dir_follow(start);
+    pthread_mutex_init(&c.io_lock, NULL);
+    pthread_mutex_init(&c.emit_lock, NULL);
+
+    unsigned nthreads = query->threads ? query->threads : FIND_DEFAULT_THREADS;
+    if (nthreads > FIND_MAX_THREADS) nthreads = FIND_MAX_THREADS;
+    c.nthreads = nthreads;
+
+    // As threads leem pelo descritor: o buffer do stdio precisa estar no disco
+    fflush(fp);
+    long old_pos = ftell(fp);
+
+    c.queues = calloc(nthreads, sizeof(struct task_deque));
+    pthread_t *threads = calloc(nthreads, sizeof(pthread_t));
+    struct worker_arg *args = calloc(nthreads, sizeof(struct worker_arg));
+    struct find_task root = { start->start_block, start->length, strdup(start_path ? start_path : "") };
+    if (!c.queues || !threads || !args || !root.path) {
+        printf("Erro fatal de memória RAM.\n");
+        free(c.queues);
+        free(threads);
+        free(args);
+        free(root.path);
+        return -1;
+    }
+    for (unsigned i = 0; i < nthreads; i++) pthread_mutex_init(&c.queues[i].lock, NULL);
+
+    c.pending = 1;
+    deque_push(&c.queues[0], root);
+    uint64_t t0 = now_ns();
+
+    unsigned started = 0;
+    for (unsigned i = 0; i < nthreads; i++) {
+        args[i].ctx = &c;
+        args[i].id = i;
+        if (pthread_create(&threads[i], NULL, find_worker, &args[i]) != 0) break;
+        started++;
+    }
+    if (started == 0) {
+        // Sem threads: a própria chamada esvazia a fila
+        args[0].ctx = &c;
+        args[0].id = 0;
+        c.nthreads = 1;
+        find_worker(&args[0]);
+    }
+    for (unsigned i = 0; i < started; i++) pthread_join(threads[i], NULL);
+
+    if (stats) {
+        stats->threads = started ? started : 1;
+        stats->dirs = c.dirs;
+        stats->entries = c.entries;
+        stats->matches = c.matches;
+        stats->steals = c.steals;
+        stats->elapsed_ns = now_ns() - t0;
+    }
+
+    for (unsigned i = 0; i < nthreads; i++) {
+        free(c.queues[i].items);
+        pthread_mutex_destroy(&c.queues[i].lock);
+    }
+    free(c.queues);
+    free(threads);
+    free(args);
+    pthread_mutex_destroy(&c.io_lock);
+    pthread_mutex_destroy(&c.emit_lock);
+    fseek(fp, old_pos, SEEK_SET);
+
+    if (c.error) {
+        printf("Erro: Falha ao ler diretorios durante a busca.\n");
+        return -1;
+    }
+    return (long)c.matches;
+}
+
+void find_print_stats(const struct find_stats *stats) {
+    double ms = stats->elapsed_ns / 1e6;
+    printf("[FIND] %lu resultados | %lu entradas em %lu diretorios | %.3f ms | %u threads, %lu roubos\n",
+           stats->matches, stats->entries, stats->dirs, ms, stats->threads, stats->steals);
+}
@@ -0,0 +1,47 @@
+#ifndef FIND_H
+#define FIND_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "sacs.h"
+
+// --- CONFIGURAÇÕES DA BUSCA ---
+#define FIND_DEFAULT_THREADS 4
+#define FIND_MAX_THREADS 64
+#define FIND_MAX_PATH 1024
+#define FIND_TYPE_ANY 0
+#define FIND_TYPE_FILE 1      // Arquivos comuns e empacotados
+#define FIND_TYPE_DIR 2
+
+// --- ESTRUTURAS ---
+
+// Critérios da busca; todos precisam valer
+struct find_query {
+    const char *pattern;      // Glob (fnmatch) sobre o nome; NULL ou "*" = qualquer
+    int type;                 // FIND_TYPE_*
+    uint64_t min_size;
+    uint64_t max_size;        // 0 = sem limite
+    unsigned threads;         // 0 = FIND_DEFAULT_THREADS
+};
+
+struct find_stats {
+    unsigned threads;
+    unsigned long dirs;       // Diretórios lidos
+    unsigned long entries;    // Entradas válidas examinadas
+    unsigned long matches;
+    unsigned long steals;     // Diretórios tirados da fila de outra thread
+    uint64_t elapsed_ns;
+};
+
+// Chamada para cada resultado, já serializada (uma de cada vez)
+typedef void (*find_emit_fn)(const char *path, const struct dir_entry *entry, void *ctx);
+
+// --- PROTÓTIPOS DAS FUNÇÕES ---
+
+// Busca na subárvore de 'start'; 'start_path' prefixa os caminhos emitidos.
+// Retorna a quantidade de resultados, ou -1 em erro.
+long sacs_find(FILE *fp, struct dir_entry *start, struct superblock *sup, const char *start_path,
+               const struct find_query *query, find_emit_fn emit, void *ctx, struct find_stats *stats);
+void find_print_stats(const struct find_stats *stats);
+
+#endif // FIND_H
@@ -1,170 +1,398 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include "sacs.h"
-
-// MAIN
-int main() {
-
-    char device_path[100];
-    int opcao;
-    
-    printf("SACS - Sistema de Arquivos\n");
-    printf("Dispositivo: ");
-    scanf("%99s", device_path);
-
-    // Abre uma vez para validar e carregar a Raiz
-    FILE *fp = fopen(device_path, "r+b");
-    while (!fp) {
-        int sub_opt;
-        printf("\nERRO: Falha ao abrir '%s'. O arquivo nao existe ou esta bloqueado.\n", device_path);
-        printf("1. Digitar outro caminho\n");
-        printf("2. Formatar/Criar este dispositivo agora\n");
-        printf("0. Sair do programa\n");
-        printf("Escolha: ");
-        scanf("%d", &sub_opt);
-
-        if (sub_opt == 0) {
-            printf("Saindo...\n");
-            return 0;
-        } 
-        else if (sub_opt == 1) {
-            printf("Novo caminho: ");
-            scanf("%99s", device_path);
-            // Tenta abrir o novo caminho
-            fp = fopen(device_path, "r+b");
-        } 
-        else if (sub_opt == 2) {
-            unsigned int setores;
-            unsigned short block_size;
-            unsigned int root_size;
-            printf("Setores (ex: 2048): ");
-            scanf("%u", &setores);
-            printf("Tamanho dos blocos em relação aos setores (ex: 2 = Setores ^ 2 ^ 2): ");
-            scanf("%hu", &block_size);
-            printf("Quantidade de blocos no diretório raiz: ");
-            scanf("%u", &root_size);
-            format_sacs(device_path, SACS, setores, 9, block_size, root_size);
-            // Tenta abrir novamente agora que o arquivo existe
-            fp = fopen(device_path, "r+b");
-            
-            if (fp) {
-                printf("Dispositivo formatado e montado com sucesso!\n");
-                
-            }
-        } 
-        else {
-            printf("Opcao invalida.\n");
-        }
-    }
-    struct superblock sup;
-    struct dir_entry current_dir; // Mantém o estado da pasta atual
-    unsigned int real_block_size = 0;
-
-    // Se o arquivo abriu, carregamos o Superbloco e vamos para a Raiz
-    if (fp) {
-        fseek(fp, 0, SEEK_SET);
-        fread(&sup, sizeof(struct superblock), 1, fp);
-        real_block_size = (1 << sup.sector_size) << sup.block_size;
-        
-        // Carrega Raiz inicialmente
-        fseek(fp, sup.root_start * real_block_size, SEEK_SET);
-        fread(&current_dir, ENTRY_SIZE, 1, fp);
-        // Garante nome "Raiz" ou "/" para exibição
-        strcpy(current_dir.file_name, "/"); 
-    }
-
-    while(1) {
-        // Mostra em qual pasta estamos
-        printf("\n=== SACS: %s [Bloco %u] ===\n", 
-               (fp) ? current_dir.file_name : "?", 
-               (fp) ? current_dir.start_block : 0);
-        
-        printf("1. Formatar\n");
-        printf("2. Listar Arquivos (ls)\n");
-        printf("3. Importar Arquivo (para pasta atual)\n"); 
-        printf("4. Exportar Arquivo (da pasta atual)\n");
-        printf("5. Remover Item\n");
-        printf("6. Criar Diretorio (mkdir)\n");
-        printf("7. Mudar Diretorio (cd)\n"); 
-        printf("0. Sair\n");
-        printf("Escolha: ");
-        scanf("%d", &opcao);
-
-        if (opcao == 0) break;
-
-        if (opcao == 1) {
-            if (fp) fclose(fp); // Fecha para formatar
-            unsigned int setores;
-            unsigned short block_size;
-            unsigned int root_size;
-            printf("Setores (ex: 2048): ");
-            scanf("%u", &setores);
-            printf("Tamanho dos blocos em relação aos setores (ex: 2 = Setores ^ 2 ^ 2): ");
-            scanf("%hu", &block_size);
-            printf("Quantidade de blocos no diretório raiz: ");
-            scanf("%u", &root_size);
-            format_sacs(device_path, SACS, setores, 9, block_size, root_size);
-            // Reabre e recarrega raiz
-            fp = fopen(device_path, "r+b");
-            fseek(fp, 0, SEEK_SET);
-            fread(&sup, sizeof(struct superblock), 1, fp);
-            real_block_size = (1 << sup.sector_size) << sup.block_size;
-            fseek(fp, sup.root_start * real_block_size, SEEK_SET);
-            fread(&current_dir, ENTRY_SIZE, 1, fp);
-            strcpy(current_dir.file_name, "/");
-            continue;
-        }
-
-        if (!fp) continue; // Segurança
-
-        switch (opcao) {
-            case 2: // Listar 
-                list_recursive(fp, &current_dir, &sup, 0);
-                break;
-            case 3: // Importar
-                {
-                    char path[200];
-                    printf("Arquivo PC: ");
-                    scanf("%199s", path);
-                    // Passa current_dir como pai
-                    import_file(fp, &current_dir, &sup, path);
-                }
-                break;
-            case 4: // Exportar
-                {
-                    char name[20], dest[200];
-                    printf("Arquivo SACS: "); scanf("%19s", name);
-                    printf("Destino PC: "); scanf("%199s", dest);
-                    export_file(fp, &current_dir, &sup, name, dest);
-                }
-                break;
-            case 5: // Remover
-                {
-                    char name[20];
-                    printf("Nome: "); scanf("%19s", name);
-                    delete_item(fp, &current_dir, &sup, name);
-                }
-                break;
-            case 6: // Criar Dir
-                {
-                    char name[20];
-                    printf("Nome Pasta: "); scanf("%19s", name);
-                    create_dir(fp, &current_dir, &sup, name);
-                }
-                break;
-            case 7: // CD - Mudar Diretório
-                {
-                    char target[20];
-                    printf("Ir para (.. para voltar): ");
-                    scanf("%19s", target);
-                    change_directory(fp, &current_dir, &sup, target);
-                }
-                break;
-            default: printf("Invalido.\n");
-        }
-    }
-
-    if (fp) fclose(fp);
-    return 0;
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "sacs.h"
+#include "trace.h"
+#include "aio.h"
+#include "dio.h"
+#include "stripe.h"
+#include "find.h"
+#include "prefetch.h"
+
+// Resultado da busca: um caminho por linha, assim que é encontrado
+static void print_find_result(const char *path, const struct dir_entry *entry, void *ctx) {
+    (void)ctx;
+    printf("%s %s (%" PRIu64 " bytes)\n", (entry->file_type == TYPE_DIR) ? "[D]" : "[F]", path, entry->size);
+}
+
+// MAIN
+int main() {
+
+    char device_path[100];
+    int opcao;
+
+    // Gravação de trace opcional: SACS_TRACE=<arquivo>
+    char *trace_path = getenv("SACS_TRACE");
+    if (trace_path && trace_start(trace_path)) {
+        printf("Gravando trace em '%s'\n", trace_path);
+    }
+
+    // E/S assíncrona opcional: SACS_AIO=uring|threads, SACS_AIO_DEPTH=<n>, SACS_AIO_CHUNK=<bytes>
+    char *aio_mode = getenv("SACS_AIO");
+    if (aio_mode) {
+        int engine = (strcmp(aio_mode, "threads") == 0) ? AIO_ENGINE_THREADS : AIO_ENGINE_URING;
+        char *depth = getenv("SACS_AIO_DEPTH");
+        char *chunk = getenv("SACS_AIO_CHUNK");
+        aio_configure(engine, depth ? (unsigned)atoi(depth) : AIO_DEFAULT_DEPTH,
+                      chunk ? (unsigned)atoi(chunk) : AIO_DEFAULT_CHUNK);
+        printf("E/S assincrona: %s\n", aio_engine_name(engine));
+    }
+
+    // E/S direta opcional para importar/exportar: SACS_DIRECT=1, SACS_DIRECT_BUFFER=<bytes>
+    char *direct_mode = getenv("SACS_DIRECT");
+    if (direct_mode && strcmp(direct_mode, "0") != 0) {
+        char *buffer = getenv("SACS_DIRECT_BUFFER");
+        dio_configure(1, buffer ? (unsigned)atoi(buffer) : DIO_DEFAULT_BUFFER);
+        printf("E/S direta (O_DIRECT) em importar/exportar\n");
+    }
+    
+    // Leitura antecipada ao exportar e listar (ligada por padrão): SACS_PREFETCH=0 desliga,
+    // SACS_PREFETCH_MAX=<bytes> limita a janela
+    char *prefetch_mode = getenv("SACS_PREFETCH");
+    char *prefetch_max = getenv("SACS_PREFETCH_MAX");
+    if (prefetch_mode || prefetch_max) {
+        int enabled = !(prefetch_mode && strcmp(prefetch_mode, "0") == 0);
+        prefetch_configure(enabled, prefetch_max ? (unsigned)atoi(prefetch_max) : PREFETCH_DEFAULT_MAX);
+        if (!enabled) printf("Leitura antecipada desligada\n");
+    }
+
+    // Volumes em faixas: Dispositivo = "a.img,b.img,..."; SACS_STRIPE_UNIT=<bytes> ao formatar
+    char *stripe_unit = getenv("SACS_STRIPE_UNIT");
+    if (stripe_unit) stripe_configure((unsigned)atoi(stripe_unit));
+
+    // Formato de volumes novos: SACS_FORMAT=v1 mantém o formato antigo de 32 bits
+    char *format_env = getenv("SACS_FORMAT");
+    unsigned int format_sysid = (format_env && strcmp(format_env, "v1") == 0) ? SACS : SACS_V2;
+
+    printf("SACS - Sistema de Arquivos\n");
+    printf("Dispositivo: ");
+    scanf("%99s", device_path);
+
+    // Abre uma vez para validar e carregar a Raiz
+    FILE *fp = volume_open(device_path, "r+b");
+    while (!fp) {
+        int sub_opt;
+        printf("\nERRO: Falha ao abrir '%s'. O arquivo nao existe ou esta bloqueado.\n", device_path);
+        printf("1. Digitar outro caminho\n");
+        printf("2. Formatar/Criar este dispositivo agora\n");
+        printf("0. Sair do programa\n");
+        printf("Escolha: ");
+        scanf("%d", &sub_opt);
+
+        if (sub_opt == 0) {
+            printf("Saindo...\n");
+            return 0;
+        } 
+        else if (sub_opt == 1) {
+            printf("Novo caminho: ");
+            scanf("%99s", device_path);
+            // Tenta abrir o novo caminho
+            fp = volume_open(device_path, "r+b");
+        } 
+        else if (sub_opt == 2) {
+            unsigned long setores;
+            unsigned short block_size;
+            unsigned int root_size;
+            printf("Setores (ex: 2048): ");
+            scanf("%lu", &setores);
+            printf("Tamanho dos blocos em relação aos setores (ex: 2 = Setores ^ 2 ^ 2): ");
+            scanf("%hu", &block_size);
+            printf("Quantidade de blocos no diretório raiz: ");
+            scanf("%u", &root_size);
+            format_sacs(device_path, format_sysid, setores, 9, block_size, root_size);
+            // Tenta abrir novamente agora que o arquivo existe
+            fp = volume_open(device_path, "r+b");
+            
+            if (fp) {
+                printf("Dispositivo formatado e montado com sucesso!\n");
+                
+            }
+        } 
+        else {
+            printf("Opcao invalida.\n");
+        }
+    }
+    struct superblock sup;
+    struct dir_entry current_dir; // Mantém o estado da pasta atual
+    unsigned int real_block_size = 0;
+
+    // Política de alocação escolhida na montagem: SACS_ALLOC=best|next|segregated|locality
+    int policy = parse_alloc_policy(getenv("SACS_ALLOC"));
+
+    // SACS_SNAPSHOT=nome monta o snapshot somente leitura em vez da árvore atual
+    char *snapshot_name = getenv("SACS_SNAPSHOT");
+
+    // Se o arquivo abriu, montamos o volume e vamos para a Raiz
+    if (fp) {
+        if (snapshot_name && *snapshot_name) {
+            if (!mount_snapshot(fp, &sup, policy, snapshot_name, &current_dir)) {
+                fclose(fp);
+                return 1;
+            }
+        } else {
+            if (!mount_sacs(fp, &sup, policy)) {
+                fclose(fp);
+                return 1;
+            }
+            // Carrega Raiz inicialmente
+            real_block_size = (1 << sup.sector_size) << sup.block_size;
+            fseek(fp, sup.root_start * real_block_size, SEEK_SET);
+            read_entry(fp, &current_dir);
+        }
+        printf("Alocacao: %s\n", alloc_policy_name(policy));
+        real_block_size = (1 << sup.sector_size) << sup.block_size;
+        // Garante nome "Raiz" ou "/" para exibição
+        strcpy(current_dir.file_name, "/"); 
+    }
+
+    while(1) {
+        // Mostra em qual pasta estamos
+        if (fp) dir_follow(&current_dir);
+        printf("\n=== SACS: %s [Bloco %" PRIu64 "] ===\n", 
+               (fp) ? current_dir.file_name : "?", 
+               (fp) ? current_dir.start_block : 0UL);
+        
+        printf("1. Formatar\n");
+        printf("2. Listar Arquivos (ls)\n");
+        printf("3. Importar Arquivo (para pasta atual)\n"); 
+        printf("4. Exportar Arquivo (da pasta atual)\n");
+        printf("5. Remover Item\n");
+        printf("6. Criar Diretorio (mkdir)\n");
+        printf("7. Mudar Diretorio (cd)\n"); 
+        printf("8. Anexar Arquivo PC ao fim de arquivo (append)\n");
+        printf("9. Truncar/Estender Arquivo\n");
+        printf("10. Ler Trecho de Arquivo\n");
+        printf("11. Escrever Trecho em Arquivo\n");
+        printf("12. Remover Recursivo (rm -r)\n");
+        printf("13. Criar Snapshot\n");
+        printf("14. Listar Snapshots\n");
+        printf("15. Buscar (find)\n");
+        printf("16. Espaco Livre e Fragmentacao (df)\n");
+        printf("17. Mover/Renomear (mv)\n");
+        printf("18. Copiar Arquivo (cp)\n");
+        printf("19. Importar Saida de Comando (pipe)\n");
+        printf("0. Sair\n");
+        printf("Escolha: ");
+        scanf("%d", &opcao);
+
+        if (opcao == 0) break;
+
+        if (opcao == 1) {
+            if (fp) fclose(fp); // Fecha para formatar
+            unsigned long setores;
+            unsigned short block_size;
+            unsigned int root_size;
+            printf("Setores (ex: 2048): ");
+            scanf("%lu", &setores);
+            printf("Tamanho dos blocos em relação aos setores (ex: 2 = Setores ^ 2 ^ 2): ");
+            scanf("%hu", &block_size);
+            printf("Quantidade de blocos no diretório raiz: ");
+            scanf("%u", &root_size);
+            format_sacs(device_path, format_sysid, setores, 9, block_size, root_size);
+            // Reabre e recarrega raiz
+            fp = volume_open(device_path, "r+b");
+            if (!fp || !mount_sacs(fp, &sup, policy)) {
+                printf("Erro: Falha ao montar '%s' apos formatar.\n", device_path);
+                if (fp) fclose(fp);
+                return 1;
+            }
+            real_block_size = (1 << sup.sector_size) << sup.block_size;
+            fseek(fp, sup.root_start * real_block_size, SEEK_SET);
+            read_entry(fp, &current_dir);
+            strcpy(current_dir.file_name, "/");
+            continue;
+        }
+
+        if (!fp) continue; // Segurança
+
+        switch (opcao) {
+            case 2: // Listar 
+                list_recursive(fp, &current_dir, &sup, 0);
+                break;
+            case 3: // Importar
+                {
+                    char path[200];
+                    printf("Arquivo PC: ");
+                    scanf("%199s", path);
+                    // Passa current_dir como pai
+                    import_file(fp, &current_dir, &sup, path);
+                }
+                break;
+            case 4: // Exportar
+                {
+                    char name[20], dest[200];
+                    printf("Arquivo SACS: "); scanf("%19s", name);
+                    printf("Destino PC: "); scanf("%199s", dest);
+                    export_file(fp, &current_dir, &sup, name, dest);
+                }
+                break;
+            case 5: // Remover
+                {
+                    char name[20];
+                    printf("Nome: "); scanf("%19s", name);
+                    delete_item(fp, &current_dir, &sup, name);
+                }
+                break;
+            case 6: // Criar Dir
+                {
+                    char name[20];
+                    printf("Nome Pasta: "); scanf("%19s", name);
+                    create_dir(fp, &current_dir, &sup, name);
+                }
+                break;
+            case 7: // CD - Mudar Diretório
+                {
+                    char target[20];
+                    printf("Ir para (.. para voltar): ");
+                    scanf("%19s", target);
+                    change_directory(fp, &current_dir, &sup, target);
+                }
+                break;
+            case 8: // Append
+                {
+                    char name[20], path[200];
+                    printf("Arquivo SACS: "); scanf("%19s", name);
+                    printf("Arquivo PC (dados a anexar): "); scanf("%199s", path);
+                    FILE *f_ext = fopen(path, "rb");
+                    if (!f_ext) {
+                        printf("Erro: Arquivo externo '%s' nao encontrado.\n", path);
+                        break;
+                    }
+                    // Anexa em pedaços; cada pedaço cresce o arquivo no lugar quando possível
+                    char buf[65536];
+                    size_t n;
+                    unsigned long total = 0;
+                    while ((n = fread(buf, 1, sizeof(buf), f_ext)) > 0) {
+                        if (!append_file(fp, &current_dir, &sup, name, buf, n)) break;
+                        total += n;
+                    }
+                    fclose(f_ext);
+                    printf("%lu bytes anexados a '%s'.\n", total, name);
+                }
+                break;
+            case 9: // Truncar
+                {
+                    char name[20];
+                    unsigned long new_size;
+                    printf("Arquivo SACS: "); scanf("%19s", name);
+                    printf("Novo tamanho (bytes): "); scanf("%lu", &new_size);
+                    if (truncate_file(fp, &current_dir, &sup, name, new_size)) {
+                        printf("Arquivo '%s' agora tem %lu bytes.\n", name, new_size);
+                    }
+                }
+                break;
+            case 10: // Leitura parcial
+                {
+                    char name[20];
+                    unsigned long offset, count;
+                    printf("Arquivo SACS: "); scanf("%19s", name);
+                    printf("Offset: "); scanf("%lu", &offset);
+                    printf("Bytes: "); scanf("%lu", &count);
+                    int h = sacs_open(fp, &current_dir, &sup, name);
+                    if (h < 0) break;
+                    unsigned char *buf = malloc(count ? count : 1);
+                    long n = buf ? sacs_pread(h, buf, count, offset) : -1;
+                    for (long i = 0; i < n; i++) {
+                        printf("%02x%s", buf[i], ((i + 1) % 16 == 0) ? "\n" : " ");
+                    }
+                    printf("\n%ld bytes lidos.\n", n);
+                    free(buf);
+                    sacs_close(h);
+                }
+                break;
+            case 11: // Escrita parcial
+                {
+                    char name[20], text[200];
+                    unsigned long offset;
+                    printf("Arquivo SACS: "); scanf("%19s", name);
+                    printf("Offset: "); scanf("%lu", &offset);
+                    printf("Texto: "); scanf("%199s", text);
+                    int h = sacs_open(fp, &current_dir, &sup, name);
+                    if (h < 0) break;
+                    long n = sacs_pwrite(h, text, strlen(text), offset);
+                    printf("%ld bytes escritos (tamanho atual %ld).\n", n, sacs_size(h));
+                    sacs_close(h);
+                }
+                break;
+            case 12: // Remover recursivo
+                {
+                    char name[20];
+                    printf("Nome: "); scanf("%19s", name);
+                    delete_tree(fp, &current_dir, &sup, name);
+                }
+                break;
+            case 13: // Snapshot da árvore inteira
+                {
+                    char name[20];
+                    printf("Nome do snapshot: "); scanf("%19s", name);
+                    create_snapshot(fp, &sup, name);
+                }
+                break;
+            case 14: // Listar snapshots
+                list_snapshots(fp, &sup);
+                break;
+            case 15: // Busca na subárvore atual
+                {
+                    char pattern[20], type[4];
+                    struct find_query query;
+                    struct find_stats st;
+                    memset(&query, 0, sizeof(query));
+                    printf("Padrao (glob, * = todos): "); scanf("%19s", pattern);
+                    printf("Tipo (a = todos, f = arquivos, d = diretorios): "); scanf("%3s", type);
+                    printf("Tamanho minimo (bytes): "); scanf("%" SCNu64, &query.min_size);
+                    printf("Tamanho maximo (bytes, 0 = sem limite): "); scanf("%" SCNu64, &query.max_size);
+                    query.pattern = pattern;
+                    query.type = (type[0] == 'f') ? FIND_TYPE_FILE : (type[0] == 'd') ? FIND_TYPE_DIR : FIND_TYPE_ANY;
+                    // SACS_FIND_THREADS=<n> escolhe o tamanho do pool
+                    char *threads = getenv("SACS_FIND_THREADS");
+                    query.threads = threads ? (unsigned)atoi(threads) : 0;
+
+                    const char *base = (strcmp(current_dir.file_name, "/") == 0) ? "/" : ".";
+                    if (sacs_find(fp, &current_dir, &sup, base, &query, print_find_result, NULL, &st) >= 0) {
+                        find_print_stats(&st);
+                    }
+                }
+                break;
+            case 16: // Espaço livre
+                {
+                    struct df_report report;
+                    if (volume_df(fp, &sup, &report)) print_df(&sup, &report);
+                    else printf("Erro: Falha ao ler o bitmap.\n");
+                }
+                break;
+            case 17: // Mover/renomear
+            case 18: // Copiar
+                {
+                    char src[200], dst[200];
+                    printf("Origem (caminho): "); scanf("%199s", src);
+                    printf("Destino (caminho): "); scanf("%199s", dst);
+                    if (opcao == 17) move_item(fp, &current_dir, &sup, src, dst);
+                    else copy_file(fp, &current_dir, &sup, src, dst);
+                }
+                break;
+            case 19: // Importar de um pipe (tamanho desconhecido)
+                {
+                    char name[20], command[400];
+                    struct stream_stats st;
+                    printf("Nome no SACS: "); scanf("%19s", name);
+                    printf("Comando (ex: gzip -dc dados.gz): "); scanf(" %399[^\n]", command);
+                    FILE *pipe = popen(command, "r");
+                    if (!pipe) {
+                        printf("Erro: Nao foi possivel executar '%s'.\n", command);
+                        break;
+                    }
+                    int ok = import_stream(fp, &current_dir, &sup, fileno(pipe), name, &st);
+                    int status = pclose(pipe);
+                    if (ok) stream_print_stats(&st);
+                    if (status != 0) printf("Aviso: o comando terminou com status %d.\n", status);
+                }
+                break;
+            default: printf("Invalido.\n");
+        }
+    }
+
+    if (fp) fclose(fp);
+    trace_stop();
+    return 0;
 }
\ No newline at end of file
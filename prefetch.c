@@ -0,0 +1,71 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include "prefetch.h"
+
+// Configuração global
+static int cfg_enabled = 1;
+static unsigned cfg_max = PREFETCH_DEFAULT_MAX;
+
+// --- CONFIGURAÇÃO ---
+
+void prefetch_configure(int enabled, unsigned max_window) {
+    cfg_enabled = enabled;
+    cfg_max = (max_window >= PREFETCH_MIN_WINDOW) ? max_window : PREFETCH_DEFAULT_MAX;
+}
+
+int prefetch_enabled(void) {
+    return cfg_enabled;
+}
+
+// --- FLUXOS SEQUENCIAIS ---
+
+void prefetch_begin(struct prefetch_stream *ps, int fd, uint64_t start, uint64_t end) {
+    ps->fd = cfg_enabled ? fd : -1;
+    ps->start = start;
+    ps->end = end;
+    ps->next = start;             // A primeira leitura no início do extent já conta como sequência
+    ps->issued = start;
+    ps->window = 0;
+    ps->hints = 0;
+    ps->hinted_bytes = 0;
+    ps->sequential = 0;
+    ps->random = 0;
+}
+
+void prefetch_access(struct prefetch_stream *ps, uint64_t offset, uint64_t len) {
+    if (ps->fd < 0 || len == 0) return;
+    uint64_t access_end = offset + len;
+
+    if (offset == ps->next) {
+        ps->sequential++;
+        ps->window = ps->window ? ps->window * 2 : PREFETCH_MIN_WINDOW;
+        if (ps->window > cfg_max) ps->window = cfg_max;
+    } else {
+        // Fora de sequência: o que foi pedido antes não vale mais como referência
+        ps->random++;
+        ps->window = 0;
+        ps->issued = access_end;
+    }
+    ps->next = access_end;
+    if (ps->window == 0) return;
+
+    // A leitura atual vai ser feita agora de qualquer forma: a dica cobre só o que vem depois.
+    // Pedidos menores que meia janela esperam acumular, para não virar uma chamada por leitura.
+    uint64_t from = (ps->issued > access_end) ? ps->issued : access_end;
+    uint64_t target = access_end + ps->window;
+    if (target > ps->end) target = ps->end;
+    if (target <= from) return;
+    if (target - from < ps->window / 2 && target < ps->end) return;
+
+    if (posix_fadvise(ps->fd, (off_t)from, (off_t)(target - from), POSIX_FADV_WILLNEED) == 0) {
+        ps->hints++;
+        ps->hinted_bytes += target - from;
+    }
+    ps->issued = target;
+}
+
+void prefetch_range(int fd, uint64_t offset, uint64_t len) {
+    if (!cfg_enabled || fd < 0 || len == 0) return;
+    posix_fadvise(fd, (off_t)offset, (off_t)len, POSIX_FADV_WILLNEED);
+}
@@ -0,0 +1,39 @@
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include <stdint.h>
+
+// --- CONFIGURAÇÕES DA LEITURA ANTECIPADA ---
+#define PREFETCH_MIN_WINDOW (128 * 1024)         // Janela ao confirmar a primeira leitura em sequência
+#define PREFETCH_DEFAULT_MAX (8 * 1024 * 1024)   // Maior janela
+#define PREFETCH_DIR_AHEAD 16                    // Subdiretórios antecipados numa varredura
+
+// --- ESTRUTURAS ---
+
+// Um fluxo de leituras sobre um extent. A janela dobra a cada leitura que começa onde
+// a anterior terminou e cai para zero (sem dicas) num acesso fora de sequência.
+struct prefetch_stream {
+    int fd;                       // -1: sem descritor (volume em faixas) ou desligado
+    uint64_t start, end;          // Extent coberto; nada é pedido além de end
+    uint64_t next;                // Onde começaria a próxima leitura em sequência
+    uint64_t issued;              // Já pedido ao kernel até aqui
+    unsigned window;
+    unsigned long hints;          // Chamadas a posix_fadvise
+    uint64_t hinted_bytes;
+    unsigned long sequential;     // Leituras em sequência observadas
+    unsigned long random;         // Leituras fora de sequência
+};
+
+// --- PROTÓTIPOS DAS FUNÇÕES ---
+
+// Configuração global (lida de SACS_PREFETCH / SACS_PREFETCH_MAX pelo main). Ligada por padrão
+void prefetch_configure(int enabled, unsigned max_window);
+int prefetch_enabled(void);
+
+void prefetch_begin(struct prefetch_stream *ps, int fd, uint64_t start, uint64_t end);
+// Chamada antes de ler [offset, offset + len): ajusta a janela e pede o que vem depois
+void prefetch_access(struct prefetch_stream *ps, uint64_t offset, uint64_t len);
+// Dica isolada, sem histórico (blocos de um diretório que será visitado)
+void prefetch_range(int fd, uint64_t offset, uint64_t len);
+
+#endif // PREFETCH_H
@@ -0,0 +1,190 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include "sacs.h"
+#include "trace.h"
+#include "stripe.h"
+
+// Reexecuta um trace gravado com SACS_TRACE sobre uma imagem recém-formatada.
+// Uso: sacs_replay <trace> <imagem> [setores] [bloco] [blocos_raiz] [-t]
+//   -t : respeita os intervalos originais entre as chamadas (modo temporizado)
+// A imagem usa o formato de volumes novos; SACS_FORMAT=v1 formata no formato antigo, como no shell
+
+static const char *op_names[] = {
+    "?", "create_file", "import_file", "delete_item", "create_dir", "change_dir", "export_file",
+    "append_file", "truncate", "delete_tree", "snapshot", "move", "copy",
+    "import_stream"
+};
+
+// Cria (ou reaproveita) um arquivo externo esparso com o tamanho registrado
+static int make_source_file(const char *dir, const char *external_path, uint64_t size, char *out_path) {
+    const char *base = strrchr(external_path, '/');
+    base = base ? base + 1 : external_path;
+    snprintf(out_path, 512, "%s/%s", dir, base);
+
+    FILE *f = fopen(out_path, "wb");
+    if (!f) return 0;
+    if (size > 0 && ftruncate(fileno(f), (off_t)size) != 0) {
+        fclose(f);
+        return 0;
+    }
+    fclose(f);
+    return 1;
+}
+
+static void sleep_until(uint64_t target_ns) {
+    uint64_t now = trace_clock();
+    if (target_ns <= now) return;
+    uint64_t diff = target_ns - now;
+    struct timespec ts = { (time_t)(diff / 1000000000ULL), (long)(diff % 1000000000ULL) };
+    nanosleep(&ts, NULL);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        printf("Uso: %s <trace> <imagem> [setores] [bloco] [blocos_raiz] [-t]\n", argv[0]);
+        return 1;
+    }
+
+    const char *trace_path = argv[1];
+    const char *image_path = argv[2];
+    unsigned sectors = 2048;
+    unsigned short block_size = 2;
+    unsigned root_size = 4;
+    int timed = 0;
+
+    int pos = 0;
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "-t") == 0) { timed = 1; continue; }
+        if (pos == 0) sectors = (unsigned)strtoul(argv[i], NULL, 10);
+        else if (pos == 1) block_size = (unsigned short)strtoul(argv[i], NULL, 10);
+        else if (pos == 2) root_size = (unsigned)strtoul(argv[i], NULL, 10);
+        pos++;
+    }
+
+    FILE *tf = fopen(trace_path, "rb");
+    if (!tf) { perror("Erro ao abrir trace"); return 1; }
+
+    struct trace_header hdr;
+    if (!trace_read_header(tf, &hdr)) {
+        printf("Erro: '%s' nao e um trace SACS valido.\n", trace_path);
+        fclose(tf);
+        return 1;
+    }
+
+    // Imagem nova
+    char *format_env = getenv("SACS_FORMAT");
+    unsigned format_sysid = (format_env && strcmp(format_env, "v1") == 0) ? SACS : SACS_V2;
+    format_sacs(image_path, format_sysid, sectors, 9, block_size, root_size);
+    FILE *fp = volume_open(image_path, "r+b");
+    if (!fp) { perror("Erro ao abrir imagem"); fclose(tf); return 1; }
+
+    struct superblock sup;
+    struct dir_entry current_dir;
+    if (!mount_sacs(fp, &sup, parse_alloc_policy(getenv("SACS_ALLOC")))) {
+        fclose(fp);
+        fclose(tf);
+        return 1;
+    }
+    unsigned real_block_size = (1 << sup.sector_size) << sup.block_size;
+    fseek(fp, sup.root_start * real_block_size, SEEK_SET);
+    read_entry(fp, &current_dir);
+    strcpy(current_dir.file_name, "/");
+
+    // Diretório temporário para os arquivos de origem dos imports
+    char tmp_dir[] = "/tmp/sacs_replay_XXXXXX";
+    if (!mkdtemp(tmp_dir)) { perror("mkdtemp"); fclose(fp); fclose(tf); return 1; }
+
+    struct trace_record rec;
+    char name[256], arg[256], src_path[512];
+    unsigned long count[TRACE_OP_MAX + 1] = {0};
+    uint64_t replay_ns[TRACE_OP_MAX + 1] = {0}, orig_ns[TRACE_OP_MAX + 1] = {0};
+    uint64_t start = trace_clock();
+
+    while (trace_read_record(tf, &rec, name, arg)) {
+        if (rec.op == 0 || rec.op > TRACE_OP_MAX) {
+            printf("Aviso: operacao desconhecida %u ignorada.\n", rec.op);
+            continue;
+        }
+        if (timed) sleep_until(start + rec.offset_ns);
+
+        // Prepara a entrada antes de cronometrar
+        if ((rec.op == TRACE_OP_IMPORT_FILE || rec.op == TRACE_OP_IMPORT_STREAM) &&
+            !make_source_file(tmp_dir, name, rec.size, src_path)) {
+            printf("Aviso: nao foi possivel preparar origem para '%s'.\n", name);
+            continue;
+        }
+
+        uint64_t t0 = trace_clock();
+        switch (rec.op) {
+            case TRACE_OP_CREATE_FILE:
+                create_file(fp, &current_dir, &sup, name, rec.size, NULL);
+                break;
+            case TRACE_OP_IMPORT_FILE:
+                import_file(fp, &current_dir, &sup, src_path);
+                remove(src_path);
+                break;
+            case TRACE_OP_DELETE_ITEM:
+                delete_item(fp, &current_dir, &sup, name);
+                break;
+            case TRACE_OP_CREATE_DIR:
+                create_dir(fp, &current_dir, &sup, name);
+                break;
+            case TRACE_OP_CHANGE_DIR:
+                change_directory(fp, &current_dir, &sup, name);
+                break;
+            case TRACE_OP_EXPORT_FILE:
+                export_file(fp, &current_dir, &sup, name, "/dev/null");
+                break;
+            case TRACE_OP_APPEND_FILE:
+                append_file(fp, &current_dir, &sup, name, NULL, rec.size);
+                break;
+            case TRACE_OP_TRUNCATE_FILE:
+                truncate_file(fp, &current_dir, &sup, name, rec.size);
+                break;
+            case TRACE_OP_DELETE_TREE:
+                delete_tree(fp, &current_dir, &sup, name);
+                break;
+            case TRACE_OP_SNAPSHOT:
+                create_snapshot(fp, &sup, name);
+                break;
+            case TRACE_OP_MOVE:
+                move_item(fp, &current_dir, &sup, name, arg);
+                break;
+            case TRACE_OP_COPY:
+                copy_file(fp, &current_dir, &sup, name, arg);
+                break;
+            case TRACE_OP_IMPORT_STREAM:
+                {
+                    FILE *src = fopen(src_path, "rb");
+                    if (src) {
+                        import_stream(fp, &current_dir, &sup, fileno(src), name, NULL);
+                        fclose(src);
+                    }
+                    remove(src_path);
+                }
+                break;
+        }
+        replay_ns[rec.op] += trace_clock() - t0;
+        orig_ns[rec.op] += rec.elapsed_ns;
+        count[rec.op]++;
+    }
+
+    uint64_t total = trace_clock() - start;
+    fclose(fp);
+    fclose(tf);
+    rmdir(tmp_dir);
+
+    printf("\n--- REPLAY (%s) ---\n", timed ? "temporizado" : "maxima velocidade");
+    printf("%-12s %8s %14s %14s\n", "Operacao", "Chamadas", "Original(us)", "Replay(us)");
+    for (int op = 1; op <= TRACE_OP_MAX; op++) {
+        if (!count[op]) continue;
+        printf("%-12s %8lu %14.1f %14.1f\n", op_names[op], count[op],
+               orig_ns[op] / 1000.0, replay_ns[op] / 1000.0);
+    }
+    printf("Tempo total: %.3f ms\n", total / 1e6);
+    return 0;
+}
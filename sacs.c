@@ -1,925 +1,4058 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <stdint.h>
-#include <limits.h>
-#include "sacs.h"
-
-
-// --- FUNÇÕES AUXILIARES DE BITS ---
-
-void set_bit(unsigned char *bitmap_buffer, int block_index) {
-    bitmap_buffer[block_index / 8] |= (1 << (block_index % 8));
-}
-
-int get_bit(unsigned char *bitmap, int index) {
-    return (bitmap[index / 8] >> (index % 8)) & 1;
-}
-
-void unset_bit(unsigned char *bitmap_buffer, int block_index) {
-    int byte_offset = block_index / 8;
-    int bit_offset  = block_index % 8;
-    bitmap_buffer[byte_offset] &= ~(1 << bit_offset);
-}
-
-
-// ALOCAÇÃO 
-long int contiguous_alloc(FILE *fp, unsigned file_size, unsigned real_block_size, 
-                          unsigned bitmap_start, unsigned total_blocks) {
-    long old_pos = ftell(fp);
-
-    unsigned blocks_needed = (file_size + real_block_size - 1) / real_block_size;
-    if (blocks_needed == 0) blocks_needed = 1;
-//
-    unsigned long bitmap_start_offset = (unsigned long)bitmap_start * real_block_size;
-    unsigned long total_bitmap_bytes = (total_blocks + 7) / 8;
-
-
-    unsigned int chunk_size_bytes = real_block_size;
-    unsigned int bits_per_chunk = chunk_size_bytes * 8;
-    
-    unsigned char *chunk = (unsigned char *)malloc(chunk_size_bytes);
-    if (!chunk) { return -1; }
-
-    // --- FASE 1: SCAN ---
-    int best_start = -1;
-    unsigned int best_len = UINT_MAX; 
-    
-    int current_start = -1;
-    unsigned int current_len = 0;
-    
-    unsigned int global_bit_index = 0;
-    unsigned long bytes_processed = 0;
-    int search_complete = 0;
-
-    fseek(fp, bitmap_start_offset, SEEK_SET);
-
-    while (bytes_processed < total_bitmap_bytes) {
-        // Lê 1 bloco de bitmap por vez (ou o resto)
-        size_t read_size = chunk_size_bytes;
-        if (total_bitmap_bytes - bytes_processed < read_size) {
-            read_size = total_bitmap_bytes - bytes_processed;
-        }
-        
-        memset(chunk, 0, chunk_size_bytes); 
-        fread(chunk, 1, read_size, fp);
-
-        int bits_to_check = read_size * 8;
-        
-        for (int local_bit = 0; local_bit < bits_to_check; local_bit++) {
-            if (global_bit_index >= total_blocks) break;
-
-            if (!get_bit(chunk, local_bit)) { // Livre
-                if (current_start == -1) current_start = global_bit_index;
-                current_len++;
-            } else { // Ocupado
-                if (current_start != -1) {
-                    if (current_len >= blocks_needed) {
-                        if (current_len < best_len) {
-                            best_len = current_len;
-                            best_start = current_start;
-                            if (best_len == blocks_needed) {
-                                search_complete = 1;
-                                break;
-                            }
-                        }
-                    }
-                    current_start = -1;
-                    current_len = 0;
-                }
-            }
-            global_bit_index++;
-        }
-        if (search_complete) break;
-        bytes_processed += read_size;
-    }
-    
-    if (!search_complete && current_start != -1 && current_len >= blocks_needed) {
-        if (current_len < best_len) best_start = current_start;
-    }
-
-    // --- FASE 2: COMMIT ---
-    if (best_start != -1) {
-        if (best_start == 0) {
-             printf("ERRO: Tentativa de alocar Superbloco.\n");
-             free(chunk); fseek(fp, old_pos, SEEK_SET); return -1;
-        }
-
-        unsigned int start_bit = best_start;
-        unsigned int end_bit = best_start + blocks_needed - 1;
-
-        unsigned long start_chunk_idx = start_bit / bits_per_chunk;
-        unsigned long end_chunk_idx = end_bit / bits_per_chunk;
-
-        for (unsigned long c = start_chunk_idx; c <= end_chunk_idx; c++) {
-            unsigned long chunk_offset_disk = bitmap_start_offset + (c * chunk_size_bytes);
-            
-            fseek(fp, chunk_offset_disk, SEEK_SET);
-            memset(chunk, 0, chunk_size_bytes);
-            fread(chunk, 1, chunk_size_bytes, fp);
-
-            unsigned int chunk_start_global = c * bits_per_chunk;
-            unsigned int chunk_end_global = (c + 1) * bits_per_chunk - 1;
-
-            unsigned int mark_start = (start_bit > chunk_start_global) ? start_bit : chunk_start_global;
-            unsigned int mark_end = (end_bit < chunk_end_global) ? end_bit : chunk_end_global;
-
-            unsigned int local_start = mark_start % bits_per_chunk;
-            unsigned int local_end = mark_end % bits_per_chunk;
-
-            for (unsigned int i = local_start; i <= local_end; i++) {
-                set_bit(chunk, i);
-            }
-
-            fseek(fp, chunk_offset_disk, SEEK_SET);
-            fwrite(chunk, 1, chunk_size_bytes, fp);
-        }
-    }
-
-    free(chunk); 
-    fseek(fp, old_pos, SEEK_SET);
-    return best_start;
-}
-
-//Atualiza quantidade de bytes nas pastas acima na hierarquia (igual windows)
-void update_hierarchy_size(FILE *fp, unsigned start_block, int delta, unsigned block_size) {
-    long old_pos = ftell(fp);
-    unsigned current_block = start_block;
-    
-    // Loop para subir a árvore até a raiz
-    while (1) {
-        unsigned long current_offset = (unsigned long)current_block * block_size;
-        struct dir_entry dot, dotdot;
-
-        // Atualiza o . do diretório atual 
-        fseek(fp, current_offset, SEEK_SET);
-        fread(&dot, ENTRY_SIZE, 1, fp); // Lê entrada 0 (.)
-        
-        int new_size = (int)dot.size + delta;
-        if (new_size < 0) new_size = 0; // Proteção contra valor negativo
-        dot.size = (unsigned)new_size;
-
-        fseek(fp, current_offset, SEEK_SET);
-        fwrite(&dot, ENTRY_SIZE, 1, fp); // Grava . atualizado
-
-        // Lê o PAI ..
-        fseek(fp, current_offset + ENTRY_SIZE, SEEK_SET); // Lê entrada 1 (..)
-        fread(&dotdot, ENTRY_SIZE, 1, fp);
-
-        // Se raiz . == ..
-        if (dotdot.start_block == current_block) {
-            // Atualiza o ".." da raiz também para ficar igual ao "."
-            dotdot.size = dot.size;
-            fseek(fp, current_offset + ENTRY_SIZE, SEEK_SET);
-            fwrite(&dotdot, ENTRY_SIZE, 1, fp);
-            break; 
-        }
-
-        // Atualiza a entrada que representa ESTE diretório no PAI 
-        unsigned parent_block = dotdot.start_block;
-        unsigned long parent_offset = (unsigned long)parent_block * block_size;
-        
-        struct dir_entry temp;
-
-        // Precisamos varrer o pai para encontrar a entrada que tem 'current_block'
-        fseek(fp, parent_offset, SEEK_SET);
-        fread(&temp, ENTRY_SIZE, 1, fp); 
-        unsigned int max = (temp.length * block_size) / ENTRY_SIZE;
-
-        int found = 0;
-        for(unsigned int i=0; i < max; i++) {
-            unsigned long entry_addr = parent_offset + (i * ENTRY_SIZE);
-            fseek(fp, entry_addr, SEEK_SET);
-            fread(&temp, ENTRY_SIZE, 1, fp);
-            
-            // Se esta entrada aponta para o diretório que acabamos de atualizar
-            if (temp.status == 1 && temp.start_block == current_block) {
-                temp.size = dot.size; // Copia o tamanho acumulado do filho
-                fseek(fp, entry_addr, SEEK_SET);
-                fwrite(&temp, ENTRY_SIZE, 1, fp);
-                found = 1;
-                break; 
-            }
-        }
-
-        if (!found) {
-            printf("DEBUG: Erro de consistência. Não achei o filho %u no pai %u.\n", current_block, parent_block);
-            break;
-        }
-
-        // Sobe um nível
-        current_block = parent_block;
-    }
-
-    fseek(fp, old_pos, SEEK_SET);
-}
-
-
-// Retorna 1 se já existe, 0 se não existe
-int check_duplicate(FILE *fp, struct dir_entry *parent, char *name, unsigned block_size) {
-    struct dir_entry temp_entry;
-    unsigned long parent_start_pos = (unsigned long)parent->start_block * block_size;
-    unsigned int max_entries = (parent->length * block_size) / ENTRY_SIZE;
-
-    long old_pos = ftell(fp);
-
-    for (unsigned int i = 0; i < max_entries; i++) {
-        unsigned long current_pos = parent_start_pos + (i * ENTRY_SIZE);
-        
-        fseek(fp, current_pos, SEEK_SET);
-        if (fread(&temp_entry, ENTRY_SIZE, 1, fp) != 1) break;
-
-        // Verifica apenas arquivos VÁLIDOS 
-        if (temp_entry.status == STATUS_VALID) {
-            // Compara os nomes
-            if (strncmp(temp_entry.file_name, name, 16) == 0) {
-                fseek(fp, old_pos, SEEK_SET); // Restaura posição
-                return 1; // Encontrou duplicata
-            }
-        }
-    }
-
-    fseek(fp, old_pos, SEEK_SET); // Restaura posição
-    return 0; // Não encontrou
-}
-
-
-// DESALOCAR
-void contiguous_dealloc(FILE *fp, unsigned start_block, unsigned length_in_blocks, 
-                        unsigned bitmap_start, unsigned real_block_size,
-                        unsigned data_start) {
-    
-    // Segurança
-    if (start_block < data_start) {
-        printf("ERRO CRÍTICO: Tentativa de desalocar metadados (%u).\n", start_block);
-        return;
-    }
-    if (length_in_blocks == 0) return;
-
-    long old_pos = ftell(fp);
-    unsigned long bitmap_start_offset = (unsigned long)bitmap_start * real_block_size;
-
-    // Chunk dinamico
-    unsigned int chunk_size_bytes = real_block_size;
-    unsigned int bits_per_chunk = chunk_size_bytes * 8;
-
-    // Aloca buffer dinamicamente
-    unsigned char *chunk = (unsigned char *)malloc(chunk_size_bytes);
-    if (!chunk) {
-        printf("Erro de memória no dealloc.\n");
-        fseek(fp, old_pos, SEEK_SET);
-        return;
-    }
-
-    // Intervalo Global
-    unsigned int start_bit = start_block;
-    unsigned int end_bit = start_block + length_in_blocks - 1;
-
-    // Identificar quais "Blocos de Bitmap" afetam a operação
-    unsigned long start_chunk_idx = start_bit / bits_per_chunk;
-    unsigned long end_chunk_idx = end_bit / bits_per_chunk;
-
-    // Iterar sobre os chunks
-    for (unsigned long c = start_chunk_idx; c <= end_chunk_idx; c++) {
-        
-        unsigned long chunk_offset_disk = bitmap_start_offset + (c * chunk_size_bytes);
-        
-        // Carrega o chunk 
-        fseek(fp, chunk_offset_disk, SEEK_SET);
-        memset(chunk, 0, chunk_size_bytes);
-        fread(chunk, 1, chunk_size_bytes, fp);
-
-        // Define limites Globais deste chunk
-        unsigned int chunk_start_global = c * bits_per_chunk;
-        unsigned int chunk_end_global = (c + 1) * bits_per_chunk - 1;
-
-        // Interseção
-        unsigned int mark_start = (start_bit > chunk_start_global) ? start_bit : chunk_start_global;
-        unsigned int mark_end = (end_bit < chunk_end_global) ? end_bit : chunk_end_global;
-
-        // Coordenadas Locais
-        unsigned int local_start = mark_start % bits_per_chunk;
-        unsigned int local_end = mark_end % bits_per_chunk;
-
-        // Modifica
-        for (unsigned int i = local_start; i <= local_end; i++) {
-            unset_bit(chunk, i);
-        }
-
-        // Salva
-        fseek(fp, chunk_offset_disk, SEEK_SET);
-        fwrite(chunk, 1, chunk_size_bytes, fp);
-    }
-
-    free(chunk); 
-    fflush(fp);
-    fseek(fp, old_pos, SEEK_SET);
-}
-
-
-// PREPARAR STRUCT
-void prepare_dir_entry(struct dir_entry *entry, char *file_name, unsigned short file_type, 
-                      unsigned size, unsigned start_block, unsigned block_size){
-    memset(entry, 0, sizeof(struct dir_entry));
-    entry->status = STATUS_VALID;
-    strncpy(entry->file_name, file_name, 16);
-    entry->file_type = file_type;
-    entry->start_block = start_block;
-    entry->size = size;
-    entry->length = (block_size > 0) ? (size + block_size - 1) / block_size : 0;
-}
-
-// ADICIONAR AO PAI 
-int add_entry_to_parent(FILE *fp, struct dir_entry *parent, struct dir_entry *new_entry, unsigned block_size) {
-    struct dir_entry temp_entry;
-    unsigned long parent_start_pos = (unsigned long)parent->start_block * block_size;
-    unsigned int max_entries = (parent->length * block_size) / ENTRY_SIZE;
-
-    for (unsigned int i = 0; i < max_entries; i++) {
-        unsigned long current_pos = parent_start_pos + (i * ENTRY_SIZE);
-        
-        fseek(fp, current_pos, SEEK_SET);
-        if (fread(&temp_entry, ENTRY_SIZE, 1, fp) != 1) break;
-
-        if (temp_entry.status == STATUS_FREE) {
-            fseek(fp, current_pos, SEEK_SET);
-            fwrite(new_entry, ENTRY_SIZE, 1, fp);
-            return 1; // Sucesso
-        }
-    }
-    return 0; // Pai cheio
-}
-
-// CRIAR ARQUIVO E DIRETÓRIO
-void create_file(FILE *fp, struct dir_entry *parent_dir, struct superblock *sup, 
-                 char *file_name, unsigned size, char *data) {
-    
-    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
-
-    if (check_duplicate(fp, parent_dir, file_name, real_block_size)) {
-        printf("Erro: O arquivo '%s' ja existe neste diretorio.\n", file_name);
-        return; // Aborta imediatamente
-    }
-
-    unsigned blocks_needed = (size + real_block_size - 1) / real_block_size;
-    if (blocks_needed == 0) blocks_needed = 1;
-    long int file_start = contiguous_alloc(fp, size, real_block_size, sup->bitmap_start, sup->total_blocks);
-    
-    if (file_start == -1) {
-        printf("Erro: Disco cheio p/ arquivo '%s'.\n", file_name);
-        contiguous_dealloc(fp, file_start, blocks_needed, sup->bitmap_start, 
-                            real_block_size, sup->data_start);
-        return;
-    }
-
-    struct dir_entry new_entry;
-    prepare_dir_entry(&new_entry, file_name, TYPE_FILE, size, file_start, real_block_size);
-
-    if (add_entry_to_parent(fp, parent_dir, &new_entry, real_block_size)) {
-        if (size > 0 && data != NULL) {
-            fseek(fp, file_start * real_block_size, SEEK_SET);
-            fwrite(data, 1, size, fp);
-        }
-        update_hierarchy_size(fp, parent_dir->start_block, (int)size, real_block_size);
-        parent_dir->size += size;
-        printf("Arquivo '%s' criado no bloco %ld.\n", file_name, file_start);
-    } else {
-        printf("Erro: Diretorio pai cheio.\n");
-        contiguous_dealloc(fp, file_start, blocks_needed, sup->bitmap_start, 
-                            real_block_size, sup->data_start);
-    }
-}
-
-void create_dir(FILE *fp, struct dir_entry *parent_dir, struct superblock *sup, char *dir_name) {
-    
-    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
-
-    // Nao permitir arquivos/diretorios de nomes iguais
-    if (check_duplicate(fp, parent_dir, dir_name, real_block_size)) {
-        printf("Erro: O diretorio/arquivo '%s' ja existe.\n", dir_name);
-        return;
-    }
-
-    // Tamanho Lógico: Apenas . e .. 
-    unsigned dir_logical_size = ENTRY_SIZE * 2; 
-    
-    // Tamanho Físico para alocar: 1 Bloco inteiro
-    unsigned alloc_size = real_block_size; 
-
-    // Aloca 
-    long int dir_start = contiguous_alloc(fp, alloc_size, real_block_size, sup->bitmap_start, sup->total_blocks);
-    
-    if (dir_start == -1) {
-        printf("Erro: Espaço insuficiente.\n");
-        return;
-    }
-
-    // Prepara entrada com tamanho logico
-    struct dir_entry new_dir_entry;
-    prepare_dir_entry(&new_dir_entry, dir_name, TYPE_DIR, dir_logical_size, dir_start, real_block_size);
-
-    // Adiciona ao pai
-    if (add_entry_to_parent(fp, parent_dir, &new_dir_entry, real_block_size)) {
-        
-        // Inicializa o conteúdo do novo diretório
-        unsigned char *zeros = calloc(1, real_block_size);
-        fseek(fp, dir_start * real_block_size, SEEK_SET);
-        fwrite(zeros, 1, real_block_size, fp);
-        free(zeros);
-
-        struct dir_entry dot, dotdot;
-        
-        // Ponto (.): Tamanho lógico inicial (64)
-        prepare_dir_entry(&dot, ".", TYPE_DIR, dir_logical_size, dir_start, real_block_size);
-        
-        // Ponto-Ponto (..): Aponta para o pai (tamanho atual do pai)
-        prepare_dir_entry(&dotdot, "..", TYPE_DIR, parent_dir->size, parent_dir->start_block, real_block_size);
-
-        fseek(fp, dir_start * real_block_size, SEEK_SET);
-        fwrite(&dot, ENTRY_SIZE, 1, fp);
-        fwrite(&dotdot, ENTRY_SIZE, 1, fp);
-
-        // Atualização em cascata
-        update_hierarchy_size(fp, parent_dir->start_block, (int)dir_logical_size, real_block_size);
-        
-        // Atualiza memória local
-        parent_dir->size += dir_logical_size;
-        
-        printf("Diretório '%s' criado (Bloco %ld, Tamanho %u).\n", dir_name, dir_start, dir_logical_size);
-    } else {
-        // Rollback
-        printf("Erro: Diretório pai cheio. Revertendo...\n");
-        contiguous_dealloc(fp, dir_start, 1, sup->bitmap_start, real_block_size, sup->data_start);
-    }
-}
-
-// Remover arquivo/diretorio
-int delete_item(FILE *fp, struct dir_entry *parent, struct superblock *sup, char *name) {
-    unsigned int real_block_size = (1 << sup->sector_size) << sup->block_size;
-    struct dir_entry temp_entry;
-    
-    // Cálculo da área de dados do diretório pai
-    unsigned long parent_start_pos = (unsigned long)parent->start_block * real_block_size;
-    unsigned int max_entries = (parent->length * real_block_size) / ENTRY_SIZE;
-
-    long old_pos = ftell(fp); 
-    int found_index = -1;
-
-    // Procurar o arquivo pelo nome
-    for (unsigned int i = 0; i < max_entries; i++) {
-        unsigned long current_pos = parent_start_pos + (i * ENTRY_SIZE);
-        
-        fseek(fp, current_pos, SEEK_SET);
-        if (fread(&temp_entry, ENTRY_SIZE, 1, fp) != 1) break;
-
-        // Verifica se é válido e se o nome bate
-        if (temp_entry.status == STATUS_VALID) {
-            if (strncmp(temp_entry.file_name, name, 16) == 0) {
-                found_index = i;
-                break; 
-            }
-        }
-    }
-
-    if (found_index == -1) {
-        printf("Erro: Arquivo '%s' não encontrado.\n", name);
-        fseek(fp, old_pos, SEEK_SET);
-        return 0;
-    }
-
-    // Validações de Segurança
-    if (strcmp(temp_entry.file_name, ".") == 0 || strcmp(temp_entry.file_name, "..") == 0) {
-        printf("Erro: Não é possível deletar '.' ou '..'.\n");
-        fseek(fp, old_pos, SEEK_SET);
-        return 0;
-    }
-
-    //Nao deve ser possivel deletar o diretorio raiz
-    if (temp_entry.start_block == sup->root_start) {
-        printf("ERRO CRÍTICO: Não é possível deletar o Diretório Raiz.\n");
-        fseek(fp, old_pos, SEEK_SET);
-        return 0;
-    }
-
-    // Se for diretório, verificar se está vazio
-    if (temp_entry.file_type == TYPE_DIR) {
-        if (temp_entry.size > (ENTRY_SIZE * 2)) {
-            printf("Erro: O diretório '%s' não está vazio.\n", name);
-            fseek(fp, old_pos, SEEK_SET);
-            return 0;
-        }
-    }
-
-    unsigned int size_to_remove = temp_entry.size;
-
-    // Desalocar os blocos no Bitmap
-    contiguous_dealloc(fp, temp_entry.start_block, temp_entry.length, 
-                       sup->bitmap_start, real_block_size, sup->data_start);
-
-    // Marcar a entrada como LIVRE
-    temp_entry.status = STATUS_FREE; 
-    
-    unsigned long entry_pos = parent_start_pos + (found_index * ENTRY_SIZE);
-    fseek(fp, entry_pos, SEEK_SET);
-    fwrite(&temp_entry, ENTRY_SIZE, 1, fp);
-
-    update_hierarchy_size(fp, parent->start_block, -(int)size_to_remove, real_block_size);
-
-    // Atualizar o tamanho do Pai
-    if (parent->size >= size_to_remove) parent->size -= size_to_remove;
-    else parent->size = 0;
-
-    printf("Sucesso: '%s' foi deletado e os blocos liberados.\n", name);
-    
-    fseek(fp, old_pos, SEEK_SET); 
-    return 1;
-}
-
-// cd
-int change_directory(FILE *fp, struct dir_entry *current_dir, struct superblock *sup, char *target_name) {
-    unsigned int real_block_size = (1 << sup->sector_size) << sup->block_size;
-    struct dir_entry entry;
-    
-    unsigned long parent_start = (unsigned long)current_dir->start_block * real_block_size;
-    unsigned int max_entries = (current_dir->length * real_block_size) / ENTRY_SIZE;
-    
-    long old_pos = ftell(fp);
-    int found = 0;
-
-    // Procura o diretório alvo na pasta atual
-    for (unsigned int i = 0; i < max_entries; i++) {
-        fseek(fp, parent_start + (i * ENTRY_SIZE), SEEK_SET);
-        if (fread(&entry, ENTRY_SIZE, 1, fp) != 1) break;
-
-        if (entry.status == 1 && strncmp(entry.file_name, target_name, 16) == 0) {
-            if (entry.file_type == TYPE_DIR) {
-                found = 1;
-                break;
-            } else {
-                printf("Erro: '%s' e um arquivo, nao um diretorio.\n", target_name);
-                fseek(fp, old_pos, SEEK_SET);
-                return 0;
-            }
-        }
-    }
-
-    if (!found) {
-        printf("Erro: Diretorio '%s' nao encontrado.\n", target_name);
-        fseek(fp, old_pos, SEEK_SET);
-        return 0;
-    }
-
-    // Entra no diretório e le o .
-    unsigned long target_block_addr = (unsigned long)entry.start_block * real_block_size;
-    fseek(fp, target_block_addr, SEEK_SET);
-    fread(current_dir, ENTRY_SIZE, 1, fp);
-
-    // Mostrar o nome da pasta que está no printf
-    if (strcmp(target_name, ".") != 0 && strcmp(target_name, "..") != 0) {
-        strncpy(current_dir->file_name, target_name, 16);
-    }
-
-    printf("Mudou para diretorio: %s (Bloco %u)\n", current_dir->file_name, current_dir->start_block);
-    
-    fseek(fp, old_pos, SEEK_SET);
-    return 1;
-}
-
-void import_file(FILE *fp_sacs, struct dir_entry *parent, struct superblock *sup, char *external_path) {
-    unsigned int real_block_size = (1 << sup->sector_size) << sup->block_size;
-
-    // Abrir arquivo externo 
-    FILE *f_ext = fopen(external_path, "rb");
-    if (!f_ext) {
-        printf("Erro: Arquivo externo '%s' nao encontrado.\n", external_path);
-        return;
-    }
-
-    // Descobrir tamanho do arquivo externo
-    fseek(f_ext, 0, SEEK_END);
-    unsigned long file_size = ftell(f_ext);
-    fseek(f_ext, 0, SEEK_SET); // Volta para o início
-
-    // Extrair apenas o nome do arquivo (remove o caminho /home/user/...)
-    char *filename = strrchr(external_path, '/');
-    if (filename) filename++; // Pula a barra
-    else filename = external_path;
-
-    // Verificação de Duplicata
-    if (check_duplicate(fp_sacs, parent, filename, real_block_size)) {
-        printf("Erro: O arquivo '%s' ja existe na pasta de destino.\n", filename);
-        fclose(f_ext);
-        return;
-    }
-
-    // Alocar espaço no Bitmap
-    long int sacs_start_block = contiguous_alloc(fp_sacs, file_size, real_block_size, 
-                                                 sup->bitmap_start, sup->total_blocks);
-    
-    if (sacs_start_block == -1) {
-        printf("Erro: Espaço insuficiente no disco para %lu bytes.\n", file_size);
-        fclose(f_ext);
-        return;
-    }
-
-    // Preparar e Adicionar a Entrada no Diretório Pai
-    struct dir_entry new_entry;
-    prepare_dir_entry(&new_entry, filename, TYPE_FILE, file_size, sacs_start_block, real_block_size); 
-
-    if (!add_entry_to_parent(fp_sacs, parent, &new_entry, real_block_size)) {
-        printf("Erro: Diretório cheio (limite de arquivos atingido). Revertendo...\n");
-        
-        // Rollback: Libera os blocos que acabamos de alocar
-        unsigned blocks_needed = (file_size + real_block_size - 1) / real_block_size;
-        contiguous_dealloc(fp_sacs, sacs_start_block, blocks_needed, 
-                           sup->bitmap_start, real_block_size, sup->data_start);
-        fclose(f_ext);
-        return;
-    }
-
-    // Escrever os Dados
-    unsigned char *buffer = malloc(real_block_size);
-    if (!buffer) {
-        printf("Erro fatal de memória RAM.\n");
-        fclose(f_ext);
-        return; 
-    }
-
-    unsigned long bytes_remaining = file_size;
-    unsigned long offset = 0;
-
-    printf("Importando '%s' para o Bloco %ld...", filename, sacs_start_block);
-    
-    while (bytes_remaining > 0) {
-        // Lê o que der
-        size_t chunk_size = (bytes_remaining < real_block_size) ? bytes_remaining : real_block_size;
-        
-        // Lê da fonte
-        fread(buffer, 1, chunk_size, f_ext);
-
-        // Calcula posição no SACS e escreve
-        unsigned long sacs_write_pos = ((unsigned long)sacs_start_block * real_block_size) + offset;
-        fseek(fp_sacs, sacs_write_pos, SEEK_SET);
-        fwrite(buffer, 1, chunk_size, fp_sacs);
-
-        bytes_remaining -= chunk_size;
-        offset += chunk_size;
-    }
-
-    free(buffer);
-    fclose(f_ext);
-
-    // Atualização de tamanho em cascata
-    update_hierarchy_size(fp_sacs, parent->start_block, (int)file_size, real_block_size);
-    
-    // Atualiza a estrutura local na memória
-    parent->size += file_size; 
-
-    printf(" Sucesso! (%lu bytes adicionados a hierarquia)\n", file_size);
-}
-
-void export_file(FILE *fp_sacs, struct dir_entry *parent, struct superblock *sup, 
-                 char *sacs_filename, char *dest_path) {
-    
-    unsigned int real_block_size = (1 << sup->sector_size) << sup->block_size;
-    struct dir_entry entry;
-    int found = 0;
-
-    // Localizar arquivo no SACS
-    unsigned long parent_start = (unsigned long)parent->start_block * real_block_size;
-    unsigned int max_entries = (parent->length * real_block_size) / ENTRY_SIZE;
-
-    long old_pos = ftell(fp_sacs); // SAVE
-
-    for (unsigned int i = 0; i < max_entries; i++) {
-        fseek(fp_sacs, parent_start + (i * ENTRY_SIZE), SEEK_SET);
-        if (fread(&entry, ENTRY_SIZE, 1, fp_sacs) != 1) break;
-
-        if (entry.status == STATUS_VALID && strncmp(entry.file_name, sacs_filename, 16) == 0) {
-            found = 1;
-            break;
-        }
-    }
-
-    if (!found) {
-        printf("Erro: Arquivo '%s' nao encontrado no SACS.\n", sacs_filename);
-        fseek(fp_sacs, old_pos, SEEK_SET);
-        return;
-    }
-    
-    if (entry.file_type == TYPE_DIR) {
-        printf("Erro: '%s' e um diretorio.\n", sacs_filename);
-        fseek(fp_sacs, old_pos, SEEK_SET);
-        return;
-    }
-
-    // Preparar Destino
-    FILE *f_out = fopen(dest_path, "wb");
-    if (!f_out) {
-        perror("Erro ao criar arquivo de destino");
-        fseek(fp_sacs, old_pos, SEEK_SET);
-        return;
-    }
-
-    // CÓPIA EM CHUNKS
-    unsigned char *buffer = malloc(real_block_size);
-    if (!buffer) { fclose(f_out); fseek(fp_sacs, old_pos, SEEK_SET); return; }
-
-    unsigned long bytes_remaining = entry.size;
-    unsigned long offset = 0;
-
-    printf("Exportando '%s' para '%s'...", sacs_filename, dest_path);
-
-    while (bytes_remaining > 0) {
-        size_t chunk_size = (bytes_remaining < real_block_size) ? bytes_remaining : real_block_size;
-
-        // Calcula posição de leitura no SACS
-        unsigned long sacs_read_pos = ((unsigned long)entry.start_block * real_block_size) + offset;
-
-        // Lê do SACS
-        fseek(fp_sacs, sacs_read_pos, SEEK_SET);
-        fread(buffer, 1, chunk_size, fp_sacs);
-
-        // Escreve no destino
-        fwrite(buffer, 1, chunk_size, f_out);
-
-        bytes_remaining -= chunk_size;
-        offset += chunk_size;
-    }
-
-    free(buffer);
-    fclose(f_out);
-    fseek(fp_sacs, old_pos, SEEK_SET); // RESTORE
-    
-    printf(" Concluido!\n");
-}
-
-// Função auxiliar para ler o tamanho real de um diretório alvo
-unsigned int get_real_dir_size(FILE *fp, unsigned int block_index, unsigned int block_size) {
-    struct dir_entry target_dot;
-    long old_pos = ftell(fp);
-    
-    // Vai até o bloco do diretório e lê a primeira entrada "."
-    fseek(fp, (unsigned long)block_index * block_size, SEEK_SET);
-    fread(&target_dot, sizeof(struct dir_entry), 1, fp);
-    
-    fseek(fp, old_pos, SEEK_SET); // Restaura posição
-    return target_dot.size;
-}
-
-// Listar os arquivos no FS a partir do diretório atual
-void list_recursive(FILE *fp, struct dir_entry *current_dir, struct superblock *sup, int level) {
-    unsigned int real_block_size = (1 << sup->sector_size) << sup->block_size;
-    struct dir_entry entry;
-    
-    unsigned long dir_start_pos = (unsigned long)current_dir->start_block * real_block_size;
-    unsigned int max_entries = (current_dir->length * real_block_size) / ENTRY_SIZE; 
-
-    char indent[50] = "";
-    for(int k=0; k<level; k++) strcat(indent, "   |");
-
-    for (unsigned int i = 0; i < max_entries; i++) {
-        fseek(fp, dir_start_pos + (i * ENTRY_SIZE), SEEK_SET);
-        if (fread(&entry, ENTRY_SIZE, 1, fp) != 1) break;
-
-        if (entry.status == STATUS_VALID) {             
-            unsigned int display_size = entry.size;
-
-            // Se for "..", ignora o tamanho gravado e busca o tamanho real do pai
-            if (strncmp(entry.file_name, "..", 2) == 0) {
-                 display_size = get_real_dir_size(fp, entry.start_block, real_block_size);
-            }
-
-            char type_char = (entry.file_type == TYPE_DIR) ? 'D' : 'F'; 
-            printf("%s-- [%c] %s (%u bytes)\n", indent, type_char, entry.file_name, display_size);
-
-            // Recursão
-            if (entry.file_type == TYPE_DIR && strcmp(entry.file_name, ".") != 0 && strcmp(entry.file_name, "..") != 0) {
-                long parent_pos = ftell(fp);
-                list_recursive(fp, &entry, sup, level + 1);
-                fseek(fp, parent_pos, SEEK_SET);
-            }
-        }
-    }
-}
-
-// Printar Superbloco
-void print_sup(struct superblock *sup){
-    
-    printf("Sysid = %u\n", sup->sysid);
-    printf("Sector_size = %hu = %u \n", sup->sector_size, 1 << (sup->sector_size));
-    printf("Total Blocks = %u\n", sup->total_blocks);
-    printf("Block size = %hu = %u\n", sup->block_size, (1 << (sup->sector_size)) << sup->block_size);
-    printf("Bitmap Start = %u\n", sup->bitmap_start);
-    printf("Bitmap Size = %u\n", sup->bitmap_size);
-    printf("Root Start = %u\n", sup->root_start);
-    printf("Root Size = %u\n", sup->root_size);
-    printf("Data Start = %u\n", sup->data_start);
-}
-
-
-// Formatador
-void format_sacs(const char *filename, unsigned int sysid, unsigned sector_count, unsigned short sector_size, unsigned short block_size, unsigned int root_size){
-    
-    printf("--- FORMATANDO %s ---\n", filename);
-    FILE *fp = fopen(filename, "wb"); // "wb" cria ou sobrescreve
-    if (!fp) { perror("Erro ao abrir dispositivo/arquivo"); exit(1); }
-
-    struct superblock sup;
-    memset(&sup, 0, sizeof(struct superblock));
-
-    sup.sysid = sysid;
-    sup.sector_size = sector_size;
-    sup.block_size = block_size;
-    unsigned int real_block_size = (1 << (sup.sector_size)) << sup.block_size;
-    sup.total_blocks = (sector_count + ((1 << sup.block_size)-1)) / (1 << sup.block_size);  
-    sup.bitmap_start = 1;
-    unsigned int bits_needed = sup.total_blocks;
-    unsigned int bytes_needed = (bits_needed + 7) / 8;
-    sup.bitmap_size = (bytes_needed + real_block_size - 1) / real_block_size;
-    if (sup.bitmap_size == 0) sup.bitmap_size = 1;
-    sup.root_start = sup.bitmap_start + sup.bitmap_size;
-    sup.root_size = root_size;
-    sup.data_start = sup.root_start + sup.root_size;  
-    print_sup(&sup);
-    printf("Size of SuperBlock = %lu\nSize of DirEntry = %lu\n",
-            sizeof(struct superblock), sizeof(struct dir_entry));
-
-
-    unsigned char *buffer = calloc(1, real_block_size);
-    memcpy(buffer, &sup, sizeof(struct superblock));
-    fwrite(buffer, real_block_size , 1, fp);
-
-    memset(buffer, 0, real_block_size);
-
-   // --- INICIALIZAR BITMAP ---
-    printf("Inicializando Bitmap (%u blocos)...\n", sup.bitmap_size);
-
-    unsigned long bitmap_offset_bytes = (unsigned long)sup.bitmap_start * real_block_size;
-    unsigned long total_bitmap_bytes_on_disk = (unsigned long)sup.bitmap_size * real_block_size;
-    
-    // Zerar a área do Bitmap
-    fseek(fp, bitmap_offset_bytes, SEEK_SET);
-    unsigned long bytes_written = 0;
-
-    // Escreve de 1 em 1 bloco
-    while (bytes_written < total_bitmap_bytes_on_disk) {
-        memset(buffer, 0, real_block_size); 
-        fwrite(buffer, 1, real_block_size, fp);
-        
-        bytes_written += real_block_size;
-    }
-
-    // Marcar Metadados (Superbloco + Bitmap + Raiz)
-    // Lê o primeiro bloco do bitmap de volta
-    fseek(fp, bitmap_offset_bytes, SEEK_SET);
-    fread(buffer, 1, real_block_size, fp);
-
-    for (unsigned int i = 0; i < sup.data_start; i++) {
-        set_bit(buffer, i);
-    }
-
-    // Grava de volta o primeiro bloco do bitmap atualizado
-    fseek(fp, bitmap_offset_bytes, SEEK_SET);
-    fwrite(buffer, 1, real_block_size, fp);
-    memset(buffer, 0, real_block_size);
-    // --- DIRETORIO RAIZ ---
-    // Preencher com zeros
-    for (unsigned int i = 0; i < sup.root_size; i++) {
-        fwrite(buffer, real_block_size, 1, fp);
-    }
-    
-    // Gravar pastas . e .. no diretorio raiz
-    struct dir_entry dot, dotdot;
-    memset(&dot, 0, sizeof(dot));
-    dot.status = STATUS_VALID;
-    strcpy(dot.file_name, ".");
-    dot.file_type = TYPE_DIR;
-    dot.start_block = sup.root_start;
-    dot.size = ENTRY_SIZE * 2;
-    dot.length = sup.root_size;
-
-    dotdot = dot;
-    strcpy(dotdot.file_name, "..");
-
-    fseek(fp, sup.root_start * real_block_size, SEEK_SET);
-    fwrite(&dot, ENTRY_SIZE, 1, fp);
-    fwrite(&dotdot, ENTRY_SIZE, 1, fp);
-
-    // Preencher Dados com zeros
-    unsigned int data_blocks = sup.total_blocks - sup.data_start;
-    fseek(fp, sup.data_start * real_block_size, SEEK_SET);
-    for(unsigned int i=0; i < data_blocks; i++){
-        fwrite(buffer, 1, real_block_size, fp);
-        printf("Write datablocks\n");
-    }
-
-    memset(buffer, 0, real_block_size);
-    
-    printf("Disco formatado com sucesso! (Root Start: %d | Data Start: %d)\n\n", sup.root_start, sup.data_start);
-
-    fclose(fp);
-    free(buffer);
-    printf("Arquivo %s criado com sucesso!\n", filename);
-}
-
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include "sacs.h"
+#include "trace.h"
+#include "aio.h"
+#include "dio.h"
+#include "stripe.h"
+#include "prefetch.h"
+
+
+// --- FUNÇÕES AUXILIARES DE BITS ---
+
+void set_bit(unsigned char *bitmap_buffer, uint64_t block_index) {
+    bitmap_buffer[block_index / 8] |= (1 << (block_index % 8));
+}
+
+int get_bit(const unsigned char *bitmap, uint64_t index) {
+    return (bitmap[index / 8] >> (index % 8)) & 1;
+}
+
+void unset_bit(unsigned char *bitmap_buffer, uint64_t block_index) {
+    uint64_t byte_offset = block_index / 8;
+    unsigned bit_offset  = block_index % 8;
+    bitmap_buffer[byte_offset] &= ~(1 << bit_offset);
+}
+
+
+// --- FORMATOS EM DISCO (v1 E v2) ---
+// Em memória superbloco e entradas usam sempre 64 bits (layout v2).
+// Volumes v1 são convertidos na leitura e na escrita.
+
+// Tamanho das entradas do volume montado: vem da versão do superbloco em mount_sacs.
+// Formatar outra imagem não mexe nele
+static unsigned mount_entry_size = ENTRY_SIZE_V1;
+
+unsigned entry_size_for(unsigned sysid) {
+    return (sysid == SACS_V2) ? ENTRY_SIZE_V2 : ENTRY_SIZE_V1;
+}
+
+unsigned sacs_entry_size(void) {
+    return mount_entry_size;
+}
+
+// v1 não representa valores acima de 4 GB: satura em vez de dar a volta
+static uint32_t narrow32(uint64_t v) {
+    return (v > UINT32_MAX) ? UINT32_MAX : (uint32_t)v;
+}
+
+void entry_from_v1(const struct dir_entry_v1 *raw, struct dir_entry *entry) {
+    memset(entry, 0, sizeof(*entry));
+    entry->status = raw->status;
+    memcpy(entry->file_name, raw->file_name, sizeof(raw->file_name));
+    entry->file_type = raw->file_type;
+    entry->start_block = raw->start_block;
+    entry->size = raw->size;
+    entry->length = raw->length;
+}
+
+static void entry_to_v1(const struct dir_entry *entry, struct dir_entry_v1 *raw) {
+    raw->status = entry->status;
+    memcpy(raw->file_name, entry->file_name, sizeof(raw->file_name));
+    raw->file_type = entry->file_type;
+    raw->start_block = narrow32(entry->start_block);
+    raw->size = narrow32(entry->size);
+    raw->length = narrow32(entry->length);
+}
+
+// Lê uma entrada na posição corrente, no formato do volume. Retorna 1 se leu
+int read_entry(FILE *fp, struct dir_entry *entry) {
+    if (mount_entry_size == ENTRY_SIZE_V2) return fread(entry, sizeof(*entry), 1, fp) == 1;
+
+    struct dir_entry_v1 raw;
+    if (fread(&raw, sizeof(raw), 1, fp) != 1) return 0;
+    entry_from_v1(&raw, entry);
+    return 1;
+}
+
+// Grava uma entrada com entradas de 'entry_bytes' bytes (o formatador não monta o volume)
+static void write_entry_as(FILE *fp, const struct dir_entry *entry, unsigned entry_bytes) {
+    if (entry_bytes == ENTRY_SIZE_V2) {
+        fwrite(entry, sizeof(*entry), 1, fp);
+        return;
+    }
+    struct dir_entry_v1 raw;
+    entry_to_v1(entry, &raw);
+    fwrite(&raw, sizeof(raw), 1, fp);
+}
+
+void write_entry(FILE *fp, const struct dir_entry *entry) {
+    write_entry_as(fp, entry, mount_entry_size);
+}
+
+// Converte o superbloco para o formato em disco. Retorna o tamanho gravado em 'out'
+static size_t encode_superblock(const struct superblock *sup, void *out) {
+    if (sup->sysid == SACS_V2) {
+        memcpy(out, sup, sizeof(*sup));
+        return sizeof(*sup);
+    }
+    struct superblock_v1 raw;
+    memset(&raw, 0, sizeof(raw));
+    raw.sysid = sup->sysid;
+    raw.sector_size = sup->sector_size;
+    raw.block_size = sup->block_size;
+    raw.total_blocks = narrow32(sup->total_blocks);
+    raw.bitmap_start = narrow32(sup->bitmap_start);
+    raw.bitmap_size = narrow32(sup->bitmap_size);
+    raw.root_start = narrow32(sup->root_start);
+    raw.root_size = narrow32(sup->root_size);
+    raw.data_start = narrow32(sup->data_start);
+    raw.pack_block = narrow32(sup->pack_block);
+    raw.alloc_cursor = narrow32(sup->alloc_cursor);
+    raw.summary_start = narrow32(sup->summary_start);
+    raw.summary_size = narrow32(sup->summary_size);
+    raw.refcount_start = narrow32(sup->refcount_start);
+    raw.refcount_size = narrow32(sup->refcount_size);
+    raw.snap_table = narrow32(sup->snap_table);
+    memcpy(out, &raw, sizeof(raw));
+    return sizeof(raw);
+}
+
+// Lê o superbloco do bloco 0. Retorna a versão do formato (1 ou 2) ou 0 se não for SACS
+int read_superblock(FILE *fp, struct superblock *sup) {
+    unsigned char raw[sizeof(struct superblock)];
+    uint32_t sysid;
+
+    fseek(fp, 0, SEEK_SET);
+    if (fread(raw, 1, sizeof(raw), fp) != sizeof(raw)) return 0;
+    memcpy(&sysid, raw, sizeof(sysid));
+
+    if (sysid == SACS_V2) {
+        memcpy(sup, raw, sizeof(*sup));
+        return 2;
+    }
+    if (sysid != SACS) return 0;
+
+    struct superblock_v1 v1;
+    memcpy(&v1, raw, sizeof(v1));
+    memset(sup, 0, sizeof(*sup));
+    sup->sysid = v1.sysid;
+    sup->sector_size = v1.sector_size;
+    sup->block_size = v1.block_size;
+    sup->total_blocks = v1.total_blocks;
+    sup->bitmap_start = v1.bitmap_start;
+    sup->bitmap_size = v1.bitmap_size;
+    sup->root_start = v1.root_start;
+    sup->root_size = v1.root_size;
+    sup->data_start = v1.data_start;
+    sup->pack_block = v1.pack_block;
+    sup->alloc_cursor = v1.alloc_cursor;
+    sup->summary_start = v1.summary_start;
+    sup->summary_size = v1.summary_size;
+    sup->refcount_start = v1.refcount_start;
+    sup->refcount_size = v1.refcount_size;
+    sup->snap_table = v1.snap_table;
+    return 1;
+}
+
+// Maior arquivo representável no formato do volume
+uint64_t max_file_size(const struct superblock *sup) {
+    return (sup->sysid == SACS_V2) ? (uint64_t)INT64_MAX : UINT32_MAX;
+}
+
+
+// --- GEOMETRIA ---
+// Tamanho de bloco, de entrada e de bloco de bitmap são potências de 2: a geometria é
+// calculada uma vez na montagem e os laços usam deslocamentos e máscaras. As varreduras
+// de diretório têm versões compiladas para blocos de 512 B, 1 KB, 2 KB e 4 KB.
+
+struct sacs_geometry sacs_geom;
+static struct sacs_geometry geom_other;   // Geometria pedida fora do volume montado
+
+static unsigned log2u(unsigned v) {
+    unsigned shift = 0;
+    while ((1u << shift) < v) shift++;
+    return shift;
+}
+
+void geometry_init(struct sacs_geometry *g, unsigned block_bytes, unsigned entry_bytes) {
+    g->block_bytes = block_bytes;
+    g->block_shift = log2u(block_bytes);
+    g->block_mask = block_bytes - 1;
+    g->entry_bytes = entry_bytes;
+    g->entry_shift = log2u(entry_bytes);
+    g->entries_per_block = block_bytes >> g->entry_shift;
+    g->entries_shift = g->block_shift - g->entry_shift;
+    g->bits_shift = g->block_shift + 3;
+    g->bits_mask = (block_bytes << 3) - 1;
+}
+
+// Geometria para um tamanho de bloco (a do volume montado quase sempre)
+static const struct sacs_geometry *geom_for(unsigned block_bytes) {
+    if (block_bytes == sacs_geom.block_bytes && mount_entry_size == sacs_geom.entry_bytes) return &sacs_geom;
+    if (block_bytes != geom_other.block_bytes || mount_entry_size != geom_other.entry_bytes) {
+        geometry_init(&geom_other, block_bytes, mount_entry_size);
+    }
+    return &geom_other;
+}
+
+#define SCAN_NAME 0    // Entrada válida com o nome dado
+#define SCAN_FREE 1    // Primeira entrada livre
+#define SCAN_CHILD 2   // Entrada válida que aponta para o bloco dado
+
+// Bloco inicial de uma entrada crua (mesmo deslocamento nos dois formatos)
+static inline uint64_t raw_start_block(const unsigned char *raw, unsigned entry_bytes) {
+    if (entry_bytes == ENTRY_SIZE_V2) {
+        uint64_t v;
+        memcpy(&v, raw + 20, sizeof(v));
+        return v;
+    }
+    uint32_t v;
+    memcpy(&v, raw + 20, sizeof(v));
+    return v;
+}
+
+static inline void raw_decode(const unsigned char *raw, unsigned entry_bytes, struct dir_entry *out) {
+    if (entry_bytes == ENTRY_SIZE_V2) {
+        memcpy(out, raw, sizeof(*out));
+        return;
+    }
+    struct dir_entry_v1 v1;
+    memcpy(&v1, raw, sizeof(v1));
+    entry_from_v1(&v1, out);
+}
+
+// Entradas livres vistas durante uma varredura
+struct scan_slots {
+    long first_free;          // Primeira entrada livre (-1 = nenhuma)
+};
+
+// Corpo das varreduras: lê um bloco de diretório inteiro por vez e procura na memória
+// as entradas [first, end). Com block_bytes e entry_bytes constantes o compilador fixa
+// os limites dos laços
+static inline __attribute__((always_inline))
+long dir_scan_body(FILE *fp, unsigned char *buf, unsigned block_bytes, unsigned entry_bytes,
+                   uint64_t start_block, uint64_t first, uint64_t end, int mode, const char *name,
+                   uint64_t target, struct dir_entry *out, struct scan_slots *slots) {
+    unsigned per_block = block_bytes / entry_bytes;
+    uint64_t b = first / per_block;
+    unsigned i = first % per_block;
+
+    fseeko(fp, (off_t)(start_block + b) * block_bytes, SEEK_SET);
+    for (; b * per_block < end; b++, i = 0) {
+        if (fread(buf, 1, block_bytes, fp) != block_bytes) return -1;
+        unsigned stop = (end - b * per_block < per_block) ? (unsigned)(end - b * per_block) : per_block;
+
+        for (; i < stop; i++) {
+            const unsigned char *raw = buf + i * entry_bytes;
+            long slot = (long)(b * per_block + i);
+            if (slots && raw[0] == STATUS_FREE && slots->first_free < 0) slots->first_free = slot;
+            if (mode == SCAN_FREE) {
+                if (raw[0] != STATUS_FREE) continue;
+            } else if (raw[0] != STATUS_VALID) {
+                continue;
+            } else if (mode == SCAN_NAME) {
+                if (raw[1] != (unsigned char)name[0] || strncmp((const char *)raw + 1, name, 16) != 0) continue;
+            } else if (raw_start_block(raw, entry_bytes) != target) {
+                continue;
+            }
+            if (out) raw_decode(raw, entry_bytes, out);
+            return slot;
+        }
+    }
+    return -1;
+}
+
+#define DIR_SCAN_INSTANCE(BYTES) \
+    static long dir_scan_##BYTES##_v1(FILE *fp, unsigned char *buf, uint64_t start_block, uint64_t first, \
+                                      uint64_t end, int mode, const char *name, uint64_t target, \
+                                      struct dir_entry *out, struct scan_slots *slots) { \
+        return dir_scan_body(fp, buf, BYTES, ENTRY_SIZE_V1, start_block, first, end, mode, name, target, \
+                             out, slots); \
+    } \
+    static long dir_scan_##BYTES##_v2(FILE *fp, unsigned char *buf, uint64_t start_block, uint64_t first, \
+                                      uint64_t end, int mode, const char *name, uint64_t target, \
+                                      struct dir_entry *out, struct scan_slots *slots) { \
+        return dir_scan_body(fp, buf, BYTES, ENTRY_SIZE_V2, start_block, first, end, mode, name, target, \
+                             out, slots); \
+    }
+
+DIR_SCAN_INSTANCE(512)
+DIR_SCAN_INSTANCE(1024)
+DIR_SCAN_INSTANCE(2048)
+DIR_SCAN_INSTANCE(4096)
+
+// Procura nas entradas [first, end) do diretório em start_block. Retorna o índice da
+// entrada ou -1. Preserva a posição do arquivo
+static long dir_scan_range(FILE *fp, uint64_t start_block, uint64_t first, uint64_t end, unsigned block_size,
+                           int mode, const char *name, uint64_t target, struct dir_entry *out,
+                           struct scan_slots *slots) {
+    if (first >= end) return -1;
+
+    const struct sacs_geometry *g = geom_for(block_size);
+    unsigned char stack_buf[4096];
+    unsigned char *buf = (g->block_bytes <= sizeof(stack_buf)) ? stack_buf : malloc(g->block_bytes);
+    if (!buf) return -1;
+
+    long old_pos = ftell(fp);
+    int v2 = (g->entry_bytes == ENTRY_SIZE_V2);
+    long slot;
+
+#define DIR_SCAN_CALL(fn) fn(fp, buf, start_block, first, end, mode, name, target, out, slots)
+    switch (g->block_bytes) {
+        case 512:  slot = v2 ? DIR_SCAN_CALL(dir_scan_512_v2)  : DIR_SCAN_CALL(dir_scan_512_v1);  break;
+        case 1024: slot = v2 ? DIR_SCAN_CALL(dir_scan_1024_v2) : DIR_SCAN_CALL(dir_scan_1024_v1); break;
+        case 2048: slot = v2 ? DIR_SCAN_CALL(dir_scan_2048_v2) : DIR_SCAN_CALL(dir_scan_2048_v1); break;
+        case 4096: slot = v2 ? DIR_SCAN_CALL(dir_scan_4096_v2) : DIR_SCAN_CALL(dir_scan_4096_v1); break;
+        default:
+            slot = dir_scan_body(fp, buf, g->block_bytes, g->entry_bytes, start_block, first, end,
+                                 mode, name, target, out, slots);
+            break;
+    }
+#undef DIR_SCAN_CALL
+
+    if (buf != stack_buf) free(buf);
+    fseek(fp, old_pos, SEEK_SET);
+    return slot;
+}
+
+
+// --- ENTRADAS LIVRES POR DIRETÓRIO ---
+// Cache em memória, por bloco inicial do diretório, com a primeira entrada que pode estar
+// livre. É só o ponto de partida da busca por uma entrada livre: a entrada escolhida é
+// sempre lida do disco e conferida, e buscas por nome ou por filho varrem o diretório
+// inteiro. Uma entrada liberada sem aviso só deixa de ser reaproveitada até a próxima
+// passada completa. Diretórios novos e cópias na escrita recebem dica própria; a montagem
+// invalida tudo.
+
+#define SLOT_HINTS 64
+
+struct slot_hint {
+    uint64_t dir_block;
+    uint64_t first_free;
+    uint64_t epoch;           // Vale só se igual a slot_epoch
+};
+
+static struct slot_hint slot_hints[SLOT_HINTS];
+static uint64_t slot_epoch = 1;
+
+static void slot_hints_reset(void) {
+    slot_epoch++;
+}
+
+static struct slot_hint *slot_hint_get(uint64_t dir_block) {
+    struct slot_hint *h = &slot_hints[dir_block % SLOT_HINTS];
+    return (h->epoch == slot_epoch && h->dir_block == dir_block) ? h : NULL;
+}
+
+static void slot_hint_set(uint64_t dir_block, uint64_t first_free) {
+    struct slot_hint *h = &slot_hints[dir_block % SLOT_HINTS];
+    h->dir_block = dir_block;
+    h->first_free = first_free;
+    h->epoch = slot_epoch;
+}
+
+// Entrada 'slot' passou a ser válida
+static void slot_hint_used(uint64_t dir_block, uint64_t slot) {
+    struct slot_hint *h = slot_hint_get(dir_block);
+    if (h && slot == h->first_free) h->first_free = slot + 1;
+}
+
+// Entrada 'slot' foi liberada
+static void slot_hint_freed(uint64_t dir_block, uint64_t slot) {
+    struct slot_hint *h = slot_hint_get(dir_block);
+    if (h && slot < h->first_free) h->first_free = slot;
+}
+
+// Busca em todo o diretório
+static long dir_scan(FILE *fp, uint64_t start_block, uint64_t length, unsigned block_size, int mode,
+                     const char *name, uint64_t target, struct dir_entry *out) {
+    uint64_t end = length << geom_for(block_size)->entries_shift;
+    return dir_scan_range(fp, start_block, 0, end, block_size, mode, name, target, out, NULL);
+}
+
+// Posição em bytes da entrada 'slot' de um diretório
+static inline unsigned long dir_slot_pos(const struct sacs_geometry *g, uint64_t dir_block, long slot) {
+    return ((unsigned long)dir_block << g->block_shift) + ((unsigned long)slot << g->entry_shift);
+}
+
+
+// --- ESTADO DE MONTAGEM E POLÍTICAS DE ALOCAÇÃO ---
+
+static struct superblock *mounted_sup = NULL;   // Superbloco do volume montado
+static int alloc_policy = ALLOC_BEST_FIT;
+static int read_only = 0;                        // Snapshot montado: nada pode ser alterado
+
+// Retorna 1 se o volume montado aceita modificações
+static int check_writable(void) {
+    if (read_only) printf("Erro: Volume montado somente leitura (snapshot).\n");
+    return !read_only;
+}
+
+// --- RESUMO DE ESPAÇO LIVRE POR BLOCO DE BITMAP ---
+// Para cada bloco de bitmap: livres, maior trecho livre e trechos livres no início/fim.
+// Fica em cache na montagem; o alocador pula blocos de bitmap que não podem atender o pedido.
+
+static struct bitmap_summary *summary_cache = NULL;
+static unsigned long summary_count = 0;
+
+// Calcula o resumo dos primeiros 'bits' bits de um bloco de bitmap.
+// Palavras e bytes inteiros livres/ocupados são tratados de uma vez; o resto bit a bit.
+void summarize_chunk(const unsigned char *chunk, unsigned bits, struct bitmap_summary *out) {
+    unsigned run = 0, i = 0;
+    int head_done = 0;
+    memset(out, 0, sizeof(*out));
+
+    while (i < bits) {
+        // Palavra de 64 bits inteira livre ou ocupada
+        if (i % 64 == 0 && i + 64 <= bits) {
+            uint64_t word;
+            memcpy(&word, chunk + i / 8, sizeof(word));
+            if (word == 0 || word == UINT64_MAX) {
+                if (word == 0) {
+                    out->free += 64;
+                    run += 64;
+                    if (run > out->longest) out->longest = run;
+                } else {
+                    if (!head_done) { out->head = run; head_done = 1; }
+                    run = 0;
+                }
+                i += 64;
+                continue;
+            }
+        }
+        if (i % 8 == 0 && i + 8 <= bits && (chunk[i / 8] == 0x00 || chunk[i / 8] == 0xFF)) {
+            if (chunk[i / 8] == 0x00) {
+                out->free += 8;
+                run += 8;
+                if (run > out->longest) out->longest = run;
+            } else {
+                if (!head_done) { out->head = run; head_done = 1; }
+                run = 0;
+            }
+            i += 8;
+            continue;
+        }
+        if (!((chunk[i / 8] >> (i % 8)) & 1)) {
+            out->free++;
+            run++;
+            if (run > out->longest) out->longest = run;
+        } else {
+            if (!head_done) { out->head = run; head_done = 1; }
+            run = 0;
+        }
+        i++;
+    }
+    if (!head_done) out->head = run;
+    out->tail = run;
+}
+
+static void summary_load(FILE *fp, struct superblock *sup) {
+    free(summary_cache);
+    summary_cache = NULL;
+    summary_count = 0;
+    if (sup->summary_start == 0) return;
+
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    unsigned long bits_per_chunk = (unsigned long)real_block_size * 8;
+    unsigned long count = (sup->total_blocks + bits_per_chunk - 1) / bits_per_chunk;
+
+    summary_cache = malloc(count * sizeof(struct bitmap_summary));
+    if (!summary_cache) return;
+
+    fseek(fp, (unsigned long)sup->summary_start * real_block_size, SEEK_SET);
+    if (fread(summary_cache, sizeof(struct bitmap_summary), count, fp) != count) {
+        free(summary_cache);
+        summary_cache = NULL;
+        return;
+    }
+    summary_count = count;
+}
+
+// Resumo do bloco de bitmap c, ou NULL se o volume não tem a região de resumo
+static struct bitmap_summary *summary_for(unsigned long c, unsigned bitmap_start) {
+    if (!summary_cache || !mounted_sup || bitmap_start != mounted_sup->bitmap_start) return NULL;
+    if (c >= summary_count) return NULL;
+    return &summary_cache[c];
+}
+
+// Recalcula e grava o resumo de um bloco de bitmap recém-modificado
+static void summary_update(FILE *fp, unsigned long c, const unsigned char *chunk,
+                           unsigned bitmap_start, unsigned real_block_size) {
+    struct bitmap_summary *sum = summary_for(c, bitmap_start);
+    if (!sum) return;
+
+    unsigned long bits_per_chunk = (unsigned long)real_block_size * 8;
+    unsigned long first = c * bits_per_chunk;
+    unsigned bits = (mounted_sup->total_blocks - first < bits_per_chunk)
+                    ? (unsigned)(mounted_sup->total_blocks - first) : (unsigned)bits_per_chunk;
+
+    summarize_chunk(chunk, bits, sum);
+    fseek(fp, (unsigned long)mounted_sup->summary_start * real_block_size + c * sizeof(struct bitmap_summary), SEEK_SET);
+    fwrite(sum, sizeof(struct bitmap_summary), 1, fp);
+}
+
+// Listas livres segregadas por classe de tamanho (classe = floor(log2(len))). Cada classe
+// é uma lista duplamente encadeada de nós; duas tabelas de espalhamento, por início e por
+// fim do extent, acham o nó de um endereço sem percorrer as listas.
+struct free_extent {
+    unsigned start;
+    unsigned len;
+    int prev, next;               // Lista da classe (next também encadeia os nós livres)
+    int by_start, by_end;         // Encadeamento nas tabelas de endereço
+};
+
+static struct free_extent *seg_nodes = NULL;
+static unsigned seg_used = 0, seg_cap = 0;   // Nós já usados do vetor / capacidade
+static int seg_spare = -1;                   // Nós devolvidos, para reuso
+static int seg_heads[SEG_CLASSES];
+static int *seg_start_tab = NULL, *seg_end_tab = NULL;
+static unsigned seg_tab_size = 0;            // Potência de 2
+static unsigned seg_live = 0;
+static int seg_ready = 0;
+
+// Grava o superbloco (campos mutáveis como pack_block e alloc_cursor)
+static void write_superblock(FILE *fp, struct superblock *sup) {
+    unsigned char raw[sizeof(struct superblock)];
+    size_t len = encode_superblock(sup, raw);
+    long old_pos = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    fwrite(raw, len, 1, fp);
+    fseek(fp, old_pos, SEEK_SET);
+}
+
+static unsigned size_class(unsigned len) {
+    unsigned c = (len > 1) ? 31 - __builtin_clz(len) : 0;
+    return (c < SEG_CLASSES) ? c : SEG_CLASSES - 1;
+}
+
+static void seg_reset(void) {
+    free(seg_nodes);
+    free(seg_start_tab);
+    free(seg_end_tab);
+    seg_nodes = NULL;
+    seg_start_tab = seg_end_tab = NULL;
+    seg_used = seg_cap = seg_tab_size = seg_live = 0;
+    seg_spare = -1;
+    for (int c = 0; c < SEG_CLASSES; c++) seg_heads[c] = -1;
+    seg_ready = 0;
+}
+
+static unsigned seg_hash(unsigned block) {
+    return (block * 2654435761u) & (seg_tab_size - 1);
+}
+
+static void seg_link_addr(int n) {
+    struct free_extent *e = &seg_nodes[n];
+    unsigned hs = seg_hash(e->start), he = seg_hash(e->start + e->len);
+    e->by_start = seg_start_tab[hs];
+    seg_start_tab[hs] = n;
+    e->by_end = seg_end_tab[he];
+    seg_end_tab[he] = n;
+}
+
+static void seg_unlink_addr(int n) {
+    struct free_extent *e = &seg_nodes[n];
+    int *p = &seg_start_tab[seg_hash(e->start)];
+    while (*p != n) p = &seg_nodes[*p].by_start;
+    *p = e->by_start;
+    p = &seg_end_tab[seg_hash(e->start + e->len)];
+    while (*p != n) p = &seg_nodes[*p].by_end;
+    *p = e->by_end;
+}
+
+// Dobra as tabelas de endereço quando passam de um nó por posição
+static int seg_grow_tables(void) {
+    unsigned size = seg_tab_size ? seg_tab_size * 2 : 256;
+    int *starts = malloc(size * sizeof(int));
+    int *ends = malloc(size * sizeof(int));
+    if (!starts || !ends) {
+        free(starts);
+        free(ends);
+        return 0;
+    }
+    free(seg_start_tab);
+    free(seg_end_tab);
+    seg_start_tab = starts;
+    seg_end_tab = ends;
+    seg_tab_size = size;
+    for (unsigned i = 0; i < size; i++) seg_start_tab[i] = seg_end_tab[i] = -1;
+
+    // Só os nós que estão em alguma lista
+    for (int c = 0; c < SEG_CLASSES; c++) {
+        for (int n = seg_heads[c]; n != -1; n = seg_nodes[n].next) seg_link_addr(n);
+    }
+    return 1;
+}
+
+// Nó na frente da lista da classe e nas tabelas de endereço
+static void seg_push(unsigned start, unsigned len) {
+    if (len == 0) return;
+    if (seg_live + 1 > seg_tab_size && !seg_grow_tables()) return;
+
+    int n = seg_spare;
+    if (n != -1) {
+        seg_spare = seg_nodes[n].next;
+    } else {
+        if (seg_used == seg_cap) {
+            unsigned new_cap = seg_cap ? seg_cap * 2 : 64;
+            struct free_extent *nodes = realloc(seg_nodes, new_cap * sizeof(struct free_extent));
+            if (!nodes) return;
+            seg_nodes = nodes;
+            seg_cap = new_cap;
+        }
+        n = (int)seg_used++;
+    }
+
+    struct free_extent *e = &seg_nodes[n];
+    unsigned c = size_class(len);
+    e->start = start;
+    e->len = len;
+    e->prev = -1;
+    e->next = seg_heads[c];
+    if (e->next != -1) seg_nodes[e->next].prev = n;
+    seg_heads[c] = n;
+    seg_link_addr(n);
+    seg_live++;
+}
+
+static void seg_remove(int n) {
+    struct free_extent *e = &seg_nodes[n];
+    seg_unlink_addr(n);
+    if (e->prev != -1) seg_nodes[e->prev].next = e->next;
+    else seg_heads[size_class(e->len)] = e->next;
+    if (e->next != -1) seg_nodes[e->next].prev = e->prev;
+    e->len = 0;                   // Nó fora das listas
+    e->next = seg_spare;
+    seg_spare = n;
+    seg_live--;
+}
+
+static int seg_at_start(unsigned start) {
+    if (!seg_tab_size) return -1;
+    for (int n = seg_start_tab[seg_hash(start)]; n != -1; n = seg_nodes[n].by_start) {
+        if (seg_nodes[n].start == start) return n;
+    }
+    return -1;
+}
+
+static int seg_at_end(unsigned end) {
+    if (!seg_tab_size) return -1;
+    for (int n = seg_end_tab[seg_hash(end)]; n != -1; n = seg_nodes[n].by_end) {
+        if (seg_nodes[n].start + seg_nodes[n].len == end) return n;
+    }
+    return -1;
+}
+
+// Retira [start, start + len) das listas (blocos que acabaram de ser marcados no bitmap).
+// Os extents das listas são trechos livres maximais e toda alocação começa no início de
+// um deles (seg_find ou crescimento no lugar), então o nó sai da tabela por início.
+static void seg_take(unsigned start, unsigned len) {
+    unsigned end = start + len;
+    int n = seg_at_start(start);
+    if (n == -1) {
+        // Defensivo: intervalo no meio de um trecho, procura o nó que o contém
+        for (unsigned i = 0; i < seg_used && n == -1; i++) {
+            struct free_extent *e = &seg_nodes[i];
+            if (e->len && e->start < start && e->start + e->len > start) n = (int)i;
+        }
+        if (n == -1) return;
+    }
+
+    struct free_extent e = seg_nodes[n];
+    unsigned e_end = e.start + e.len;
+    seg_remove(n);
+    // Devolve as sobras das pontas
+    if (e.start < start) seg_push(e.start, start - e.start);
+    if (e_end > end) seg_push(end, e_end - end);
+}
+
+// Devolve [start, start + len) às listas, unindo com os vizinhos adjacentes
+static void seg_give(unsigned start, unsigned len) {
+    int before = seg_at_end(start);
+    if (before != -1) {
+        start = seg_nodes[before].start;
+        len += seg_nodes[before].len;
+        seg_remove(before);
+    }
+    int after = seg_at_start(start + len);
+    if (after != -1) {
+        len += seg_nodes[after].len;
+        seg_remove(after);
+    }
+    seg_push(start, len);
+}
+
+// Monta as listas varrendo o bitmap uma vez
+static void seg_build(FILE *fp, unsigned real_block_size, unsigned bitmap_start, unsigned total_blocks) {
+    seg_reset();
+
+    unsigned char *chunk = malloc(real_block_size);
+    if (!chunk) return;
+
+    unsigned long bitmap_start_offset = (unsigned long)bitmap_start * real_block_size;
+    unsigned bits_per_chunk = real_block_size * 8;
+    unsigned run_start = 0, run_len = 0;
+
+    for (unsigned base = 0; base < total_blocks; base += bits_per_chunk) {
+        // Bloco de bitmap totalmente ocupado: só fecha o trecho corrente
+        struct bitmap_summary *sum = summary_for(base / bits_per_chunk, bitmap_start);
+        if (sum && sum->free == 0) {
+            if (run_len) seg_push(run_start, run_len);
+            run_len = 0;
+            continue;
+        }
+
+        fseek(fp, bitmap_start_offset + base / 8, SEEK_SET);
+        memset(chunk, 0, real_block_size);
+        fread(chunk, 1, real_block_size, fp);
+
+        for (unsigned b = 0; b < bits_per_chunk && base + b < total_blocks; b++) {
+            if (!get_bit(chunk, b)) {
+                if (run_len == 0) run_start = base + b;
+                run_len++;
+            } else if (run_len) {
+                seg_push(run_start, run_len);
+                run_len = 0;
+            }
+        }
+    }
+    if (run_len) seg_push(run_start, run_len);
+
+    free(chunk);
+    seg_ready = 1;
+}
+
+// Primeiro extent com len >= needed. A classe de needed mistura tamanhos menores: só os
+// primeiros SEG_PROBE nós dela são olhados antes de partir um extent de classe maior,
+// que sai da cabeça da primeira lista não vazia. A classe inteira só é percorrida se
+// não houver nenhum extent maior.
+#define SEG_PROBE 8
+
+static long seg_find(unsigned needed) {
+    unsigned c = size_class(needed);
+    int n = seg_heads[c];
+    for (unsigned probe = 0; n != -1 && probe < SEG_PROBE; probe++, n = seg_nodes[n].next) {
+        if (seg_nodes[n].len >= needed) return seg_nodes[n].start;
+    }
+    for (unsigned k = c + 1; k < SEG_CLASSES; k++) {
+        if (seg_heads[k] != -1) return seg_nodes[seg_heads[k]].start;
+    }
+    for (; n != -1; n = seg_nodes[n].next) {
+        if (seg_nodes[n].len >= needed) return seg_nodes[n].start;
+    }
+    return -1;
+}
+
+// Blocos de empacotamento com unidades livres, além do corrente (estado do volume montado).
+// Entram quando pack_free devolve unidades ou quando o bloco corrente é trocado por um
+// novo; saem quando enchem, são liberados ou ficam congelados por um snapshot.
+struct pack_partial {
+    unsigned block;
+    unsigned free;                // Unidades livres (não necessariamente consecutivas)
+};
+
+static struct pack_partial *pack_partials = NULL;
+static unsigned pack_partial_count = 0, pack_partial_cap = 0;
+
+static void pack_partials_reset(void) {
+    free(pack_partials);
+    pack_partials = NULL;
+    pack_partial_count = pack_partial_cap = 0;
+}
+
+// Diretórios que a cópia na escrita mudou de lugar nesta montagem (bloco antigo -> novo).
+// Corrige as dir_entry guardadas pelos chamadores (diretório corrente, handles) e leva ao
+// pai atual de um diretório cujo ".." ainda aponta para a versão que ficou com o snapshot.
+// Endereçamento aberto; o bloco 0 (superbloco) marca posição vazia.
+struct dir_move {
+    uint64_t from, to;
+};
+
+static struct dir_move *dir_moves = NULL;
+static unsigned dir_move_count = 0, dir_move_cap = 0;   // Capacidade em potência de 2
+
+static void dir_moves_reset(void) {
+    free(dir_moves);
+    dir_moves = NULL;
+    dir_move_count = dir_move_cap = 0;
+}
+
+static struct dir_move *dir_move_slot(uint64_t from) {
+    unsigned i = (unsigned)(from * 2654435761u) & (dir_move_cap - 1);
+    while (dir_moves[i].from != 0 && dir_moves[i].from != from) i = (i + 1) & (dir_move_cap - 1);
+    return &dir_moves[i];
+}
+
+static int dir_move_add(uint64_t from, uint64_t to) {
+    if ((dir_move_count + 1) * 2 > dir_move_cap) {
+        unsigned cap = dir_move_cap ? dir_move_cap * 2 : 64;
+        struct dir_move *old = dir_moves;
+        unsigned old_cap = dir_move_cap;
+        dir_moves = calloc(cap, sizeof(struct dir_move));
+        if (!dir_moves) {
+            dir_moves = old;
+            return 0;
+        }
+        dir_move_cap = cap;
+        for (unsigned i = 0; i < old_cap; i++) {
+            if (old[i].from != 0) *dir_move_slot(old[i].from) = old[i];
+        }
+        free(old);
+    }
+    struct dir_move *m = dir_move_slot(from);
+    if (m->from == 0) dir_move_count++;
+    m->from = from;
+    m->to = to;
+    return 1;
+}
+
+// Bloco atual do diretório que estava em 'block' (o próprio, se nunca foi copiado)
+static uint64_t dir_moved_to(uint64_t block) {
+    for (unsigned hops = 0; dir_move_count > 0 && hops < dir_move_count; hops++) {
+        struct dir_move *m = dir_move_slot(block);
+        if (m->from == 0) break;
+        block = m->to;
+    }
+    return block;
+}
+
+// Atualiza uma dir_entry de diretório guardada pelo chamador
+void dir_follow(struct dir_entry *dir) {
+    dir->start_block = dir_moved_to(dir->start_block);
+}
+
+// Monta o volume: lê o superbloco e escolhe a política de alocação
+int mount_sacs(FILE *fp, struct superblock *sup, int policy) {
+    int version = read_superblock(fp, sup);
+    if (version == 0) {
+        printf("Erro: Dispositivo nao contem um sistema SACS valido.\n");
+        return 0;
+    }
+    // O alocador indexa blocos com 32 bits
+    if (sup->total_blocks > UINT32_MAX) {
+        printf("Erro: Volume com %" PRIu64 " blocos excede o limite do alocador.\n", sup->total_blocks);
+        return 0;
+    }
+    mount_entry_size = entry_size_for(sup->sysid);
+    geometry_init(&sacs_geom, (1 << sup->sector_size) << sup->block_size, mount_entry_size);
+    slot_hints_reset();
+    pack_partials_reset();
+    dir_moves_reset();
+
+    mounted_sup = sup;
+    alloc_policy = policy;
+    read_only = 0;
+    seg_reset();
+    summary_load(fp, sup);
+    if (sup->alloc_cursor >= sup->total_blocks) sup->alloc_cursor = sup->data_start;
+    return 1;
+}
+
+int parse_alloc_policy(const char *name) {
+    if (!name) return ALLOC_BEST_FIT;
+    if (strcmp(name, "next") == 0) return ALLOC_NEXT_FIT;
+    if (strcmp(name, "segregated") == 0) return ALLOC_SEGREGATED;
+    if (strcmp(name, "locality") == 0) return ALLOC_LOCALITY;
+    return ALLOC_BEST_FIT;
+}
+
+const char *alloc_policy_name(int policy) {
+    switch (policy) {
+        case ALLOC_NEXT_FIT: return "next-fit";
+        case ALLOC_SEGREGATED: return "segregated";
+        case ALLOC_LOCALITY: return "locality";
+        default: return "best-fit";
+    }
+}
+
+// Preenche os bits [first, last] de um bloco de bitmap: máscaras nas pontas, memset no meio
+static void bits_fill(unsigned char *chunk, unsigned first, unsigned last, int value) {
+    unsigned first_byte = first >> 3, last_byte = last >> 3;
+    unsigned char head = (unsigned char)(0xFF << (first & 7));
+    unsigned char tail = (unsigned char)(0xFF >> (7 - (last & 7)));
+
+    if (first_byte == last_byte) head &= tail;
+    if (value) chunk[first_byte] |= head;
+    else chunk[first_byte] &= (unsigned char)~head;
+    if (first_byte == last_byte) return;
+
+    if (last_byte > first_byte + 1) memset(chunk + first_byte + 1, value ? 0xFF : 0x00, last_byte - first_byte - 1);
+    if (value) chunk[last_byte] |= tail;
+    else chunk[last_byte] &= (unsigned char)~tail;
+}
+
+// Marca (value = 1) ou libera (value = 0) um intervalo de bits, um bloco de bitmap por vez
+static void bitmap_set_range(FILE *fp, unsigned start_bit, unsigned count, int value,
+                             unsigned bitmap_start, unsigned real_block_size) {
+    if (count == 0) return;
+
+    const struct sacs_geometry *g = geom_for(real_block_size);
+    unsigned long bitmap_start_offset = (unsigned long)bitmap_start << g->block_shift;
+    unsigned int chunk_size_bytes = g->block_bytes;
+
+    unsigned char *chunk = (unsigned char *)malloc(chunk_size_bytes);
+    if (!chunk) {
+        printf("Erro de memória no bitmap.\n");
+        return;
+    }
+
+    unsigned int end_bit = start_bit + count - 1;
+    unsigned long start_chunk_idx = start_bit >> g->bits_shift;
+    unsigned long end_chunk_idx = end_bit >> g->bits_shift;
+
+    for (unsigned long c = start_chunk_idx; c <= end_chunk_idx; c++) {
+        unsigned long chunk_offset_disk = bitmap_start_offset + (c << g->block_shift);
+
+        // Carrega o chunk 
+        fseek(fp, chunk_offset_disk, SEEK_SET);
+        memset(chunk, 0, chunk_size_bytes);
+        fread(chunk, 1, chunk_size_bytes, fp);
+
+        // Interseção com os limites globais deste chunk
+        unsigned int chunk_start_global = c << g->bits_shift;
+        unsigned int chunk_end_global = chunk_start_global + g->bits_mask;
+        unsigned int mark_start = (start_bit > chunk_start_global) ? start_bit : chunk_start_global;
+        unsigned int mark_end = (end_bit < chunk_end_global) ? end_bit : chunk_end_global;
+
+        // Coordenadas Locais
+        bits_fill(chunk, mark_start & g->bits_mask, mark_end & g->bits_mask, value);
+
+        // Salva
+        fseek(fp, chunk_offset_disk, SEEK_SET);
+        fwrite(chunk, 1, chunk_size_bytes, fp);
+
+        summary_update(fp, c, chunk, bitmap_start, real_block_size);
+    }
+
+    free(chunk);
+
+    // Mantém as listas segregadas coerentes com o bitmap
+    if (seg_ready) {
+        if (value) seg_take(start_bit, count);
+        else seg_give(start_bit, count);
+    }
+}
+
+// Retorna 1 se todos os blocos do intervalo estão livres (e dentro do disco)
+static int bitmap_range_is_free(FILE *fp, unsigned start_bit, unsigned count, unsigned bitmap_start,
+                                unsigned real_block_size, unsigned total_blocks) {
+    if (count == 0) return 1;
+    if (start_bit + count > total_blocks || start_bit + count < start_bit) return 0;
+
+    const struct sacs_geometry *g = geom_for(real_block_size);
+    unsigned long bitmap_start_offset = (unsigned long)bitmap_start << g->block_shift;
+    unsigned end_bit = start_bit + count - 1;
+    unsigned char buf[4096];
+
+    // Lê os bytes do intervalo em blocos de até 4 KB e testa com máscaras
+    for (unsigned first_byte = start_bit >> 3; first_byte <= (end_bit >> 3); ) {
+        unsigned last_byte = end_bit >> 3;
+        unsigned n = (last_byte - first_byte + 1 < sizeof(buf)) ? last_byte - first_byte + 1 : sizeof(buf);
+
+        fseek(fp, bitmap_start_offset + first_byte, SEEK_SET);
+        if (fread(buf, 1, n, fp) != n) return 0;
+
+        for (unsigned i = 0; i < n; i++) {
+            unsigned byte_index = first_byte + i;
+            unsigned char mask = 0xFF;
+            if (byte_index == (start_bit >> 3)) mask &= (unsigned char)(0xFF << (start_bit & 7));
+            if (byte_index == last_byte) mask &= (unsigned char)(0xFF >> (7 - (end_bit & 7)));
+            if (buf[i] & mask) return 0;
+        }
+        first_byte += n;
+    }
+    return 1;
+}
+
+
+// ALOCAÇÃO 
+// Best-fit: menor intervalo livre que comporta o pedido (para cedo em encaixe exato)
+static long scan_best_fit(FILE *fp, unsigned blocks_needed, unsigned real_block_size,
+                          unsigned bitmap_start, unsigned total_blocks) {
+    unsigned long bitmap_start_offset = (unsigned long)bitmap_start * real_block_size;
+    unsigned long total_bitmap_bytes = (total_blocks + 7) / 8;
+
+
+    unsigned int chunk_size_bytes = real_block_size;
+    unsigned int bits_per_chunk = chunk_size_bytes * 8;
+    unsigned long chunks = (total_bitmap_bytes + chunk_size_bytes - 1) / chunk_size_bytes;
+    
+    unsigned char *chunk = (unsigned char *)malloc(chunk_size_bytes);
+    if (!chunk) { return -1; }
+
+    long best_start = -1;
+    unsigned int best_len = UINT_MAX; 
+    
+    long current_start = -1;
+    unsigned int current_len = 0;
+    
+    unsigned int global_bit_index = 0;
+    int search_complete = 0;
+
+    for (unsigned long c = 0; c < chunks && !search_complete; c++) {
+        unsigned chunk_first = c * bits_per_chunk;
+        unsigned bits_in_chunk = (total_blocks - chunk_first < bits_per_chunk)
+                                 ? total_blocks - chunk_first : bits_per_chunk;
+
+        // Com resumo: blocos de bitmap sem trecho interno útil são resolvidos sem leitura
+        struct bitmap_summary *sum = summary_for(c, bitmap_start);
+        if (sum && sum->free == bits_in_chunk) {
+            if (current_start == -1) current_start = chunk_first;
+            current_len += bits_in_chunk;
+            continue;
+        }
+        if (sum && sum->longest < blocks_needed) {
+            // Fecha o trecho corrente com o início livre deste bloco
+            unsigned run_len = current_len + sum->head;
+            long run_start = (current_start != -1) ? current_start : (long)chunk_first;
+            if (run_len >= blocks_needed && run_len < best_len) {
+                best_len = run_len;
+                best_start = run_start;
+                if (best_len == blocks_needed) { search_complete = 1; break; }
+            }
+            // O fim livre continua no próximo bloco
+            current_start = sum->tail ? (long)(chunk_first + bits_in_chunk - sum->tail) : -1;
+            current_len = sum->tail;
+            continue;
+        }
+
+        // Lê 1 bloco de bitmap (ou o resto)
+        size_t read_size = chunk_size_bytes;
+        if (total_bitmap_bytes - (unsigned long)c * chunk_size_bytes < read_size) {
+            read_size = total_bitmap_bytes - (unsigned long)c * chunk_size_bytes;
+        }
+        
+        fseek(fp, bitmap_start_offset + (unsigned long)c * chunk_size_bytes, SEEK_SET);
+        memset(chunk, 0, chunk_size_bytes); 
+        fread(chunk, 1, read_size, fp);
+
+        int bits_to_check = read_size * 8;
+        global_bit_index = chunk_first;
+        
+        for (int local_bit = 0; local_bit < bits_to_check; local_bit++) {
+            if (global_bit_index >= total_blocks) break;
+
+            if (!get_bit(chunk, local_bit)) { // Livre
+                if (current_start == -1) current_start = global_bit_index;
+                current_len++;
+            } else { // Ocupado
+                if (current_start != -1) {
+                    if (current_len >= blocks_needed) {
+                        if (current_len < best_len) {
+                            best_len = current_len;
+                            best_start = current_start;
+                            if (best_len == blocks_needed) {
+                                search_complete = 1;
+                                break;
+                            }
+                        }
+                    }
+                    current_start = -1;
+                    current_len = 0;
+                }
+            }
+            global_bit_index++;
+        }
+    }
+    
+    if (!search_complete && current_start != -1 && current_len >= blocks_needed) {
+        if (current_len < best_len) best_start = current_start;
+    }
+
+    free(chunk);
+    return best_start;
+}
+
+// First-fit circular a partir de 'from' (next-fit e localidade)
+static long scan_first_fit(FILE *fp, unsigned blocks_needed, unsigned real_block_size,
+                           unsigned bitmap_start, unsigned total_blocks, unsigned from) {
+    const struct sacs_geometry *g = geom_for(real_block_size);
+    unsigned long bitmap_start_offset = (unsigned long)bitmap_start << g->block_shift;
+    unsigned bits_per_chunk = g->bits_mask + 1;
+
+    unsigned char *chunk = malloc(real_block_size);
+    if (!chunk) return -1;
+    if (from >= total_blocks) from = 0;
+
+    long found = -1;
+    // Duas passadas: [from, total) e depois do 0 até passar 'from' o bastante para ver
+    // inteiro um trecho que começa antes do cursor e o atravessa
+    uint64_t wrap_end = (uint64_t)from + blocks_needed - 1;
+    if (wrap_end > total_blocks) wrap_end = total_blocks;
+    for (int pass = 0; pass < (from ? 2 : 1) && found == -1; pass++) {
+        unsigned lo = (pass == 0) ? from : 0;
+        unsigned hi = (pass == 0) ? total_blocks : (unsigned)wrap_end;
+        unsigned run_start = 0, run_len = 0;
+        long loaded = -1;
+
+        for (unsigned b = lo; b < hi; b++) {
+            long c = b >> g->bits_shift;
+
+            // No início de um bloco de bitmap inteiro, o resumo pode evitar a leitura
+            struct bitmap_summary *sum = ((b & g->bits_mask) == 0) ? summary_for(c, bitmap_start) : NULL;
+            unsigned bits_in_chunk = (total_blocks - b < bits_per_chunk) ? total_blocks - b : bits_per_chunk;
+            if (sum && b + bits_in_chunk <= hi) {
+                if (sum->free == bits_in_chunk) {
+                    if (run_len == 0) run_start = b;
+                    run_len += bits_in_chunk;
+                    if (run_len >= blocks_needed) { found = run_start; break; }
+                    b += bits_in_chunk - 1;
+                    continue;
+                }
+                if (sum->longest < blocks_needed) {
+                    if (run_len + sum->head >= blocks_needed) { found = run_start; break; }
+                    run_len = sum->tail;
+                    run_start = b + bits_in_chunk - sum->tail;
+                    b += bits_in_chunk - 1;
+                    continue;
+                }
+            }
+
+            if (c != loaded) {
+                fseek(fp, bitmap_start_offset + ((unsigned long)c << g->block_shift), SEEK_SET);
+                memset(chunk, 0, real_block_size);
+                fread(chunk, 1, real_block_size, fp);
+                loaded = c;
+            }
+            if (!get_bit(chunk, b & g->bits_mask)) {
+                if (run_len == 0) run_start = b;
+                if (++run_len == blocks_needed) { found = run_start; break; }
+            } else {
+                run_len = 0;
+            }
+        }
+    }
+
+    free(chunk);
+    return found;
+}
+
+long int contiguous_alloc(FILE *fp, uint64_t file_size, unsigned real_block_size, 
+                          unsigned bitmap_start, unsigned total_blocks) {
+    return contiguous_alloc_near(fp, file_size, real_block_size, bitmap_start, total_blocks, 0);
+}
+
+// Aloca segundo a política montada. 'hint' é o bloco do diretório pai (usado pela localidade)
+long int contiguous_alloc_near(FILE *fp, uint64_t file_size, unsigned real_block_size,
+                               unsigned bitmap_start, unsigned total_blocks, unsigned hint) {
+    long old_pos = ftell(fp);
+
+    uint64_t blocks_wanted = (file_size + real_block_size - 1) / real_block_size;
+    if (blocks_wanted > total_blocks) return -1;
+    unsigned blocks_needed = (blocks_wanted == 0) ? 1 : (unsigned)blocks_wanted;
+
+    // --- FASE 1: SCAN ---
+    long best_start;
+    switch (alloc_policy) {
+        case ALLOC_NEXT_FIT:
+            best_start = scan_first_fit(fp, blocks_needed, real_block_size, bitmap_start, total_blocks,
+                                        mounted_sup ? mounted_sup->alloc_cursor : 0);
+            break;
+        case ALLOC_LOCALITY:
+            best_start = (hint != 0)
+                ? scan_first_fit(fp, blocks_needed, real_block_size, bitmap_start, total_blocks, hint)
+                : scan_best_fit(fp, blocks_needed, real_block_size, bitmap_start, total_blocks);
+            break;
+        case ALLOC_SEGREGATED:
+            if (!seg_ready) seg_build(fp, real_block_size, bitmap_start, total_blocks);
+            best_start = seg_find(blocks_needed);
+            break;
+        default:
+            best_start = scan_best_fit(fp, blocks_needed, real_block_size, bitmap_start, total_blocks);
+    }
+
+    // --- FASE 2: COMMIT ---
+    if (best_start != -1) {
+        if (best_start == 0) {
+             printf("ERRO: Tentativa de alocar Superbloco.\n");
+             fseek(fp, old_pos, SEEK_SET); return -1;
+        }
+
+        bitmap_set_range(fp, best_start, blocks_needed, 1, bitmap_start, real_block_size);
+
+        // Cursor persistente do next-fit
+        if (alloc_policy == ALLOC_NEXT_FIT && mounted_sup) {
+            unsigned next = best_start + blocks_needed;
+            mounted_sup->alloc_cursor = (next >= total_blocks) ? mounted_sup->data_start : next;
+            write_superblock(fp, mounted_sup);
+        }
+    }
+
+    fseek(fp, old_pos, SEEK_SET);
+    return best_start;
+}
+
+//Atualiza quantidade de bytes nas pastas acima na hierarquia (igual windows)
+void update_hierarchy_size(FILE *fp, unsigned start_block, int64_t delta, unsigned block_size) {
+    const struct sacs_geometry *g = geom_for(block_size);
+    long old_pos = ftell(fp);
+    unsigned current_block = start_block;
+    
+    // Loop para subir a árvore até a raiz
+    while (1) {
+        unsigned long current_offset = (unsigned long)current_block << g->block_shift;
+        struct dir_entry dot, dotdot;
+
+        // Atualiza o . do diretório atual 
+        fseek(fp, current_offset, SEEK_SET);
+        read_entry(fp, &dot); // Lê entrada 0 (.)
+        
+        // Proteção contra valor negativo
+        if (delta < 0 && (uint64_t)-delta > dot.size) dot.size = 0;
+        else dot.size += delta;
+
+        fseek(fp, current_offset, SEEK_SET);
+        write_entry(fp, &dot); // Grava . atualizado
+
+        // Lê o PAI ..
+        fseek(fp, current_offset + ENTRY_SIZE, SEEK_SET); // Lê entrada 1 (..)
+        read_entry(fp, &dotdot);
+
+        // Se raiz . == ..
+        if (dotdot.start_block == current_block) {
+            // Atualiza o ".." da raiz também para ficar igual ao "."
+            dotdot.size = dot.size;
+            fseek(fp, current_offset + ENTRY_SIZE, SEEK_SET);
+            write_entry(fp, &dotdot);
+            break; 
+        }
+
+        // Atualiza a entrada que representa ESTE diretório no PAI 
+        unsigned parent_block = dotdot.start_block;
+        unsigned long parent_offset = (unsigned long)parent_block << g->block_shift;
+        
+        struct dir_entry temp;
+
+        // Precisamos varrer o pai para encontrar a entrada que tem 'current_block'
+        fseek(fp, parent_offset, SEEK_SET);
+        read_entry(fp, &temp); 
+        long slot = dir_scan(fp, parent_block, temp.length, block_size, SCAN_CHILD, NULL, current_block, &temp);
+
+        int found = 0;
+        if (slot >= 0) {
+            temp.size = dot.size; // Copia o tamanho acumulado do filho
+            fseek(fp, dir_slot_pos(g, parent_block, slot), SEEK_SET);
+            write_entry(fp, &temp);
+            found = 1;
+        }
+
+        if (!found) {
+            printf("DEBUG: Erro de consistência. Não achei o filho %u no pai %u.\n", current_block, parent_block);
+            break;
+        }
+
+        // Sobe um nível
+        current_block = parent_block;
+    }
+
+    fseek(fp, old_pos, SEEK_SET);
+}
+
+
+
+// DESALOCAR
+void contiguous_dealloc(FILE *fp, unsigned start_block, unsigned length_in_blocks, 
+                        unsigned bitmap_start, unsigned real_block_size,
+                        unsigned data_start) {
+    
+    // Segurança
+    if (start_block < data_start) {
+        printf("ERRO CRÍTICO: Tentativa de desalocar metadados (%u).\n", start_block);
+        return;
+    }
+    if (length_in_blocks == 0) return;
+
+    long old_pos = ftell(fp);
+
+    bitmap_set_range(fp, start_block, length_in_blocks, 0, bitmap_start, real_block_size);
+
+    fflush(fp);
+    fseek(fp, old_pos, SEEK_SET);
+}
+
+
+// --- CONTAGEM DE REFERÊNCIAS (SNAPSHOTS) ---
+// Um byte por bloco com as referências EXTRAS ao extent que começa nele (0 = dono único).
+// Valem para extents de arquivo, blocos de empacotamento e diretórios. Sem tabela de
+// snapshots nada está compartilhado.
+
+static unsigned refcount_get(FILE *fp, struct superblock *sup, uint64_t block) {
+    if (!sup->snap_table || !sup->refcount_start || block >= sup->total_blocks) return 0;
+
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    unsigned char rc = 0;
+    long old_pos = ftell(fp);
+    fseeko(fp, (off_t)sup->refcount_start * real_block_size + block, SEEK_SET);
+    fread(&rc, 1, 1, fp);
+    fseek(fp, old_pos, SEEK_SET);
+    return rc;
+}
+
+static void refcount_set(FILE *fp, struct superblock *sup, uint64_t block, unsigned value) {
+    if (!sup->refcount_start || block >= sup->total_blocks) return;
+
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    unsigned char rc = (unsigned char)value;
+    long old_pos = ftell(fp);
+    fseeko(fp, (off_t)sup->refcount_start * real_block_size + block, SEEK_SET);
+    fwrite(&rc, 1, 1, fp);
+    fseek(fp, old_pos, SEEK_SET);
+}
+
+static void refcount_inc(FILE *fp, struct superblock *sup, uint64_t block) {
+    unsigned rc = refcount_get(fp, sup, block);
+    if (rc < REFCOUNT_MAX) refcount_set(fp, sup, block, rc + 1);
+}
+
+// Solta uma referência extra. Retorna 1 se o extent ainda tem outro dono (não pode ser liberado)
+static int refcount_release(FILE *fp, struct superblock *sup, uint64_t block) {
+    unsigned rc = refcount_get(fp, sup, block);
+    if (rc == 0) return 0;
+    if (rc < REFCOUNT_MAX) refcount_set(fp, sup, block, rc - 1);
+    return 1;
+}
+
+
+// --- DIRETÓRIOS COMPARTILHADOS (CÓPIA NA ESCRITA) ---
+// O snapshot só dá uma referência extra à raiz: a árvore inteira fica compartilhada.
+// Antes da primeira escrita num diretório, a árvore atual copia os blocos dele e dos
+// ancestrais ainda compartilhados, de cima para baixo; cada filho de uma cópia ganha uma
+// referência. O snapshot fica com os blocos originais, que não mudam mais.
+// Com o pai exclusivo, um filho é compartilhado se e só se tem referência extra. Fora a
+// raiz, um diretório com referência extra tem o ".." na versão antiga do pai.
+
+#define DIR_DEPTH_MAX 128   // Profundidade máxima seguida pelos caminhos de ".."
+
+// Bloco apontado pelo ".." do diretório em 'block'
+static uint64_t dir_dotdot(FILE *fp, uint64_t block, const struct sacs_geometry *g) {
+    struct dir_entry dotdot;
+    long old_pos = ftell(fp);
+    fseek(fp, dir_slot_pos(g, block, 1), SEEK_SET);
+    int ok = read_entry(fp, &dotdot);
+    fseek(fp, old_pos, SEEK_SET);
+    return ok ? dotdot.start_block : block;
+}
+
+// Blocos do diretório em 'block', lidos do seu "."
+static uint64_t dir_length(FILE *fp, uint64_t block, const struct sacs_geometry *g) {
+    struct dir_entry dot;
+    long old_pos = ftell(fp);
+    fseek(fp, dir_slot_pos(g, block, 0), SEEK_SET);
+    int ok = read_entry(fp, &dot);
+    fseek(fp, old_pos, SEEK_SET);
+    return ok ? dot.length : 0;
+}
+
+// Volume remontado (sem registro das cópias): sobe pelos ".." antigos anotando o nome de
+// cada diretório e desce pelos mesmos nomes na árvore atual. Falha se algo foi renomeado
+static long dir_parent_by_names(FILE *fp, struct superblock *sup, uint64_t block, unsigned block_size) {
+    const struct sacs_geometry *g = geom_for(block_size);
+    char names[DIR_DEPTH_MAX][17];
+    unsigned depth = 0;
+    uint64_t child = block;
+    struct dir_entry entry;
+
+    while (1) {
+        uint64_t parent = dir_dotdot(fp, child, g);
+        if (parent == child) break;   // Uma raiz (a de algum snapshot)
+        if (depth == DIR_DEPTH_MAX ||
+            dir_scan(fp, parent, dir_length(fp, parent, g), block_size, SCAN_CHILD, NULL, child, &entry) < 0) return -1;
+        memcpy(names[depth++], entry.file_name, sizeof(entry.file_name));
+        child = parent;
+    }
+
+    // names[0] é o próprio 'block': o pai está um nível acima
+    uint64_t dir = sup->root_start, length = sup->root_size;
+    for (unsigned i = depth; i-- > 1; ) {
+        if (dir_scan(fp, dir, length, block_size, SCAN_NAME, names[i], 0, &entry) < 0 ||
+            entry.file_type != TYPE_DIR) return -1;
+        dir = entry.start_block;
+        length = entry.length;
+    }
+    return dir_scan(fp, dir, length, block_size, SCAN_CHILD, NULL, block, NULL) >= 0 ? (long)dir : -1;
+}
+
+// Último recurso: procura na árvore atual o diretório com uma entrada para 'block'
+static long dir_parent_search(FILE *fp, uint64_t dir, uint64_t length, uint64_t block,
+                              unsigned block_size, unsigned depth) {
+    if (dir_scan(fp, dir, length, block_size, SCAN_CHILD, NULL, block, NULL) >= 0) return (long)dir;
+    if (depth >= DIR_DEPTH_MAX) return -1;
+
+    const struct sacs_geometry *g = geom_for(block_size);
+    uint64_t max_entries = length << g->entries_shift;
+    struct dir_entry entry;
+    for (uint64_t i = 2; i < max_entries; i++) {
+        long old_pos = ftell(fp);
+        fseek(fp, dir_slot_pos(g, dir, (long)i), SEEK_SET);
+        int ok = read_entry(fp, &entry);
+        fseek(fp, old_pos, SEEK_SET);
+        if (!ok) break;
+        if (entry.status != STATUS_VALID || entry.file_type != TYPE_DIR) continue;
+        long found = dir_parent_search(fp, entry.start_block, entry.length, block, block_size, depth + 1);
+        if (found >= 0) return found;
+    }
+    return -1;
+}
+
+// Pai atual do diretório em 'block' (que não é a raiz), ou -1
+static long dir_live_parent(FILE *fp, struct superblock *sup, uint64_t block) {
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    const struct sacs_geometry *g = geom_for(real_block_size);
+    uint64_t parent = dir_dotdot(fp, block, g);
+    if (parent == block) return -1;   // Raiz de um snapshot
+    if (!refcount_get(fp, sup, block)) return (long)parent;
+
+    // O ".." é a versão do pai que ficou com o snapshot: a cópia feita nesta montagem
+    uint64_t moved = dir_moved_to(parent);
+    if (moved != parent &&
+        dir_scan(fp, moved, dir_length(fp, moved, g), real_block_size, SCAN_CHILD, NULL, block, NULL) >= 0) {
+        return (long)moved;
+    }
+
+    long found = dir_parent_by_names(fp, sup, block, real_block_size);
+    if (found < 0) found = dir_parent_search(fp, sup->root_start, sup->root_size, block, real_block_size, 0);
+    return found;
+}
+
+// Copia o diretório compartilhado 'old' para a árvore atual. O ".." da cópia vai para
+// 'parent' (na raiz, para ela mesma) e cada filho ganha a referência da cópia.
+// Retorna o bloco da cópia ou -1
+static long dir_copy(FILE *fp, struct superblock *sup, uint64_t old, uint64_t length, uint64_t parent) {
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    const struct sacs_geometry *g = geom_for(real_block_size);
+    long copy = contiguous_alloc_near(fp, length * real_block_size, real_block_size, sup->bitmap_start,
+                                      sup->total_blocks, parent ? parent : old);
+    if (copy == -1) return -1;
+
+    long old_pos = ftell(fp);
+    uint64_t max_entries = length << g->entries_shift;
+    struct dir_entry entry;
+    for (uint64_t i = 0; i < max_entries; i++) {
+        fseek(fp, dir_slot_pos(g, old, (long)i), SEEK_SET);
+        if (!read_entry(fp, &entry)) memset(&entry, 0, sizeof(entry));
+
+        if (entry.status == STATUS_VALID) {
+            if (i == 0) {
+                entry.start_block = (uint64_t)copy;
+            } else if (i == 1) {
+                entry.start_block = parent ? parent : (uint64_t)copy;
+            } else if (entry.file_type == TYPE_DIR || entry.file_type == TYPE_FILE ||
+                       (entry.file_type == TYPE_PACKED && entry.size > 0)) {
+                refcount_inc(fp, sup, entry.start_block);
+            }
+        }
+        fseek(fp, dir_slot_pos(g, (uint64_t)copy, (long)i), SEEK_SET);
+        write_entry(fp, &entry);
+    }
+    fseek(fp, old_pos, SEEK_SET);
+
+    refcount_release(fp, sup, old);
+    dir_move_add(old, (uint64_t)copy);
+    struct slot_hint *h = slot_hint_get(old);
+    if (h) slot_hint_set((uint64_t)copy, h->first_free);
+    return copy;
+}
+
+// Garante que nem 'dir' nem seus ancestrais são compartilhados com um snapshot, copiando
+// os que forem. Atualiza dir->start_block. Retorna 0 se faltar espaço para as cópias
+static int dir_unshare(FILE *fp, struct superblock *sup, struct dir_entry *dir) {
+    dir_follow(dir);
+    if (!sup->snap_table) return 1;
+
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    const struct sacs_geometry *g = geom_for(real_block_size);
+    uint64_t path[DIR_DEPTH_MAX];
+    unsigned depth = 0;
+    int shared = 0;
+
+    // Sobe até a raiz atual
+    uint64_t block = dir->start_block;
+    while (1) {
+        if (depth == DIR_DEPTH_MAX) {
+            printf("Erro: Diretorio profundo demais para a copia na escrita.\n");
+            return 0;
+        }
+        path[depth++] = block;
+        if (refcount_get(fp, sup, block)) shared = 1;
+        if (block == sup->root_start) break;
+        long parent = dir_live_parent(fp, sup, block);
+        if (parent < 0) {
+            printf("Erro: Pai do diretorio no bloco %" PRIu64 " nao encontrado.\n", block);
+            return 0;
+        }
+        block = (uint64_t)parent;
+    }
+    if (!shared) return 1;
+
+    // Desce copiando: a cópia de um pai dá referência extra aos filhos, que também são copiados
+    uint64_t parent = 0, parent_length = 0;
+    for (unsigned i = depth; i-- > 0; ) {
+        uint64_t current = path[i], length = sup->root_size;
+        struct dir_entry entry;
+        long slot = -1;
+        if (parent) {
+            slot = dir_scan(fp, parent, parent_length, real_block_size, SCAN_CHILD, NULL, current, &entry);
+            if (slot < 0) return 0;
+            length = entry.length;
+        }
+
+        if (refcount_get(fp, sup, current)) {
+            long copy = dir_copy(fp, sup, current, length, parent);
+            if (copy == -1) {
+                printf("Erro: Espaço insuficiente para copiar o diretorio (copy-on-write).\n");
+                return 0;
+            }
+            if (parent) {
+                long old_pos = ftell(fp);
+                entry.start_block = (uint64_t)copy;
+                fseek(fp, dir_slot_pos(g, parent, slot), SEEK_SET);
+                write_entry(fp, &entry);
+                fseek(fp, old_pos, SEEK_SET);
+            } else {
+                sup->root_start = (uint64_t)copy;
+                write_superblock(fp, sup);
+            }
+            current = (uint64_t)copy;
+        }
+        parent = current;
+        parent_length = length;
+    }
+    dir->start_block = parent;
+    return 1;
+}
+
+// PREPARAR STRUCT
+void prepare_dir_entry(struct dir_entry *entry, char *file_name, unsigned short file_type, 
+                      uint64_t size, uint64_t start_block, unsigned block_size){
+    memset(entry, 0, sizeof(struct dir_entry));
+    entry->status = STATUS_VALID;
+    strncpy(entry->file_name, file_name, 16);
+    entry->file_type = file_type;
+    entry->start_block = start_block;
+    entry->size = size;
+    entry->length = (block_size > 0) ? (size + block_size - 1) / block_size : 0;
+}
+
+// Blocos realmente reservados para um arquivo (arquivos vazios ainda ocupam 1 bloco)
+static unsigned file_alloc_blocks(struct dir_entry *entry) {
+    return (entry->length > 0) ? entry->length : 1;
+}
+
+// ADICIONAR AO PAI 
+int add_entry_to_parent(FILE *fp, struct dir_entry *parent, struct dir_entry *new_entry, unsigned block_size) {
+    uint64_t max = parent->length << geom_for(block_size)->entries_shift;
+    struct slot_hint *h = slot_hint_get(parent->start_block);
+    uint64_t from = (h && h->first_free < max) ? h->first_free : 0;
+
+    // A varredura lê as entradas do disco: só devolve uma que esteja mesmo livre.
+    // Se nada aparecer a partir da dica, ela estava adiantada e o começo é conferido
+    long slot = dir_scan_range(fp, parent->start_block, from, max, block_size, SCAN_FREE, NULL, 0, NULL, NULL);
+    if (slot < 0 && from > 0) {
+        slot = dir_scan_range(fp, parent->start_block, 0, from, block_size, SCAN_FREE, NULL, 0, NULL, NULL);
+    }
+    if (slot < 0) return 0; // Pai cheio
+
+    if (h) h->first_free = (uint64_t)slot;
+    dir_write_slot(fp, parent, slot, new_entry, block_size);
+    return 1; // Sucesso
+}
+
+// Procura 'name' e a primeira entrada livre numa só passada pelo diretório inteiro.
+// Retorna o índice livre, DIR_DUPLICATE se o nome já existe ou DIR_FULL
+long dir_reserve_slot(FILE *fp, struct dir_entry *parent, char *name, unsigned block_size) {
+    uint64_t max = parent->length << geom_for(block_size)->entries_shift;
+    struct scan_slots slots = { -1 };
+
+    if (dir_scan_range(fp, parent->start_block, 0, max, block_size, SCAN_NAME, name, 0, NULL, &slots) >= 0) {
+        return DIR_DUPLICATE;
+    }
+
+    // A passada leu todas as entradas: a livre encontrada está livre no disco e a dica fica exata
+    if (slots.first_free < 0) {
+        slot_hint_set(parent->start_block, max);
+        return DIR_FULL;
+    }
+    slot_hint_set(parent->start_block, (uint64_t)slots.first_free);
+    return slots.first_free;
+}
+
+// Grava a entrada no índice reservado por dir_reserve_slot (ou achado livre por add_entry_to_parent)
+void dir_write_slot(FILE *fp, struct dir_entry *parent, long slot, struct dir_entry *entry, unsigned block_size) {
+    fseek(fp, dir_slot_pos(geom_for(block_size), parent->start_block, slot), SEEK_SET);
+    write_entry(fp, entry);
+    slot_hint_used(parent->start_block, (uint64_t)slot);
+}
+
+// --- EMPACOTAMENTO DE ARQUIVOS PEQUENOS ---
+// Arquivos pequenos não recebem blocos próprios: ficam em blocos compartilhados divididos
+// em unidades de PACK_UNIT bytes. A entrada usa TYPE_PACKED, start_block aponta para o
+// bloco compartilhado e length guarda o deslocamento em bytes dentro dele.
+
+int is_regular_file(struct dir_entry *entry) {
+    return entry->file_type == TYPE_FILE || entry->file_type == TYPE_PACKED;
+}
+
+// Posição em bytes do primeiro byte de dados do arquivo
+unsigned long entry_data_pos(struct dir_entry *entry, unsigned real_block_size) {
+    unsigned long pos = (unsigned long)entry->start_block * real_block_size;
+    if (entry->file_type == TYPE_PACKED) pos += entry->length;
+    return pos;
+}
+
+static unsigned pack_units_per_block(unsigned real_block_size) {
+    return real_block_size / PACK_UNIT;
+}
+
+// Retorna 1 se um arquivo deste tamanho deve ser empacotado
+static int pack_eligible(uint64_t size, unsigned real_block_size) {
+    unsigned units = pack_units_per_block(real_block_size);
+    if (units < 4 || units > 1 + PACK_MAP_BYTES * 8) return 0;
+    return size <= real_block_size / 4;
+}
+
+// Procura 'units' unidades livres consecutivas no mapa. Retorna a primeira ou -1
+static int pack_find_run(struct pack_header *hdr, unsigned units) {
+    unsigned run = 0;
+    for (unsigned u = 1; u < hdr->units; u++) {
+        if (get_bit(hdr->map, u)) { run = 0; continue; }
+        if (++run == units) return (int)(u - units + 1);
+    }
+    return -1;
+}
+
+static unsigned pack_free_units(struct pack_header *hdr) {
+    return (hdr->units > hdr->used + 1u) ? hdr->units - 1u - hdr->used : 0;
+}
+
+// Anota quantas unidades livres o bloco tem; 0 tira o bloco da lista
+static void pack_partial_note(unsigned block, unsigned free_units) {
+    for (unsigned i = 0; i < pack_partial_count; i++) {
+        if (pack_partials[i].block != block) continue;
+        if (free_units) pack_partials[i].free = free_units;
+        else pack_partials[i] = pack_partials[--pack_partial_count];
+        return;
+    }
+    if (!free_units) return;
+    if (pack_partial_count == pack_partial_cap) {
+        unsigned cap = pack_partial_cap ? pack_partial_cap * 2 : 16;
+        struct pack_partial *items = realloc(pack_partials, cap * sizeof(struct pack_partial));
+        if (!items) return;   // Só perde a chance de reaproveitar o bloco
+        pack_partials = items;
+        pack_partial_cap = cap;
+    }
+    pack_partials[pack_partial_count].block = block;
+    pack_partials[pack_partial_count].free = free_units;
+    pack_partial_count++;
+}
+
+// Procura 'units' unidades consecutivas num bloco da lista (exceto 'skip'). Retorna o
+// bloco com o cabeçalho em hdr e a primeira unidade em first, ou 0
+static unsigned pack_partial_find(FILE *fp, struct superblock *sup, unsigned units, unsigned skip,
+                                  struct pack_header *hdr, int *first) {
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    for (unsigned i = 0; i < pack_partial_count; ) {
+        struct pack_partial *p = &pack_partials[i];
+        if (p->block == skip || p->free < units) { i++; continue; }
+
+        fseek(fp, (unsigned long)p->block * real_block_size, SEEK_SET);
+        if (refcount_get(fp, sup, p->block) ||
+            fread(hdr, sizeof(*hdr), 1, fp) != 1 || hdr->magic != PACK_MAGIC) {
+            pack_partials[i] = pack_partials[--pack_partial_count];   // Congelado ou reaproveitado
+            continue;
+        }
+        p->free = pack_free_units(hdr);
+        *first = pack_find_run(hdr, units);
+        if (*first != -1) return p->block;
+        i++;   // Unidades livres, mas espalhadas
+    }
+    return 0;
+}
+
+// Reserva espaço para 'size' bytes. Preenche bloco e deslocamento; retorna 0 se o disco está cheio
+static int pack_alloc(FILE *fp, struct superblock *sup, unsigned size,
+                      unsigned *out_block, unsigned *out_offset) {
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    unsigned units = (size + PACK_UNIT - 1) / PACK_UNIT;
+
+    // Arquivos vazios não ocupam espaço
+    if (units == 0) {
+        *out_block = 0;
+        *out_offset = 0;
+        return 1;
+    }
+
+    long old_pos = ftell(fp);
+    struct pack_header hdr;
+    int first = -1;
+    unsigned block = sup->pack_block;
+
+    // Tenta o bloco de empacotamento corrente (blocos de um snapshot estão congelados)
+    if (block != 0 && !refcount_get(fp, sup, block)) {
+        fseek(fp, (unsigned long)block * real_block_size, SEEK_SET);
+        if (fread(&hdr, sizeof(hdr), 1, fp) == 1 && hdr.magic == PACK_MAGIC) {
+            first = pack_find_run(&hdr, units);
+        }
+    }
+
+    // Outro bloco que ganhou espaço com remoções
+    if (first == -1) {
+        unsigned partial = pack_partial_find(fp, sup, units, block, &hdr, &first);
+        if (partial) block = partial;
+    }
+
+    // Bloco novo; o corrente fica na lista se ainda tiver unidades livres
+    if (first == -1) {
+        if (block != 0 && !refcount_get(fp, sup, block)) {
+            struct pack_header old_hdr;
+            fseek(fp, (unsigned long)block * real_block_size, SEEK_SET);
+            if (fread(&old_hdr, sizeof(old_hdr), 1, fp) == 1 && old_hdr.magic == PACK_MAGIC) {
+                pack_partial_note(block, pack_free_units(&old_hdr));
+            }
+        }
+        long int new_block = contiguous_alloc(fp, real_block_size, real_block_size,
+                                              sup->bitmap_start, sup->total_blocks);
+        if (new_block == -1) {
+            fseek(fp, old_pos, SEEK_SET);
+            return 0;
+        }
+        block = (unsigned)new_block;
+        memset(&hdr, 0, sizeof(hdr));
+        hdr.magic = PACK_MAGIC;
+        hdr.units = pack_units_per_block(real_block_size);
+        set_bit(hdr.map, 0); // Unidade 0 é o próprio cabeçalho
+        first = 1;
+
+        sup->pack_block = block;
+        write_superblock(fp, sup);
+    }
+
+    for (unsigned u = first; u < first + units; u++) set_bit(hdr.map, u);
+    hdr.used += units;
+    if (block != sup->pack_block) pack_partial_note(block, pack_free_units(&hdr));
+
+    fseek(fp, (unsigned long)block * real_block_size, SEEK_SET);
+    fwrite(&hdr, sizeof(hdr), 1, fp);
+
+    *out_block = block;
+    *out_offset = (unsigned)first * PACK_UNIT;
+    fseek(fp, old_pos, SEEK_SET);
+    return 1;
+}
+
+// Devolve as unidades de um arquivo empacotado; libera o bloco quando fica vazio
+static void pack_free(FILE *fp, struct superblock *sup, unsigned block, unsigned offset, unsigned size) {
+    unsigned units = (size + PACK_UNIT - 1) / PACK_UNIT;
+    if (units == 0 || block == 0) return;
+
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    long old_pos = ftell(fp);
+    struct pack_header hdr;
+
+    fseek(fp, (unsigned long)block * real_block_size, SEEK_SET);
+    if (fread(&hdr, sizeof(hdr), 1, fp) != 1 || hdr.magic != PACK_MAGIC) {
+        printf("ERRO: Bloco %u nao e um bloco de empacotamento.\n", block);
+        fseek(fp, old_pos, SEEK_SET);
+        return;
+    }
+
+    // Bloco congelado por snapshot: as unidades continuam reservadas
+    if (refcount_get(fp, sup, block)) {
+        fseek(fp, old_pos, SEEK_SET);
+        return;
+    }
+
+    unsigned first = offset / PACK_UNIT;
+    for (unsigned u = first; u < first + units; u++) unset_bit(hdr.map, u);
+    hdr.used = (hdr.used >= units) ? hdr.used - units : 0;
+
+    if (hdr.used == 0) {
+        // Bloco vazio volta para o bitmap
+        memset(&hdr, 0, sizeof(hdr));
+        fseek(fp, (unsigned long)block * real_block_size, SEEK_SET);
+        fwrite(&hdr, sizeof(hdr), 1, fp);
+        contiguous_dealloc(fp, block, 1, sup->bitmap_start, real_block_size, sup->data_start);
+        pack_partial_note(block, 0);
+        if (sup->pack_block == block) {
+            sup->pack_block = 0;
+            write_superblock(fp, sup);
+        }
+    } else {
+        fseek(fp, (unsigned long)block * real_block_size, SEEK_SET);
+        fwrite(&hdr, sizeof(hdr), 1, fp);
+        // Sem bloco corrente: reaproveita este, que acabou de ganhar espaço
+        if (sup->pack_block == 0) {
+            sup->pack_block = block;
+            write_superblock(fp, sup);
+        }
+        if (sup->pack_block != block) pack_partial_note(block, pack_free_units(&hdr));
+    }
+
+    fseek(fp, old_pos, SEEK_SET);
+}
+
+// CRIAR ARQUIVO E DIRETÓRIO
+// Cria o arquivo na entrada 'slot' já reservada por dir_reserve_slot
+static int create_file_slot(FILE *fp, struct dir_entry *parent_dir, struct superblock *sup,
+                            char *file_name, uint64_t size, char *data, long slot) {
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+
+    if (size > max_file_size(sup)) {
+        printf("Erro: '%s' excede o tamanho maximo de arquivo deste formato.\n", file_name);
+        return 0;
+    }
+
+    // Arquivo pequeno: vai para um bloco compartilhado
+    if (pack_eligible(size, real_block_size)) {
+        unsigned pack_block, pack_offset;
+        if (!pack_alloc(fp, sup, size, &pack_block, &pack_offset)) {
+            printf("Erro: Disco cheio p/ arquivo '%s'.\n", file_name);
+            return 0;
+        }
+
+        struct dir_entry new_entry;
+        prepare_dir_entry(&new_entry, file_name, TYPE_PACKED, size, pack_block, real_block_size);
+        new_entry.length = pack_offset;
+
+        dir_write_slot(fp, parent_dir, slot, &new_entry, real_block_size);
+        if (size > 0 && data != NULL) {
+            fseek(fp, entry_data_pos(&new_entry, real_block_size), SEEK_SET);
+            fwrite(data, 1, size, fp);
+        }
+        update_hierarchy_size(fp, parent_dir->start_block, (int64_t)size, real_block_size);
+        parent_dir->size += size;
+        printf("Arquivo '%s' criado no bloco %u (empacotado, offset %u).\n", file_name, pack_block, pack_offset);
+        return 1;
+    }
+
+    long int file_start = contiguous_alloc_near(fp, size, real_block_size, sup->bitmap_start,
+                                                sup->total_blocks, parent_dir->start_block);
+    
+    if (file_start == -1) {
+        printf("Erro: Disco cheio p/ arquivo '%s'.\n", file_name);
+        return 0;
+    }
+
+    struct dir_entry new_entry;
+    prepare_dir_entry(&new_entry, file_name, TYPE_FILE, size, file_start, real_block_size);
+
+    dir_write_slot(fp, parent_dir, slot, &new_entry, real_block_size);
+    if (size > 0 && data != NULL) {
+        fseek(fp, file_start * real_block_size, SEEK_SET);
+        fwrite(data, 1, size, fp);
+    }
+    update_hierarchy_size(fp, parent_dir->start_block, (int64_t)size, real_block_size);
+    parent_dir->size += size;
+    printf("Arquivo '%s' criado no bloco %ld.\n", file_name, file_start);
+    return 1;
+}
+
+static int create_file_impl(FILE *fp, struct dir_entry *parent_dir, struct superblock *sup, 
+                            char *file_name, uint64_t size, char *data) {
+    
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+
+    if (!dir_unshare(fp, sup, parent_dir)) return 0;
+
+    // Duplicata e entrada livre numa só passada pelo diretório
+    long slot = dir_reserve_slot(fp, parent_dir, file_name, real_block_size);
+    if (slot == DIR_DUPLICATE) {
+        printf("Erro: O arquivo '%s' ja existe neste diretorio.\n", file_name);
+        return 0; // Aborta imediatamente
+    }
+    if (slot == DIR_FULL) {
+        printf("Erro: Diretorio pai cheio.\n");
+        return 0;
+    }
+    return create_file_slot(fp, parent_dir, sup, file_name, size, data, slot);
+}
+
+// Cria um diretório com 'blocks' blocos de entradas
+static int create_dir_impl(FILE *fp, struct dir_entry *parent_dir, struct superblock *sup, char *dir_name,
+                           unsigned blocks) {
+    
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+
+    if (!dir_unshare(fp, sup, parent_dir)) return 0;
+
+    // Nao permitir arquivos/diretorios de nomes iguais (e já reserva a entrada no pai)
+    long slot = dir_reserve_slot(fp, parent_dir, dir_name, real_block_size);
+    if (slot == DIR_DUPLICATE) {
+        printf("Erro: O diretorio/arquivo '%s' ja existe.\n", dir_name);
+        return 0;
+    }
+    if (slot == DIR_FULL) {
+        printf("Erro: Diretório pai cheio.\n");
+        return 0;
+    }
+
+    // Tamanho Lógico: Apenas . e .. 
+    unsigned dir_logical_size = ENTRY_SIZE * 2; 
+    
+    // Tamanho Físico para alocar: blocos inteiros
+    uint64_t alloc_size = (uint64_t)blocks * real_block_size; 
+
+    // Aloca 
+    long int dir_start = contiguous_alloc_near(fp, alloc_size, real_block_size, sup->bitmap_start,
+                                               sup->total_blocks, parent_dir->start_block);
+    
+    if (dir_start == -1) {
+        printf("Erro: Espaço insuficiente.\n");
+        return 0;
+    }
+
+    // Prepara entrada com tamanho logico
+    struct dir_entry new_dir_entry;
+    prepare_dir_entry(&new_dir_entry, dir_name, TYPE_DIR, dir_logical_size, dir_start, real_block_size);
+    new_dir_entry.length = blocks;
+
+    // Adiciona ao pai
+    dir_write_slot(fp, parent_dir, slot, &new_dir_entry, real_block_size);
+
+    // Inicializa o conteúdo do novo diretório
+    unsigned char *zeros = calloc(1, real_block_size);
+    fseek(fp, dir_start * real_block_size, SEEK_SET);
+    for (unsigned i = 0; i < blocks; i++) fwrite(zeros, 1, real_block_size, fp);
+    free(zeros);
+
+    struct dir_entry dot, dotdot;
+    
+    // Ponto (.): Tamanho lógico inicial (64)
+    prepare_dir_entry(&dot, ".", TYPE_DIR, dir_logical_size, dir_start, real_block_size);
+    dot.length = blocks;
+    
+    // Ponto-Ponto (..): Aponta para o pai (tamanho atual do pai)
+    prepare_dir_entry(&dotdot, "..", TYPE_DIR, parent_dir->size, parent_dir->start_block, real_block_size);
+
+    fseek(fp, dir_start * real_block_size, SEEK_SET);
+    write_entry(fp, &dot);
+    write_entry(fp, &dotdot);
+    slot_hint_set(dir_start, 2);   // Só . e ..
+
+    // Atualização em cascata
+    update_hierarchy_size(fp, parent_dir->start_block, (int64_t)dir_logical_size, real_block_size);
+    
+    // Atualiza memória local
+    parent_dir->size += dir_logical_size;
+    
+    printf("Diretório '%s' criado (Bloco %ld, Tamanho %u).\n", dir_name, dir_start, dir_logical_size);
+    return 1;
+}
+
+// Remover arquivo/diretorio
+static int delete_item_impl(FILE *fp, struct dir_entry *parent, struct superblock *sup, char *name) {
+    unsigned int real_block_size = (1 << sup->sector_size) << sup->block_size;
+    struct dir_entry temp_entry;
+
+    if (!dir_unshare(fp, sup, parent)) return 0;
+    long old_pos = ftell(fp); 
+
+    // Procurar o arquivo pelo nome
+    long found_index = dir_scan(fp, parent->start_block, parent->length, real_block_size,
+                                SCAN_NAME, name, 0, &temp_entry);
+
+    if (found_index == -1) {
+        printf("Erro: Arquivo '%s' não encontrado.\n", name);
+        fseek(fp, old_pos, SEEK_SET);
+        return 0;
+    }
+
+    // Validações de Segurança
+    if (strcmp(temp_entry.file_name, ".") == 0 || strcmp(temp_entry.file_name, "..") == 0) {
+        printf("Erro: Não é possível deletar '.' ou '..'.\n");
+        fseek(fp, old_pos, SEEK_SET);
+        return 0;
+    }
+
+    //Nao deve ser possivel deletar o diretorio raiz
+    if (temp_entry.start_block == sup->root_start) {
+        printf("ERRO CRÍTICO: Não é possível deletar o Diretório Raiz.\n");
+        fseek(fp, old_pos, SEEK_SET);
+        return 0;
+    }
+
+    // Se for diretório, verificar se está vazio
+    if (temp_entry.file_type == TYPE_DIR) {
+        if (temp_entry.size > (ENTRY_SIZE * 2)) {
+            printf("Erro: O diretório '%s' não está vazio.\n", name);
+            fseek(fp, old_pos, SEEK_SET);
+            return 0;
+        }
+    }
+
+    uint64_t size_to_remove = temp_entry.size;
+
+    // Desalocar os blocos no Bitmap (ou as unidades do bloco compartilhado)
+    if (temp_entry.file_type == TYPE_PACKED) {
+        pack_free(fp, sup, temp_entry.start_block, temp_entry.length, temp_entry.size);
+    } else if (refcount_release(fp, sup, temp_entry.start_block)) {
+        // Extent ou diretório compartilhado com um snapshot: só perde uma referência
+    } else {
+        unsigned blocks_to_free = (temp_entry.file_type == TYPE_FILE) ? file_alloc_blocks(&temp_entry)
+                                                                      : temp_entry.length;
+        contiguous_dealloc(fp, temp_entry.start_block, blocks_to_free, 
+                           sup->bitmap_start, real_block_size, sup->data_start);
+    }
+
+    // Marcar a entrada como LIVRE
+    temp_entry.status = STATUS_FREE; 
+    
+    unsigned long entry_pos = dir_slot_pos(geom_for(real_block_size), parent->start_block, found_index);
+    fseek(fp, entry_pos, SEEK_SET);
+    write_entry(fp, &temp_entry);
+    slot_hint_freed(parent->start_block, (uint64_t)found_index);
+
+    update_hierarchy_size(fp, parent->start_block, -(int64_t)size_to_remove, real_block_size);
+
+    // Atualizar o tamanho do Pai
+    if (parent->size >= size_to_remove) parent->size -= size_to_remove;
+    else parent->size = 0;
+
+    printf("Sucesso: '%s' foi deletado e os blocos liberados.\n", name);
+    
+    fseek(fp, old_pos, SEEK_SET); 
+    return 1;
+}
+
+// cd
+static int change_directory_impl(FILE *fp, struct dir_entry *current_dir, struct superblock *sup, char *target_name) {
+    unsigned int real_block_size = (1 << sup->sector_size) << sup->block_size;
+    struct dir_entry entry;
+    
+    long old_pos = ftell(fp);
+
+    // Procura o diretório alvo na pasta atual
+    int found = find_entry(fp, current_dir, target_name, real_block_size, &entry) >= 0;
+    if (found && entry.file_type != TYPE_DIR) {
+        printf("Erro: '%s' e um arquivo, nao um diretorio.\n", target_name);
+        fseek(fp, old_pos, SEEK_SET);
+        return 0;
+    }
+
+    if (!found) {
+        printf("Erro: Diretorio '%s' nao encontrado.\n", target_name);
+        fseek(fp, old_pos, SEEK_SET);
+        return 0;
+    }
+
+    // Entra no diretório e le o .
+    unsigned long target_block_addr = (unsigned long)entry.start_block * real_block_size;
+    fseek(fp, target_block_addr, SEEK_SET);
+    read_entry(fp, current_dir);
+
+    // Mostrar o nome da pasta que está no printf
+    if (strcmp(target_name, ".") != 0 && strcmp(target_name, "..") != 0) {
+        strncpy(current_dir->file_name, target_name, 16);
+    }
+
+    printf("Mudou para diretorio: %s (Bloco %" PRIu64 ")\n", current_dir->file_name, current_dir->start_block);
+    
+    fseek(fp, old_pos, SEEK_SET);
+    return 1;
+}
+
+static int import_file_impl(FILE *fp_sacs, struct dir_entry *parent, struct superblock *sup, char *external_path) {
+    unsigned int real_block_size = (1 << sup->sector_size) << sup->block_size;
+
+    // Abrir arquivo externo 
+    FILE *f_ext = fopen(external_path, "rb");
+    if (!f_ext) {
+        printf("Erro: Arquivo externo '%s' nao encontrado.\n", external_path);
+        return 0;
+    }
+
+    // Descobrir tamanho do arquivo externo
+    fseeko(f_ext, 0, SEEK_END);
+    uint64_t file_size = ftello(f_ext);
+    fseeko(f_ext, 0, SEEK_SET); // Volta para o início
+
+    // Extrair apenas o nome do arquivo (remove o caminho /home/user/...)
+    char *filename = strrchr(external_path, '/');
+    if (filename) filename++; // Pula a barra
+    else filename = external_path;
+
+    if (file_size > max_file_size(sup)) {
+        printf("Erro: '%s' excede o tamanho maximo de arquivo deste formato.\n", filename);
+        fclose(f_ext);
+        return 0;
+    }
+
+    // Arquivo pequeno: lê para a memória e empacota via create_file (que verifica duplicatas)
+    if (pack_eligible(file_size, real_block_size)) {
+        char *data = malloc(file_size ? file_size : 1);
+        if (!data) {
+            printf("Erro fatal de memória RAM.\n");
+            fclose(f_ext);
+            return 0;
+        }
+        size_t got = fread(data, 1, file_size, f_ext);
+        fclose(f_ext);
+        int ok = create_file_impl(fp_sacs, parent, sup, filename, got, data);
+        free(data);
+        return ok;
+    }
+
+    if (!dir_unshare(fp_sacs, sup, parent)) {
+        fclose(f_ext);
+        return 0;
+    }
+
+    // Verificação de Duplicata (a mesma passada acha a entrada livre)
+    long slot = dir_reserve_slot(fp_sacs, parent, filename, real_block_size);
+    if (slot == DIR_DUPLICATE) {
+        printf("Erro: O arquivo '%s' ja existe na pasta de destino.\n", filename);
+        fclose(f_ext);
+        return 0;
+    }
+    if (slot == DIR_FULL) {
+        printf("Erro: Diretório cheio (limite de arquivos atingido).\n");
+        fclose(f_ext);
+        return 0;
+    }
+
+    // Alocar espaço no Bitmap
+    long int sacs_start_block = contiguous_alloc_near(fp_sacs, file_size, real_block_size, 
+                                                      sup->bitmap_start, sup->total_blocks,
+                                                      parent->start_block);
+    
+    if (sacs_start_block == -1) {
+        printf("Erro: Espaço insuficiente no disco para %" PRIu64 " bytes.\n", file_size);
+        fclose(f_ext);
+        return 0;
+    }
+
+    // Preparar e Adicionar a Entrada no Diretório Pai
+    struct dir_entry new_entry;
+    prepare_dir_entry(&new_entry, filename, TYPE_FILE, file_size, sacs_start_block, real_block_size); 
+    dir_write_slot(fp_sacs, parent, slot, &new_entry, real_block_size);
+
+    // Escrever os Dados
+    printf("Importando '%s' para o Bloco %ld...", filename, sacs_start_block);
+
+    int transferred = 0;
+    if (stripe_is(fp_sacs)) {
+        // Volume em faixas: cada membro recebe sua parte em paralelo
+        struct stripe_stats st;
+        if (stripe_copy(fp_sacs, (off_t)sacs_start_block * real_block_size, fileno(f_ext), 0,
+                        file_size, 1, &st) == 0) {
+            printf("\n");
+            stripe_print_stats(&st);
+            transferred = 1;
+        } else {
+            printf("Aviso: falha na copia paralela, repetindo de forma sincrona.\n");
+        }
+    }
+
+    if (!transferred && dio_enabled()) {
+        // E/S direta: não passa pelo page cache nem do arquivo externo nem da imagem
+        struct dio_stats st;
+        fflush(fp_sacs);
+        if (dio_copy(fileno(f_ext), 0, fileno(fp_sacs), (off_t)sacs_start_block * real_block_size,
+                     file_size, &st) == 0) {
+            printf("\n");
+            dio_print_stats(&st);
+            transferred = 1;
+        } else {
+            printf("Aviso: E/S direta indisponivel, usando o caminho com buffer.\n");
+        }
+    }
+
+    if (!transferred && aio_enabled()) {
+        // Caminho assíncrono: descarrega o stdio e transfere direto pelos descritores
+        struct aio_stats st;
+        fflush(fp_sacs);
+        if (aio_copy(fileno(f_ext), 0, fileno(fp_sacs), (off_t)sacs_start_block * real_block_size,
+                     file_size, &st) == 0) {
+            printf("\n");
+            aio_print_stats(&st);
+            transferred = 1;
+        } else {
+            printf("Aviso: falha no caminho assincrono, repetindo de forma sincrona.\n");
+        }
+    }
+
+    if (!transferred) {
+        const struct sacs_geometry *g = geom_for(real_block_size);
+        unsigned long io_size = (unsigned long)g->block_bytes << SACS_IO_SHIFT;
+        unsigned char *buffer = malloc(io_size);
+        if (!buffer) {
+            printf("Erro fatal de memória RAM.\n");
+            fclose(f_ext);
+            return 0; 
+        }
+
+        unsigned long bytes_remaining = file_size;
+        unsigned long offset = 0;
+
+        while (bytes_remaining > 0) {
+            // Lê o que der
+            size_t chunk_size = (bytes_remaining < io_size) ? bytes_remaining : io_size;
+            
+            // Lê da fonte
+            fread(buffer, 1, chunk_size, f_ext);
+
+            // Calcula posição no SACS e escreve
+            unsigned long sacs_write_pos = ((unsigned long)sacs_start_block << g->block_shift) + offset;
+            fseek(fp_sacs, sacs_write_pos, SEEK_SET);
+            fwrite(buffer, 1, chunk_size, fp_sacs);
+
+            bytes_remaining -= chunk_size;
+            offset += chunk_size;
+        }
+
+        free(buffer);
+    }
+    fclose(f_ext);
+
+    // Atualização de tamanho em cascata
+    update_hierarchy_size(fp_sacs, parent->start_block, (int64_t)file_size, real_block_size);
+    
+    // Atualiza a estrutura local na memória
+    parent->size += file_size; 
+
+    printf(" Sucesso! (%" PRIu64 " bytes adicionados a hierarquia)\n", file_size);
+    return 1;
+}
+
+// Descritor da imagem para dicas ao kernel; volumes em faixas não têm um
+static int volume_fd(FILE *fp) {
+    return stripe_is(fp) ? -1 : fileno(fp);
+}
+
+// Retorna a quantidade de bytes exportados, ou -1 em caso de erro
+static long export_file_impl(FILE *fp_sacs, struct dir_entry *parent, struct superblock *sup, 
+                             char *sacs_filename, char *dest_path) {
+    
+    unsigned int real_block_size = (1 << sup->sector_size) << sup->block_size;
+    struct dir_entry entry;
+
+    long old_pos = ftell(fp_sacs); // SAVE
+    dir_follow(parent);
+
+    // Localizar arquivo no SACS
+    int found = dir_scan(fp_sacs, parent->start_block, parent->length, real_block_size,
+                         SCAN_NAME, sacs_filename, 0, &entry) >= 0;
+
+    if (!found) {
+        printf("Erro: Arquivo '%s' nao encontrado no SACS.\n", sacs_filename);
+        fseek(fp_sacs, old_pos, SEEK_SET);
+        return -1;
+    }
+    
+    if (entry.file_type == TYPE_DIR) {
+        printf("Erro: '%s' e um diretorio.\n", sacs_filename);
+        fseek(fp_sacs, old_pos, SEEK_SET);
+        return -1;
+    }
+
+    // Preparar Destino
+    FILE *f_out = fopen(dest_path, "wb");
+    if (!f_out) {
+        perror("Erro ao criar arquivo de destino");
+        fseek(fp_sacs, old_pos, SEEK_SET);
+        return -1;
+    }
+
+    printf("Exportando '%s' para '%s'...", sacs_filename, dest_path);
+
+    int transferred = 0;
+    if (stripe_is(fp_sacs)) {
+        struct stripe_stats st;
+        fflush(f_out);
+        if (stripe_copy(fp_sacs, (off_t)entry_data_pos(&entry, real_block_size), fileno(f_out), 0,
+                        entry.size, 0, &st) == 0) {
+            printf("\n");
+            stripe_print_stats(&st);
+            transferred = 1;
+        } else {
+            printf("Aviso: falha na copia paralela, repetindo de forma sincrona.\n");
+        }
+    }
+
+    if (!transferred && dio_enabled()) {
+        struct dio_stats st;
+        fflush(fp_sacs);
+        fflush(f_out);
+        if (dio_copy(fileno(fp_sacs), (off_t)entry_data_pos(&entry, real_block_size), fileno(f_out), 0,
+                     entry.size, &st) == 0) {
+            printf("\n");
+            dio_print_stats(&st);
+            transferred = 1;
+        } else {
+            printf("Aviso: E/S direta indisponivel, usando o caminho com buffer.\n");
+        }
+    }
+
+    if (!transferred && aio_enabled()) {
+        struct aio_stats st;
+        fflush(fp_sacs);
+        if (aio_copy(fileno(fp_sacs), (off_t)entry_data_pos(&entry, real_block_size), fileno(f_out), 0,
+                     entry.size, &st) == 0) {
+            printf("\n");
+            aio_print_stats(&st);
+            transferred = 1;
+        } else {
+            printf("Aviso: falha no caminho assincrono, repetindo de forma sincrona.\n");
+        }
+    }
+
+    // CÓPIA EM CHUNKS
+    if (!transferred) {
+        unsigned long io_size = (unsigned long)geom_for(real_block_size)->block_bytes << SACS_IO_SHIFT;
+        unsigned char *buffer = malloc(io_size);
+        if (!buffer) { fclose(f_out); fseek(fp_sacs, old_pos, SEEK_SET); return -1; }
+
+        unsigned long bytes_remaining = entry.size;
+        unsigned long offset = 0;
+
+        // Leitura antecipada: o kernel busca o trecho seguinte enquanto este é gravado
+        struct prefetch_stream ra;
+        unsigned long data_pos = entry_data_pos(&entry, real_block_size);
+        prefetch_begin(&ra, volume_fd(fp_sacs), data_pos, data_pos + entry.size);
+
+        while (bytes_remaining > 0) {
+            size_t chunk_size = (bytes_remaining < io_size) ? bytes_remaining : io_size;
+
+            // Calcula posição de leitura no SACS
+            unsigned long sacs_read_pos = data_pos + offset;
+
+            // Lê do SACS
+            prefetch_access(&ra, sacs_read_pos, chunk_size);
+            fseek(fp_sacs, sacs_read_pos, SEEK_SET);
+            fread(buffer, 1, chunk_size, fp_sacs);
+
+            // Escreve no destino
+            fwrite(buffer, 1, chunk_size, f_out);
+
+            bytes_remaining -= chunk_size;
+            offset += chunk_size;
+        }
+
+        free(buffer);
+    }
+    fclose(f_out);
+    fseek(fp_sacs, old_pos, SEEK_SET); // RESTORE
+    
+    printf(" Concluido!\n");
+    return (long)entry.size;
+}
+
+// --- CRESCIMENTO E TRUNCAMENTO DE ARQUIVOS ---
+
+// Procura 'name' no diretório. Retorna o índice da entrada (e copia para out) ou -1
+int find_entry(FILE *fp, struct dir_entry *parent, char *name, unsigned block_size, struct dir_entry *out) {
+    dir_follow(parent);
+    int slot = (int)dir_scan(fp, parent->start_block, parent->length, block_size, SCAN_NAME, name, 0, out);
+
+    // O ".." de um diretório ainda compartilhado aponta para a versão antiga do pai
+    if (slot >= 0 && out && !read_only && mounted_sup && strcmp(name, "..") == 0 &&
+        parent->start_block != mounted_sup->root_start && refcount_get(fp, mounted_sup, parent->start_block)) {
+        long live = dir_live_parent(fp, mounted_sup, parent->start_block);
+        if (live >= 0) out->start_block = (uint64_t)live;
+    }
+    return slot;
+}
+
+// Grava zeros em [pos, pos + len)
+static void zero_fill(FILE *fp, unsigned long pos, unsigned long len, unsigned real_block_size) {
+    if (len == 0) return;
+    unsigned long chunk = (unsigned long)geom_for(real_block_size)->block_bytes << SACS_IO_SHIFT;
+    unsigned char *zeros = calloc(1, chunk);
+    if (!zeros) return;
+
+    fseek(fp, pos, SEEK_SET);
+    while (len > 0) {
+        size_t n = (len < chunk) ? len : chunk;
+        fwrite(zeros, 1, n, fp);
+        len -= n;
+    }
+    free(zeros);
+}
+
+// Copia len bytes de src_pos para dst_pos dentro da imagem
+static int copy_range(FILE *fp, unsigned long src_pos, unsigned long dst_pos, unsigned long len,
+                      unsigned real_block_size) {
+    unsigned long chunk = (unsigned long)geom_for(real_block_size)->block_bytes << SACS_IO_SHIFT;
+    unsigned char *buffer = malloc(chunk);
+    if (!buffer) return 0;
+
+    unsigned long offset = 0;
+    while (offset < len) {
+        size_t chunk_size = (len - offset < chunk) ? len - offset : chunk;
+        fseek(fp, src_pos + offset, SEEK_SET);
+        fread(buffer, 1, chunk_size, fp);
+        fseek(fp, dst_pos + offset, SEEK_SET);
+        fwrite(buffer, 1, chunk_size, fp);
+        offset += chunk_size;
+    }
+    free(buffer);
+    return 1;
+}
+
+// Cópia na escrita: se os dados do arquivo são compartilhados com um snapshot,
+// move-os para um lugar próprio antes de qualquer modificação
+static int unshare_file(FILE *fp, struct dir_entry *parent, struct superblock *sup, int slot,
+                        struct dir_entry *entry) {
+    if (!sup->snap_table || !is_regular_file(entry)) return 1;
+    if (entry->file_type == TYPE_PACKED && entry->size == 0) return 1;
+    if (!refcount_get(fp, sup, entry->start_block)) return 1;
+
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    long old_pos = ftell(fp);
+    struct dir_entry moved = *entry;
+
+    if (entry->file_type == TYPE_PACKED) {
+        // O bloco congelado continua com o snapshot
+        unsigned pack_block, pack_offset;
+        if (!pack_alloc(fp, sup, entry->size, &pack_block, &pack_offset)) {
+            printf("Erro: Espaço insuficiente para copiar '%s' (copy-on-write).\n", entry->file_name);
+            fseek(fp, old_pos, SEEK_SET);
+            return 0;
+        }
+        moved.start_block = pack_block;
+        moved.length = pack_offset;
+    } else {
+        long int new_start = contiguous_alloc_near(fp, (uint64_t)file_alloc_blocks(entry) * real_block_size,
+                                                   real_block_size, sup->bitmap_start, sup->total_blocks,
+                                                   parent->start_block);
+        if (new_start == -1) {
+            printf("Erro: Espaço insuficiente para copiar '%s' (copy-on-write).\n", entry->file_name);
+            fseek(fp, old_pos, SEEK_SET);
+            return 0;
+        }
+        moved.start_block = (unsigned)new_start;
+        refcount_release(fp, sup, entry->start_block);
+    }
+
+    copy_range(fp, entry_data_pos(entry, real_block_size), entry_data_pos(&moved, real_block_size),
+               entry->size, real_block_size);
+    *entry = moved;
+    fseek(fp, (unsigned long)parent->start_block * real_block_size + (unsigned long)slot * ENTRY_SIZE, SEEK_SET);
+    write_entry(fp, entry);
+
+    fseek(fp, old_pos, SEEK_SET);
+    return 1;
+}
+
+// Muda o tamanho de um arquivo existente (entrada 'slot' do diretório 'parent').
+// Cresce no lugar quando os blocos seguintes ao extent estão livres; senão realoca.
+// Atualiza a entrada e os tamanhos da hierarquia de forma incremental.
+static int resize_file(FILE *fp, struct dir_entry *parent, struct superblock *sup, int slot,
+                       struct dir_entry *entry, uint64_t new_size, int zero_new) {
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    uint64_t old_size = entry->size;
+    unsigned old_blocks = file_alloc_blocks(entry);
+    unsigned new_blocks = (new_size + real_block_size - 1) / real_block_size;
+    if (new_blocks == 0) new_blocks = 1;
+
+    if (new_size > max_file_size(sup)) {
+        printf("Erro: Tamanho maximo de arquivo excedido.\n");
+        return 0;
+    }
+    if (!dir_unshare(fp, sup, parent)) return 0;
+    // Empacotados sempre mudam de lugar abaixo; extents compartilhados são copiados antes
+    if (entry->file_type == TYPE_FILE && !unshare_file(fp, parent, sup, slot, entry)) return 0;
+
+    long old_pos = ftell(fp);
+
+    if (entry->file_type == TYPE_PACKED) {
+        // Empacotado: copia os dados para o novo lugar (outro trecho empacotado ou extent próprio)
+        unsigned keep = (old_size < new_size) ? old_size : new_size;  // Empacotados são pequenos
+        char *data = malloc(keep ? keep : 1);
+        if (!data) {
+            fseek(fp, old_pos, SEEK_SET);
+            return 0;
+        }
+        fseek(fp, entry_data_pos(entry, real_block_size), SEEK_SET);
+        fread(data, 1, keep, fp);
+
+        struct dir_entry moved = *entry;
+        int ok;
+        if (pack_eligible(new_size, real_block_size)) {
+            unsigned pack_block, pack_offset;
+            ok = pack_alloc(fp, sup, new_size, &pack_block, &pack_offset);
+            moved.start_block = pack_block;
+            moved.length = pack_offset;
+        } else {
+            long int new_start = contiguous_alloc_near(fp, new_size, real_block_size,
+                                                       sup->bitmap_start, sup->total_blocks,
+                                                       parent->start_block);
+            ok = (new_start != -1);
+            moved.file_type = TYPE_FILE;
+            moved.start_block = (unsigned)new_start;
+        }
+        if (!ok) {
+            printf("Erro: Espaço insuficiente para crescer '%s' para %" PRIu64 " bytes.\n",
+                   entry->file_name, new_size);
+            free(data);
+            fseek(fp, old_pos, SEEK_SET);
+            return 0;
+        }
+
+        if (keep > 0) {
+            fseek(fp, entry_data_pos(&moved, real_block_size), SEEK_SET);
+            fwrite(data, 1, keep, fp);
+        }
+        free(data);
+        pack_free(fp, sup, entry->start_block, entry->length, old_size);
+        *entry = moved;
+    } else if (new_blocks > old_blocks) {
+        unsigned extra = new_blocks - old_blocks;
+
+        if (bitmap_range_is_free(fp, entry->start_block + old_blocks, extra, sup->bitmap_start,
+                                 real_block_size, sup->total_blocks)) {
+            // Crescimento no lugar: só marca os blocos seguintes
+            bitmap_set_range(fp, entry->start_block + old_blocks, extra, 1, sup->bitmap_start, real_block_size);
+        } else {
+            // Realoca o extent inteiro e copia os dados válidos
+            long int new_start = contiguous_alloc_near(fp, new_size, real_block_size,
+                                                       sup->bitmap_start, sup->total_blocks,
+                                                       parent->start_block);
+            if (new_start == -1) {
+                printf("Erro: Espaço insuficiente para crescer '%s' para %" PRIu64 " bytes.\n",
+                       entry->file_name, new_size);
+                fseek(fp, old_pos, SEEK_SET);
+                return 0;
+            }
+
+            if (!copy_range(fp, (unsigned long)entry->start_block * real_block_size,
+                            (unsigned long)new_start * real_block_size, old_size, real_block_size)) {
+                contiguous_dealloc(fp, new_start, new_blocks, sup->bitmap_start,
+                                   real_block_size, sup->data_start);
+                fseek(fp, old_pos, SEEK_SET);
+                return 0;
+            }
+
+            contiguous_dealloc(fp, entry->start_block, old_blocks, sup->bitmap_start,
+                               real_block_size, sup->data_start);
+            printf("Arquivo '%s' realocado do bloco %" PRIu64 " para o bloco %ld.\n",
+                   entry->file_name, entry->start_block, new_start);
+            entry->start_block = (unsigned)new_start;
+        }
+    } else if (new_blocks < old_blocks) {
+        // Libera a cauda do extent
+        contiguous_dealloc(fp, entry->start_block + new_blocks, old_blocks - new_blocks,
+                           sup->bitmap_start, real_block_size, sup->data_start);
+    }
+
+    if (zero_new && new_size > old_size) {
+        zero_fill(fp, entry_data_pos(entry, real_block_size) + old_size,
+                  new_size - old_size, real_block_size);
+    }
+
+    // Grava a entrada atualizada no pai (em empacotados, length continua sendo o deslocamento)
+    entry->size = new_size;
+    if (entry->file_type != TYPE_PACKED) {
+        entry->length = (new_size + real_block_size - 1) / real_block_size;
+    }
+    fseek(fp, (unsigned long)parent->start_block * real_block_size + (unsigned long)slot * ENTRY_SIZE, SEEK_SET);
+    write_entry(fp, entry);
+
+    int64_t delta = (int64_t)(new_size - old_size);
+    update_hierarchy_size(fp, parent->start_block, delta, real_block_size);
+    parent->size += delta;
+
+    fseek(fp, old_pos, SEEK_SET);
+    return 1;
+}
+
+// Anexa 'size' bytes ao fim do arquivo. data == NULL anexa zeros
+static int append_file_impl(FILE *fp, struct dir_entry *parent, struct superblock *sup,
+                            char *name, const char *data, uint64_t size) {
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    struct dir_entry entry;
+
+    int slot = find_entry(fp, parent, name, real_block_size, &entry);
+    if (slot == -1) {
+        printf("Erro: Arquivo '%s' nao encontrado.\n", name);
+        return 0;
+    }
+    if (!is_regular_file(&entry)) {
+        printf("Erro: '%s' nao e um arquivo.\n", name);
+        return 0;
+    }
+    if (size == 0) return 1;
+    if (entry.size + size < entry.size) {
+        printf("Erro: Tamanho maximo de arquivo excedido.\n");
+        return 0;
+    }
+
+    uint64_t old_size = entry.size;
+    if (!resize_file(fp, parent, sup, slot, &entry, old_size + size, data == NULL)) return 0;
+
+    if (data != NULL) {
+        long old_pos = ftell(fp);
+        fseek(fp, entry_data_pos(&entry, real_block_size) + old_size, SEEK_SET);
+        fwrite(data, 1, size, fp);
+        fseek(fp, old_pos, SEEK_SET);
+    }
+    return 1;
+}
+
+// Ajusta o tamanho do arquivo para new_size (crescimento preenchido com zeros)
+static int truncate_file_impl(FILE *fp, struct dir_entry *parent, struct superblock *sup,
+                              char *name, uint64_t new_size) {
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    struct dir_entry entry;
+
+    int slot = find_entry(fp, parent, name, real_block_size, &entry);
+    if (slot == -1) {
+        printf("Erro: Arquivo '%s' nao encontrado.\n", name);
+        return 0;
+    }
+    if (!is_regular_file(&entry)) {
+        printf("Erro: '%s' nao e um arquivo.\n", name);
+        return 0;
+    }
+    if (new_size == entry.size) return 1;
+
+    return resize_file(fp, parent, sup, slot, &entry, new_size, 1);
+}
+
+// --- HANDLES DE ARQUIVO (ACESSO ALEATÓRIO) ---
+// sacs_open resolve a entrada uma única vez e guarda o slot; cada leitura ou escrita relê
+// só essa entrada (sem nova busca no diretório), então vê realocações feitas por outro handle.
+
+struct sacs_handle {
+    int in_use;
+    FILE *fp;
+    struct superblock *sup;
+    struct dir_entry *dir;    // Diretório pai do chamador: recebe as mudanças de tamanho
+    int slot;                 // Índice da entrada no diretório
+    struct dir_entry entry;   // Entrada lida no último acesso
+    struct prefetch_stream ra;   // Leitura antecipada das leituras em sequência
+};
+
+// O extent muda quando o arquivo cresce ou é realocado
+static void handle_prefetch_begin(struct sacs_handle *hd) {
+    unsigned real_block_size = (1 << hd->sup->sector_size) << hd->sup->block_size;
+    unsigned long pos = entry_data_pos(&hd->entry, real_block_size);
+    prefetch_begin(&hd->ra, volume_fd(hd->fp), pos, pos + hd->entry.size);
+}
+
+static struct sacs_handle handle_table[SACS_MAX_HANDLES];
+
+static struct sacs_handle *get_handle(int h) {
+    if (h < 0 || h >= SACS_MAX_HANDLES || !handle_table[h].in_use) {
+        printf("Erro: Handle %d invalido.\n", h);
+        return NULL;
+    }
+    return &handle_table[h];
+}
+
+// Relê a entrada do slot do pai. Falha se o arquivo foi removido ou renomeado desde o open
+static int handle_refresh(struct sacs_handle *hd) {
+    unsigned real_block_size = (1 << hd->sup->sector_size) << hd->sup->block_size;
+    struct dir_entry entry;
+    dir_follow(hd->dir);
+    long old_pos = ftell(hd->fp);
+    fseek(hd->fp, dir_slot_pos(geom_for(real_block_size), hd->dir->start_block, hd->slot), SEEK_SET);
+    int ok = read_entry(hd->fp, &entry);
+    fseek(hd->fp, old_pos, SEEK_SET);
+
+    if (!ok || entry.status != STATUS_VALID || !is_regular_file(&entry) ||
+        strcmp(entry.file_name, hd->entry.file_name) != 0) {
+        printf("Erro: Arquivo '%s' nao existe mais.\n", hd->entry.file_name);
+        return 0;
+    }
+    hd->entry = entry;
+    unsigned long pos = entry_data_pos(&hd->entry, real_block_size);
+    if (pos != hd->ra.start || pos + hd->entry.size != hd->ra.end) handle_prefetch_begin(hd);
+    return 1;
+}
+
+// Retorna um handle >= 0, ou -1 em caso de erro. 'parent' deve continuar válido até sacs_close
+int sacs_open(FILE *fp, struct dir_entry *parent, struct superblock *sup, char *name) {
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    struct dir_entry entry;
+
+    int slot = find_entry(fp, parent, name, real_block_size, &entry);
+    if (slot == -1) {
+        printf("Erro: Arquivo '%s' nao encontrado.\n", name);
+        return -1;
+    }
+    if (!is_regular_file(&entry)) {
+        printf("Erro: '%s' nao e um arquivo.\n", name);
+        return -1;
+    }
+
+    for (int h = 0; h < SACS_MAX_HANDLES; h++) {
+        if (!handle_table[h].in_use) {
+            handle_table[h].in_use = 1;
+            handle_table[h].fp = fp;
+            handle_table[h].sup = sup;
+            handle_table[h].dir = parent;
+            handle_table[h].slot = slot;
+            handle_table[h].entry = entry;
+            handle_prefetch_begin(&handle_table[h]);
+            return h;
+        }
+    }
+
+    printf("Erro: Tabela de handles cheia (%d abertos).\n", SACS_MAX_HANDLES);
+    return -1;
+}
+
+// Lê até count bytes a partir de offset. Retorna bytes lidos (0 no fim do arquivo) ou -1
+long sacs_pread(int h, void *buf, unsigned long count, unsigned long offset) {
+    struct sacs_handle *hd = get_handle(h);
+    if (!hd || !handle_refresh(hd)) return -1;
+
+    if (offset >= hd->entry.size) return 0;
+    if (count > hd->entry.size - offset) count = hd->entry.size - offset;
+
+    unsigned real_block_size = (1 << hd->sup->sector_size) << hd->sup->block_size;
+    unsigned long pos = entry_data_pos(&hd->entry, real_block_size) + offset;
+    prefetch_access(&hd->ra, pos, count);
+    long old_pos = ftell(hd->fp);
+    fseek(hd->fp, pos, SEEK_SET);
+    size_t n = fread(buf, 1, count, hd->fp);
+    fseek(hd->fp, old_pos, SEEK_SET);
+    return (long)n;
+}
+
+// Escreve count bytes em offset. Escritas além do fim crescem o arquivo (lacunas viram zeros)
+long sacs_pwrite(int h, const void *buf, unsigned long count, unsigned long offset) {
+    struct sacs_handle *hd = get_handle(h);
+    if (!hd) return -1;
+    if (count == 0) return 0;
+    // O pai primeiro: a cópia dele é que dá ao arquivo a referência extra vista por unshare_file
+    if (!check_writable() || !dir_unshare(hd->fp, hd->sup, hd->dir) || !handle_refresh(hd)) return -1;
+    if (!unshare_file(hd->fp, hd->dir, hd->sup, hd->slot, &hd->entry)) return -1;
+
+    if (offset + count > hd->entry.size) {
+        if (!resize_file(hd->fp, hd->dir, hd->sup, hd->slot, &hd->entry,
+                         offset + count, 1)) return -1;
+    }
+
+    // unshare_file e resize_file podem ter movido ou crescido o extent
+    unsigned real_block_size = (1 << hd->sup->sector_size) << hd->sup->block_size;
+    unsigned long data_pos = entry_data_pos(&hd->entry, real_block_size);
+    if (data_pos != hd->ra.start || data_pos + hd->entry.size != hd->ra.end) handle_prefetch_begin(hd);
+
+    long old_pos = ftell(hd->fp);
+    fseek(hd->fp, data_pos + offset, SEEK_SET);
+    size_t n = fwrite(buf, 1, count, hd->fp);
+    fseek(hd->fp, old_pos, SEEK_SET);
+    return (long)n;
+}
+
+// Tamanho atual do arquivo aberto
+long sacs_size(int h) {
+    struct sacs_handle *hd = get_handle(h);
+    return (hd && handle_refresh(hd)) ? (long)hd->entry.size : -1;
+}
+
+int sacs_close(int h) {
+    struct sacs_handle *hd = get_handle(h);
+    if (!hd) return 0;
+    fflush(hd->fp);
+    memset(hd, 0, sizeof(*hd));
+    return 1;
+}
+
+// --- REMOÇÃO RECURSIVA (rm -r) ---
+// Os extents da subárvore são coletados, ordenados e fundidos; o bitmap é limpo numa
+// única passada por bloco de bitmap e a hierarquia recebe um único delta.
+
+struct extent {
+    unsigned start;
+    unsigned len;
+};
+
+struct extent_list {
+    struct extent *items;
+    unsigned count;
+    unsigned cap;
+};
+
+static int extent_push(struct extent_list *list, unsigned start, unsigned len) {
+    if (len == 0) return 1;
+    if (list->count == list->cap) {
+        unsigned cap = list->cap ? list->cap * 2 : 256;
+        struct extent *items = realloc(list->items, cap * sizeof(struct extent));
+        if (!items) return 0;
+        list->items = items;
+        list->cap = cap;
+    }
+    list->items[list->count].start = start;
+    list->items[list->count].len = len;
+    list->count++;
+    return 1;
+}
+
+// Reserva espaço para 'count' extents: os push seguintes não falham
+static int extent_reserve(struct extent_list *list, unsigned count) {
+    if (count <= list->cap) return 1;
+    struct extent *items = realloc(list->items, count * sizeof(struct extent));
+    if (!items) return 0;
+    list->items = items;
+    list->cap = count;
+    return 1;
+}
+
+// Arquivos da subárvore: só são soltos depois que a coleta inteira deu certo
+struct leaf_list {
+    struct dir_entry *items;
+    unsigned count;
+    unsigned cap;
+};
+
+static int leaf_push(struct leaf_list *list, struct dir_entry *entry) {
+    if (list->count == list->cap) {
+        unsigned cap = list->cap ? list->cap * 2 : 64;
+        struct dir_entry *items = realloc(list->items, cap * sizeof(struct dir_entry));
+        if (!items) return 0;
+        list->items = items;
+        list->cap = cap;
+    }
+    list->items[list->count++] = *entry;
+    return 1;
+}
+
+static int extent_cmp(const void *a, const void *b) {
+    const struct extent *x = a, *y = b;
+    return (x->start > y->start) - (x->start < y->start);
+}
+
+// Ordena e funde extents adjacentes ou sobrepostos
+static void extent_coalesce(struct extent_list *list) {
+    if (list->count < 2) return;
+    qsort(list->items, list->count, sizeof(struct extent), extent_cmp);
+
+    unsigned out = 0;
+    for (unsigned i = 1; i < list->count; i++) {
+        struct extent *last = &list->items[out];
+        struct extent *cur = &list->items[i];
+        if (cur->start <= last->start + last->len) {
+            unsigned end = cur->start + cur->len;
+            if (end > last->start + last->len) last->len = end - last->start;
+        } else {
+            list->items[++out] = *cur;
+        }
+    }
+    list->count = out + 1;
+}
+
+static void bitmap_write_chunk(FILE *fp, unsigned long c, unsigned char *chunk,
+                               unsigned bitmap_start, unsigned real_block_size) {
+    fseek(fp, (unsigned long)bitmap_start * real_block_size + c * real_block_size, SEEK_SET);
+    fwrite(chunk, 1, real_block_size, fp);
+    summary_update(fp, c, chunk, bitmap_start, real_block_size);
+}
+
+// Libera extents já ordenados: cada bloco de bitmap é lido e gravado uma única vez
+static void bitmap_clear_extents(FILE *fp, struct extent_list *list, unsigned bitmap_start,
+                                 unsigned real_block_size) {
+    unsigned bits_per_chunk = real_block_size * 8;
+    unsigned char *chunk = malloc(real_block_size);
+    if (!chunk) {
+        printf("Erro de memória no bitmap.\n");
+        return;
+    }
+    long loaded = -1;
+
+    for (unsigned i = 0; i < list->count; i++) {
+        struct extent *e = &list->items[i];
+        unsigned end = e->start + e->len;
+
+        for (unsigned b = e->start; b < end; ) {
+            long c = b / bits_per_chunk;
+            if (c != loaded) {
+                if (loaded != -1) bitmap_write_chunk(fp, loaded, chunk, bitmap_start, real_block_size);
+                fseek(fp, (unsigned long)bitmap_start * real_block_size + (unsigned long)c * real_block_size, SEEK_SET);
+                memset(chunk, 0, real_block_size);
+                fread(chunk, 1, real_block_size, fp);
+                loaded = c;
+            }
+            unsigned stop = (unsigned)(c + 1) * bits_per_chunk;
+            if (stop > end) stop = end;
+            for (; b < stop; b++) unset_bit(chunk, b % bits_per_chunk);
+        }
+        if (seg_ready) seg_give(e->start, e->len);
+    }
+    if (loaded != -1) bitmap_write_chunk(fp, loaded, chunk, bitmap_start, real_block_size);
+    free(chunk);
+}
+
+// Coleta os extents do diretório em (block, length) e de tudo abaixo dele; arquivos e
+// subdiretórios ainda compartilhados com um snapshot vão para 'leaves' sem mexer em nada
+// no disco. Retorna a quantidade de itens encontrados, ou -1 se faltou memória.
+static long collect_tree(FILE *fp, struct superblock *sup, uint64_t block, uint64_t length,
+                         struct extent_list *list, struct leaf_list *leaves) {
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    unsigned max_entries = (length * real_block_size) / ENTRY_SIZE;
+    long items = 0;
+    struct dir_entry entry;
+
+    for (unsigned i = 0; i < max_entries; i++) {
+        fseek(fp, (unsigned long)block * real_block_size + (unsigned long)i * ENTRY_SIZE, SEEK_SET);
+        if (!read_entry(fp, &entry)) break;
+        if (entry.status != STATUS_VALID) continue;
+        if (strcmp(entry.file_name, ".") == 0 || strcmp(entry.file_name, "..") == 0) continue;
+
+        if (entry.file_type == TYPE_DIR && !refcount_get(fp, sup, entry.start_block)) {
+            long sub = collect_tree(fp, sup, entry.start_block, entry.length, list, leaves);
+            if (sub < 0 || !extent_push(list, entry.start_block, entry.length)) return -1;
+            items += sub;
+        } else if (entry.file_type == TYPE_DIR || is_regular_file(&entry)) {
+            if (!leaf_push(leaves, &entry)) return -1;
+        }
+        items++;
+    }
+    return items;
+}
+
+static int delete_tree_impl(FILE *fp, struct dir_entry *parent, struct superblock *sup, char *name) {
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    struct dir_entry entry;
+
+    if (!dir_unshare(fp, sup, parent)) return 0;
+    int slot = find_entry(fp, parent, name, real_block_size, &entry);
+    if (slot == -1) {
+        printf("Erro: Arquivo '%s' não encontrado.\n", name);
+        return 0;
+    }
+    // Arquivos e diretórios vazios seguem o caminho normal
+    if (entry.file_type != TYPE_DIR || entry.size <= (uint64_t)ENTRY_SIZE * 2) {
+        return delete_item_impl(fp, parent, sup, name);
+    }
+    if (strcmp(entry.file_name, ".") == 0 || strcmp(entry.file_name, "..") == 0) {
+        printf("Erro: Não é possível deletar '.' ou '..'.\n");
+        return 0;
+    }
+    if (entry.start_block == sup->root_start) {
+        printf("ERRO CRÍTICO: Não é possível deletar o Diretório Raiz.\n");
+        return 0;
+    }
+
+    long old_pos = ftell(fp);
+    struct extent_list list = { NULL, 0, 0 };
+    struct leaf_list leaves = { NULL, 0, 0 };
+
+    // Subárvore ainda compartilhada com um snapshot: só perde a referência, como um arquivo
+    int shared = refcount_get(fp, sup, entry.start_block) != 0;
+    long items = shared ? (leaf_push(&leaves, &entry) ? 0 : -1)
+                        : collect_tree(fp, sup, entry.start_block, entry.length, &list, &leaves);
+    if (items < 0 || (!shared && !extent_push(&list, entry.start_block, entry.length)) ||
+        !extent_reserve(&list, list.count + leaves.count)) {
+        printf("Erro fatal de memória RAM.\n");
+        free(list.items);
+        free(leaves.items);
+        fseek(fp, old_pos, SEEK_SET);
+        return 0;
+    }
+
+    // Daqui em diante nada falha: arquivos e diretórios compartilhados com um snapshot só
+    // perdem uma referência e unidades empacotadas voltam ao bloco de empacotamento
+    for (unsigned i = 0; i < leaves.count; i++) {
+        struct dir_entry *leaf = &leaves.items[i];
+        if (leaf->file_type == TYPE_PACKED) {
+            pack_free(fp, sup, leaf->start_block, leaf->length, leaf->size);
+        } else if (!refcount_release(fp, sup, leaf->start_block)) {
+            extent_push(&list, leaf->start_block, file_alloc_blocks(leaf));
+        }
+    }
+    free(leaves.items);
+    extent_coalesce(&list);
+
+    // Nunca toca em metadados nem passa do fim do disco
+    unsigned valid = 0;
+    for (unsigned i = 0; i < list.count; i++) {
+        struct extent *e = &list.items[i];
+        if (e->start < sup->data_start || (uint64_t)e->start + e->len > sup->total_blocks) {
+            printf("ERRO CRÍTICO: Extent invalido (%u, %u) ignorado.\n", e->start, e->len);
+            continue;
+        }
+        list.items[valid++] = *e;
+    }
+    list.count = valid;
+
+    bitmap_clear_extents(fp, &list, sup->bitmap_start, real_block_size);
+
+    entry.status = STATUS_FREE;
+    fseek(fp, (unsigned long)parent->start_block * real_block_size + (unsigned long)slot * ENTRY_SIZE, SEEK_SET);
+    write_entry(fp, &entry);
+    slot_hint_freed(parent->start_block, (uint64_t)slot);
+    fflush(fp);
+
+    update_hierarchy_size(fp, parent->start_block, -(int64_t)entry.size, real_block_size);
+    if (parent->size >= entry.size) parent->size -= entry.size;
+    else parent->size = 0;
+
+    printf("Sucesso: '%s' removido (%ld itens, %u extents liberados).\n", name, items + 1, list.count);
+    free(list.items);
+    fseek(fp, old_pos, SEEK_SET);
+    return 1;
+}
+
+// --- MOVER E COPIAR (mv/cp) ---
+// Mover só reescreve entradas: a entrada vai para o novo pai, o ".." de um diretório
+// passa a apontar para ele e os tamanhos são corrigidos nas duas cadeias de ancestrais.
+// Copiar duplica o extent dentro da própria imagem, sem passar pelo hospedeiro.
+
+// Entra no subdiretório 'name' de 'dir' (sem mensagens)
+static int enter_dir(FILE *fp, struct dir_entry *dir, char *name, unsigned real_block_size) {
+    struct dir_entry entry;
+    if (find_entry(fp, dir, name, real_block_size, &entry) < 0 || entry.file_type != TYPE_DIR) return 0;
+
+    long old_pos = ftell(fp);
+    fseek(fp, (unsigned long)entry.start_block * real_block_size, SEEK_SET);
+    read_entry(fp, dir);
+    fseek(fp, old_pos, SEEK_SET);
+    if (strcmp(name, ".") != 0 && strcmp(name, "..") != 0) strncpy(dir->file_name, name, 16);
+    return 1;
+}
+
+int resolve_path(FILE *fp, struct dir_entry *cwd, struct superblock *sup, const char *path,
+                 struct dir_entry *dir, char *name) {
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    char copy[SACS_PATH_MAX];
+    if (strlen(path) >= sizeof(copy)) {
+        printf("Erro: Caminho muito longo.\n");
+        return 0;
+    }
+    strcpy(copy, path);
+
+    if (path[0] == '/') {
+        long old_pos = ftell(fp);
+        fseek(fp, (unsigned long)sup->root_start * real_block_size, SEEK_SET);
+        read_entry(fp, dir);
+        fseek(fp, old_pos, SEEK_SET);
+        strcpy(dir->file_name, "/");
+    } else {
+        *dir = *cwd;
+    }
+    name[0] = '\0';
+
+    char *save = NULL;
+    char *part = strtok_r(copy, "/", &save);
+    while (part) {
+        char *next = strtok_r(NULL, "/", &save);
+        if (strlen(part) > 16) {
+            printf("Erro: Nome '%s' muito longo (max 16).\n", part);
+            return 0;
+        }
+        if (!next) {
+            strcpy(name, part);
+            break;
+        }
+        if (!enter_dir(fp, dir, part, real_block_size)) {
+            printf("Erro: Diretorio '%s' nao encontrado em '%s'.\n", part, path);
+            return 0;
+        }
+        part = next;
+    }
+    return 1;
+}
+
+// Resolve o destino de mv/cp: um diretório existente recebe o item com o nome original
+static int resolve_target(FILE *fp, struct dir_entry *cwd, struct superblock *sup, char *dst_path,
+                          const char *src_name, struct dir_entry *dir, char *name) {
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    if (!resolve_path(fp, cwd, sup, dst_path, dir, name)) return 0;
+
+    struct dir_entry existing;
+    if (name[0] == '\0' || strcmp(name, ".") == 0 || strcmp(name, "..") == 0 ||
+        (find_entry(fp, dir, name, real_block_size, &existing) >= 0 && existing.file_type == TYPE_DIR)) {
+        if (name[0] != '\0') enter_dir(fp, dir, name, real_block_size);
+        strcpy(name, src_name);
+    }
+    return 1;
+}
+
+// Relê o "." do diretório corrente do chamador, que pode ter mudado de tamanho
+static void reload_dir(FILE *fp, struct dir_entry *dir, unsigned real_block_size) {
+    char dir_name[17];
+    memcpy(dir_name, dir->file_name, sizeof(dir_name));
+    dir_follow(dir);
+    long old_pos = ftell(fp);
+    fseek(fp, (unsigned long)dir->start_block * real_block_size, SEEK_SET);
+    read_entry(fp, dir);
+    fseek(fp, old_pos, SEEK_SET);
+    memcpy(dir->file_name, dir_name, sizeof(dir_name));
+}
+
+static int move_item_impl(FILE *fp, struct dir_entry *cwd, struct superblock *sup, char *src_path, char *dst_path) {
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    struct dir_entry src_dir, dst_dir, entry;
+    char src_name[17], dst_name[17];
+
+    if (!resolve_path(fp, cwd, sup, src_path, &src_dir, src_name)) return 0;
+    int slot = find_entry(fp, &src_dir, src_name, real_block_size, &entry);
+    if (slot < 0) {
+        printf("Erro: '%s' nao encontrado.\n", src_path);
+        return 0;
+    }
+    if (strcmp(src_name, ".") == 0 || strcmp(src_name, "..") == 0 || entry.start_block == sup->root_start) {
+        printf("Erro: Nao e possivel mover '%s'.\n", src_path);
+        return 0;
+    }
+    if (!resolve_target(fp, cwd, sup, dst_path, src_name, &dst_dir, dst_name)) return 0;
+
+    // Os dois pais e o diretório movido (cujo ".." muda) deixam de ser compartilhados;
+    // depois disso a subida pelos ".." abaixo só passa por diretórios exclusivos
+    if (!dir_unshare(fp, sup, &src_dir) || !dir_unshare(fp, sup, &dst_dir) ||
+        (entry.file_type == TYPE_DIR && !dir_unshare(fp, sup, &entry))) return 0;
+    dir_follow(&src_dir);
+
+    if (dst_dir.start_block == src_dir.start_block && strcmp(dst_name, src_name) == 0) return 1;
+    long dst_slot = dir_reserve_slot(fp, &dst_dir, dst_name, real_block_size);
+    if (dst_slot == DIR_DUPLICATE) {
+        printf("Erro: '%s' ja existe no destino.\n", dst_name);
+        return 0;
+    }
+
+    // Um diretório não pode ir para dentro de si mesmo
+    if (entry.file_type == TYPE_DIR) {
+        uint64_t block = dst_dir.start_block;
+        while (1) {
+            if (block == entry.start_block) {
+                printf("Erro: Nao e possivel mover '%s' para dentro dele mesmo.\n", src_path);
+                return 0;
+            }
+            struct dir_entry dotdot;
+            fseek(fp, (unsigned long)block * real_block_size + ENTRY_SIZE, SEEK_SET);
+            read_entry(fp, &dotdot);
+            if (dotdot.start_block == block) break;
+            block = dotdot.start_block;
+        }
+    }
+
+    long old_pos = ftell(fp);
+    unsigned long src_slot_pos = (unsigned long)src_dir.start_block * real_block_size + (unsigned long)slot * ENTRY_SIZE;
+    struct dir_entry moved = entry;
+    memset(moved.file_name, 0, sizeof(moved.file_name));
+    strncpy(moved.file_name, dst_name, 16);
+
+    // Renomear no mesmo diretório: só o nome muda
+    if (dst_dir.start_block == src_dir.start_block) {
+        fseek(fp, src_slot_pos, SEEK_SET);
+        write_entry(fp, &moved);
+        fflush(fp);
+        fseek(fp, old_pos, SEEK_SET);
+        printf("'%s' renomeado para '%s'.\n", src_name, dst_name);
+        return 1;
+    }
+
+    if (dst_slot == DIR_FULL) {
+        printf("Erro: Diretorio de destino cheio.\n");
+        fseek(fp, old_pos, SEEK_SET);
+        return 0;
+    }
+    dir_write_slot(fp, &dst_dir, dst_slot, &moved, real_block_size);
+    entry.status = STATUS_FREE;
+    fseek(fp, src_slot_pos, SEEK_SET);
+    write_entry(fp, &entry);
+    slot_hint_freed(src_dir.start_block, (uint64_t)slot);
+
+    if (moved.file_type == TYPE_DIR) {
+        struct dir_entry dotdot;
+        unsigned long dotdot_pos = (unsigned long)moved.start_block * real_block_size + ENTRY_SIZE;
+        fseek(fp, dotdot_pos, SEEK_SET);
+        read_entry(fp, &dotdot);
+        dotdot.start_block = dst_dir.start_block;
+        dotdot.size = dst_dir.size;
+        fseek(fp, dotdot_pos, SEEK_SET);
+        write_entry(fp, &dotdot);
+    }
+
+    // O ancestral comum recebe -size e +size: fica igual
+    update_hierarchy_size(fp, src_dir.start_block, -(int64_t)moved.size, real_block_size);
+    update_hierarchy_size(fp, dst_dir.start_block, (int64_t)moved.size, real_block_size);
+    fflush(fp);
+    reload_dir(fp, cwd, real_block_size);
+    fseek(fp, old_pos, SEEK_SET);
+
+    printf("'%s' movido para '%s'.\n", src_path, dst_path);
+    return 1;
+}
+
+// Duplica len bytes dentro da imagem. Numa imagem simples usa copy_file_range: o kernel
+// copia sem passar pelo processo (e em XFS/btrfs pode apenas compartilhar os blocos)
+static int image_copy(FILE *fp, unsigned long src_pos, unsigned long dst_pos, unsigned long len,
+                      unsigned real_block_size) {
+    if (!stripe_is(fp) && fileno(fp) >= 0) {
+        fflush(fp);
+        loff_t in = (loff_t)src_pos, out = (loff_t)dst_pos;
+        while (len > 0) {
+            ssize_t n = copy_file_range(fileno(fp), &in, fileno(fp), &out, len, 0);
+            if (n <= 0) break;
+            len -= (unsigned long)n;
+        }
+        if (len == 0) return 1;
+        src_pos = (unsigned long)in;
+        dst_pos = (unsigned long)out;
+    }
+    return copy_range(fp, src_pos, dst_pos, len, real_block_size);
+}
+
+static int copy_file_impl(FILE *fp, struct dir_entry *cwd, struct superblock *sup, char *src_path, char *dst_path) {
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    struct dir_entry src_dir, dst_dir, entry, copy;
+    char src_name[17], dst_name[17];
+
+    if (!resolve_path(fp, cwd, sup, src_path, &src_dir, src_name)) return 0;
+    if (find_entry(fp, &src_dir, src_name, real_block_size, &entry) < 0) {
+        printf("Erro: '%s' nao encontrado.\n", src_path);
+        return 0;
+    }
+    if (!is_regular_file(&entry)) {
+        printf("Erro: '%s' e um diretorio.\n", src_path);
+        return 0;
+    }
+    if (!resolve_target(fp, cwd, sup, dst_path, src_name, &dst_dir, dst_name)) return 0;
+
+    long old_pos = ftell(fp);
+    if (!create_file_impl(fp, &dst_dir, sup, dst_name, entry.size, NULL)) return 0;
+    find_entry(fp, &dst_dir, dst_name, real_block_size, &copy);
+
+    if (entry.size > 0 && !image_copy(fp, entry_data_pos(&entry, real_block_size),
+                                      entry_data_pos(&copy, real_block_size), entry.size, real_block_size)) {
+        printf("Erro: Falha ao copiar os dados. Revertendo...\n");
+        delete_item_impl(fp, &dst_dir, sup, dst_name);
+        fseek(fp, old_pos, SEEK_SET);
+        return 0;
+    }
+    fflush(fp);
+    reload_dir(fp, cwd, real_block_size);
+    fseek(fp, old_pos, SEEK_SET);
+    return 1;
+}
+
+// --- IMPORTAÇÃO EM FLUXO (pipes, stdin) ---
+// O tamanho não é conhecido de antemão: o extent é reservado de forma especulativa e
+// cresce (dobrando) conforme os dados chegam, primeiro no lugar e, se o vizinho estiver
+// ocupado, realocando. No fim a cauda não usada volta para o bitmap e só então a entrada
+// é gravada e a hierarquia atualizada, uma única vez.
+
+// Lê até 'count' bytes do descritor (menos só no fim do fluxo). Retorna -1 em erro
+static long stream_fill(int fd, unsigned char *buffer, unsigned long count) {
+    unsigned long got = 0;
+    while (got < count) {
+        ssize_t n = read(fd, buffer + got, count - got);
+        if (n == 0) break;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        got += (unsigned long)n;
+    }
+    return (long)got;
+}
+
+// Garante espaço para 'needed' blocos no extent [*start, *start + *reserved).
+// Retorna 0 se o disco está cheio
+static int stream_grow(FILE *fp, struct superblock *sup, struct dir_entry *parent, long *start,
+                       unsigned *reserved, unsigned needed, uint64_t written, struct stream_stats *st) {
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    unsigned max_step = STREAM_PREALLOC_MAX / real_block_size;
+    unsigned step = (*reserved < max_step) ? *reserved : max_step;
+    unsigned want = *reserved + step;
+    if (want < needed) want = needed;
+
+    // Pedido especulativo primeiro; se não couber, só o necessário
+    unsigned targets[2] = { want, needed };
+    for (int i = 0; i < 2; i++) {
+        unsigned target = targets[i];
+        if (i == 1 && target == want) break;
+        if (bitmap_range_is_free(fp, *start + *reserved, target - *reserved, sup->bitmap_start,
+                                 real_block_size, sup->total_blocks)) {
+            bitmap_set_range(fp, *start + *reserved, target - *reserved, 1, sup->bitmap_start, real_block_size);
+            *reserved = target;
+            st->grown_in_place++;
+            return 1;
+        }
+
+        long new_start = contiguous_alloc_near(fp, (uint64_t)target * real_block_size, real_block_size,
+                                               sup->bitmap_start, sup->total_blocks, parent->start_block);
+        if (new_start == -1) continue;
+        if (written > 0 && !image_copy(fp, (unsigned long)*start * real_block_size,
+                                       (unsigned long)new_start * real_block_size, written, real_block_size)) {
+            contiguous_dealloc(fp, new_start, target, sup->bitmap_start, real_block_size, sup->data_start);
+            return 0;
+        }
+        contiguous_dealloc(fp, *start, *reserved, sup->bitmap_start, real_block_size, sup->data_start);
+        st->relocations++;
+        st->relocated_bytes += written;
+        *start = new_start;
+        *reserved = target;
+        return 1;
+    }
+    return 0;
+}
+
+static int import_stream_impl(FILE *fp, struct dir_entry *parent, struct superblock *sup, int fd,
+                              char *name, struct stream_stats *st) {
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    memset(st, 0, sizeof(*st));
+
+    if (strlen(name) > 16) {
+        printf("Erro: Nome '%s' muito longo (max 16).\n", name);
+        return 0;
+    }
+    if (!dir_unshare(fp, sup, parent)) return 0;
+    // A entrada é reservada antes de consumir o fluxo: nada é lido se o nome já existe
+    long slot = dir_reserve_slot(fp, parent, name, real_block_size);
+    if (slot == DIR_DUPLICATE) {
+        printf("Erro: O arquivo '%s' ja existe na pasta de destino.\n", name);
+        return 0;
+    }
+    if (slot == DIR_FULL) {
+        printf("Erro: Diretório cheio (limite de arquivos atingido).\n");
+        return 0;
+    }
+
+    unsigned long chunk = STREAM_CHUNK - STREAM_CHUNK % real_block_size;
+    if (chunk < real_block_size) chunk = real_block_size;
+    unsigned char *buffer = malloc(chunk);
+    if (!buffer) {
+        printf("Erro fatal de memória RAM.\n");
+        return 0;
+    }
+
+    long got = stream_fill(fd, buffer, chunk);
+    if (got < 0) {
+        printf("Erro: Falha ao ler o fluxo de entrada.\n");
+        free(buffer);
+        return 0;
+    }
+
+    // Fluxo curto: cabe inteiro no buffer e segue o caminho normal (inclusive empacotamento)
+    if ((unsigned long)got < chunk) {
+        int ok = create_file_slot(fp, parent, sup, name, (uint64_t)got, (char *)buffer, slot);
+        st->bytes = ok ? (uint64_t)got : 0;
+        free(buffer);
+        return ok;
+    }
+
+    long old_pos = ftell(fp);
+    unsigned reserved = STREAM_PREALLOC_MIN / real_block_size;
+    if (reserved < chunk / real_block_size) reserved = chunk / real_block_size;
+    long start = contiguous_alloc_near(fp, (uint64_t)reserved * real_block_size, real_block_size,
+                                       sup->bitmap_start, sup->total_blocks, parent->start_block);
+    if (start == -1) {
+        reserved = chunk / real_block_size;
+        start = contiguous_alloc_near(fp, (uint64_t)reserved * real_block_size, real_block_size,
+                                      sup->bitmap_start, sup->total_blocks, parent->start_block);
+    }
+    if (start == -1) {
+        printf("Erro: Espaço insuficiente no disco para '%s'.\n", name);
+        free(buffer);
+        return 0;
+    }
+
+    printf("Importando fluxo para '%s'...", name);
+    uint64_t written = 0;
+    int ok = 1;
+    while (got > 0) {
+        if (written + (uint64_t)got > max_file_size(sup)) {
+            printf("\nErro: '%s' excede o tamanho maximo de arquivo deste formato.\n", name);
+            ok = 0;
+            break;
+        }
+        unsigned needed = (written + (uint64_t)got + real_block_size - 1) / real_block_size;
+        if (needed > reserved && !stream_grow(fp, sup, parent, &start, &reserved, needed, written, st)) {
+            printf("\nErro: Espaço insuficiente no disco apos %" PRIu64 " bytes.\n", written);
+            ok = 0;
+            break;
+        }
+
+        fseeko(fp, (off_t)start * real_block_size + (off_t)written, SEEK_SET);
+        if (fwrite(buffer, 1, (size_t)got, fp) != (size_t)got) {
+            printf("\nErro: Falha ao gravar na imagem.\n");
+            ok = 0;
+            break;
+        }
+        written += (uint64_t)got;
+
+        got = stream_fill(fd, buffer, chunk);
+        if (got < 0) {
+            printf("\nErro: Falha ao ler o fluxo de entrada.\n");
+            ok = 0;
+        }
+    }
+    free(buffer);
+
+    // Devolve a reserva especulativa que sobrou
+    unsigned used = (written + real_block_size - 1) / real_block_size;
+    if (used == 0) used = 1;
+    if (!ok) used = 0;
+    if (reserved > used) {
+        contiguous_dealloc(fp, start + used, reserved - used, sup->bitmap_start,
+                           real_block_size, sup->data_start);
+        st->trimmed_blocks = reserved - used;
+    }
+    if (!ok) {
+        fseek(fp, old_pos, SEEK_SET);
+        return 0;
+    }
+
+    struct dir_entry new_entry;
+    prepare_dir_entry(&new_entry, name, TYPE_FILE, written, start, real_block_size);
+    dir_write_slot(fp, parent, slot, &new_entry, real_block_size);
+    update_hierarchy_size(fp, parent->start_block, (int64_t)written, real_block_size);
+    parent->size += written;
+    fflush(fp);
+    fseek(fp, old_pos, SEEK_SET);
+
+    st->bytes = written;
+    printf(" Sucesso! (%" PRIu64 " bytes)\n", written);
+    return 1;
+}
+
+void stream_print_stats(const struct stream_stats *st) {
+    printf("Fluxo: %" PRIu64 " bytes, %" PRIu64 " crescimentos no lugar, %" PRIu64 " realocacoes (%" PRIu64 " bytes copiados), "
+           "%" PRIu64 " blocos devolvidos\n", st->bytes, st->grown_in_place, st->relocations,
+           st->relocated_bytes, st->trimmed_blocks);
+}
+
+// --- SNAPSHOTS ---
+// Um snapshot congela a árvore atual sem copiar nada: a raiz ganha uma referência extra na
+// área de refcount e o snapshot aponta para ela. Diretórios são copiados na primeira escrita
+// (dir_unshare) e extents de arquivo também (unshare_file); remoções só soltam a referência.
+// A tabela de snapshots ocupa um bloco (sup->snap_table).
+
+// Lê a tabela de snapshots (um bloco) para 'table'
+static int snapshot_table_read(FILE *fp, struct superblock *sup, unsigned char *table) {
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    if (!sup->snap_table) {
+        memset(table, 0, real_block_size);
+        return 1;
+    }
+    fseek(fp, (unsigned long)sup->snap_table * real_block_size, SEEK_SET);
+    return fread(table, 1, real_block_size, fp) == real_block_size;
+}
+
+// Procura um snapshot pelo nome. Retorna o índice na tabela ou -1
+static int snapshot_find(unsigned char *table, unsigned slots, const char *name, struct snap_entry *out) {
+    for (unsigned i = 0; i < slots; i++) {
+        struct snap_entry snap;
+        memcpy(&snap, table + (unsigned long)i * SNAP_ENTRY_SIZE, sizeof(snap));
+        if (snap.status == STATUS_VALID && strncmp(snap.name, name, 16) == 0) {
+            if (out) *out = snap;
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+static int create_snapshot_impl(FILE *fp, struct superblock *sup, char *name) {
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    unsigned slots = real_block_size / SNAP_ENTRY_SIZE;
+
+    if (!sup->refcount_start) {
+        printf("Erro: Volume sem area de referencias (formatado antes do suporte a snapshots).\n");
+        return 0;
+    }
+    if (strlen(name) > 16) {
+        printf("Erro: Nome de snapshot muito longo (max 16).\n");
+        return 0;
+    }
+
+    long old_pos = ftell(fp);
+    unsigned char *table = malloc(real_block_size);
+    if (!table || !snapshot_table_read(fp, sup, table)) {
+        printf("Erro: Falha ao ler a tabela de snapshots.\n");
+        free(table);
+        return 0;
+    }
+    if (snapshot_find(table, slots, name, NULL) != -1) {
+        printf("Erro: O snapshot '%s' ja existe.\n", name);
+        free(table);
+        return 0;
+    }
+    int slot = -1;
+    for (unsigned i = 0; i < slots && slot == -1; i++) {
+        if (table[(unsigned long)i * SNAP_ENTRY_SIZE] != STATUS_VALID) slot = (int)i;
+    }
+    if (slot == -1) {
+        printf("Erro: Tabela de snapshots cheia (%u).\n", slots);
+        free(table);
+        return 0;
+    }
+
+    // Primeiro snapshot: reserva o bloco da tabela
+    if (!sup->snap_table) {
+        long table_block = contiguous_alloc(fp, real_block_size, real_block_size,
+                                            sup->bitmap_start, sup->total_blocks);
+        if (table_block == -1) {
+            printf("Erro: Espaço insuficiente para a tabela de snapshots.\n");
+            free(table);
+            return 0;
+        }
+        sup->snap_table = (unsigned)table_block;
+        write_superblock(fp, sup);
+    }
+
+    struct dir_entry root;
+    fseek(fp, (unsigned long)sup->root_start * real_block_size, SEEK_SET);
+    read_entry(fp, &root);
+
+    // A árvore inteira passa a ser compartilhada pela raiz
+    refcount_inc(fp, sup, sup->root_start);
+
+    struct snap_entry snap;
+    memset(&snap, 0, sizeof(snap));
+    snap.status = STATUS_VALID;
+    strncpy(snap.name, name, 16);
+    snap.created = (uint32_t)time(NULL);
+    snap.root_block = sup->root_start;
+    snap.root_length = sup->root_size;
+    snap.size = root.size;
+    memcpy(table + (unsigned long)slot * SNAP_ENTRY_SIZE, &snap, sizeof(snap));
+
+    fseek(fp, (unsigned long)sup->snap_table * real_block_size, SEEK_SET);
+    fwrite(table, 1, real_block_size, fp);
+    fflush(fp);
+
+    printf("Snapshot '%s' criado (raiz no bloco %" PRIu64 ", compartilhada com a arvore atual).\n",
+           name, sup->root_start);
+    free(table);
+    fseek(fp, old_pos, SEEK_SET);
+    return 1;
+}
+
+void list_snapshots(FILE *fp, struct superblock *sup) {
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    unsigned slots = real_block_size / SNAP_ENTRY_SIZE;
+    long old_pos = ftell(fp);
+
+    unsigned char *table = malloc(real_block_size);
+    if (!table || !snapshot_table_read(fp, sup, table)) {
+        free(table);
+        return;
+    }
+
+    unsigned count = 0;
+    for (unsigned i = 0; i < slots; i++) {
+        struct snap_entry snap;
+        memcpy(&snap, table + (unsigned long)i * SNAP_ENTRY_SIZE, sizeof(snap));
+        if (snap.status != STATUS_VALID) continue;
+
+        char when[32];
+        time_t created = snap.created;
+        strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", localtime(&created));
+        printf("-- [S] %-16s %s (raiz no bloco %" PRIu64 ", %" PRIu64 " bytes)\n", snap.name, when, snap.root_block, snap.size);
+        count++;
+    }
+    if (count == 0) printf("Nenhum snapshot.\n");
+
+    free(table);
+    fseek(fp, old_pos, SEEK_SET);
+}
+
+// Monta o snapshot 'name' somente leitura. 'root' recebe a raiz congelada
+int mount_snapshot(FILE *fp, struct superblock *sup, int policy, char *name, struct dir_entry *root) {
+    if (!mount_sacs(fp, sup, policy)) return 0;
+
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    unsigned char *table = malloc(real_block_size);
+    struct snap_entry snap;
+    if (!table || !snapshot_table_read(fp, sup, table) ||
+        snapshot_find(table, real_block_size / SNAP_ENTRY_SIZE, name, &snap) == -1) {
+        printf("Erro: Snapshot '%s' nao encontrado.\n", name);
+        free(table);
+        return 0;
+    }
+    free(table);
+
+    fseek(fp, (unsigned long)snap.root_block * real_block_size, SEEK_SET);
+    read_entry(fp, root);
+    read_only = 1;
+    printf("Snapshot '%s' montado somente leitura.\n", name);
+    return 1;
+}
+
+// --- API PÚBLICA (com registro de trace) ---
+// Cada chamada é cronometrada e gravada no log quando o trace está ativo.
+// O tamanho registrado é a variação de bytes no diretório pai (ou os bytes exportados).
+
+void create_file(FILE *fp, struct dir_entry *parent_dir, struct superblock *sup,
+                 char *file_name, uint64_t size, char *data) {
+    uint64_t t0 = trace_clock();
+    int ok = check_writable() && create_file_impl(fp, parent_dir, sup, file_name, size, data);
+    trace_record(TRACE_OP_CREATE_FILE, ok, parent_dir->start_block, file_name, NULL, size, t0);
+}
+
+void create_dir(FILE *fp, struct dir_entry *parent_dir, struct superblock *sup, char *dir_name) {
+    uint64_t t0 = trace_clock();
+    int ok = check_writable() && create_dir_impl(fp, parent_dir, sup, dir_name, 1);
+    trace_record(TRACE_OP_CREATE_DIR, ok, parent_dir->start_block, dir_name, NULL, 0, t0);
+}
+
+// Diretório com mais de um bloco de entradas (usado pela conversão de formato)
+int create_dir_blocks(FILE *fp, struct dir_entry *parent_dir, struct superblock *sup, char *dir_name, unsigned blocks) {
+    uint64_t t0 = trace_clock();
+    int ok = check_writable() && create_dir_impl(fp, parent_dir, sup, dir_name, blocks ? blocks : 1);
+    trace_record(TRACE_OP_CREATE_DIR, ok, parent_dir->start_block, dir_name, NULL, 0, t0);
+    return ok;
+}
+
+int delete_item(FILE *fp, struct dir_entry *parent, struct superblock *sup, char *name) {
+    uint64_t t0 = trace_clock();
+    uint64_t size_before = parent->size;
+    int ok = check_writable() && delete_item_impl(fp, parent, sup, name);
+    trace_record(TRACE_OP_DELETE_ITEM, ok, parent->start_block, name, NULL,
+                 size_before - parent->size, t0);
+    return ok;
+}
+
+// rm -r: remove o item e, se for diretório, tudo abaixo dele
+int delete_tree(FILE *fp, struct dir_entry *parent, struct superblock *sup, char *name) {
+    uint64_t t0 = trace_clock();
+    uint64_t size_before = parent->size;
+    int ok = check_writable() && delete_tree_impl(fp, parent, sup, name);
+    trace_record(TRACE_OP_DELETE_TREE, ok, parent->start_block, name, NULL,
+                 size_before - parent->size, t0);
+    return ok;
+}
+
+int change_directory(FILE *fp, struct dir_entry *current_dir, struct superblock *sup, char *target_name) {
+    uint64_t t0 = trace_clock();
+    dir_follow(current_dir);
+    unsigned from_block = current_dir->start_block;
+    int ok = change_directory_impl(fp, current_dir, sup, target_name);
+    trace_record(TRACE_OP_CHANGE_DIR, ok, from_block, target_name, NULL, 0, t0);
+    return ok;
+}
+
+void import_file(FILE *fp_sacs, struct dir_entry *parent, struct superblock *sup, char *external_path) {
+    uint64_t t0 = trace_clock();
+    uint64_t size_before = parent->size;
+    int ok = check_writable() && import_file_impl(fp_sacs, parent, sup, external_path);
+    trace_record(TRACE_OP_IMPORT_FILE, ok, parent->start_block, external_path, NULL,
+                 parent->size - size_before, t0);
+}
+
+void export_file(FILE *fp_sacs, struct dir_entry *parent, struct superblock *sup,
+                 char *sacs_filename, char *dest_path) {
+    uint64_t t0 = trace_clock();
+    long bytes = export_file_impl(fp_sacs, parent, sup, sacs_filename, dest_path);
+    trace_record(TRACE_OP_EXPORT_FILE, bytes >= 0, parent->start_block, sacs_filename, dest_path,
+                 (bytes >= 0) ? (uint64_t)bytes : 0, t0);
+}
+
+int append_file(FILE *fp, struct dir_entry *parent, struct superblock *sup,
+                char *name, const char *data, uint64_t size) {
+    uint64_t t0 = trace_clock();
+    int ok = check_writable() && append_file_impl(fp, parent, sup, name, data, size);
+    trace_record(TRACE_OP_APPEND_FILE, ok, parent->start_block, name, NULL, size, t0);
+    return ok;
+}
+
+int truncate_file(FILE *fp, struct dir_entry *parent, struct superblock *sup, char *name, uint64_t new_size) {
+    uint64_t t0 = trace_clock();
+    int ok = check_writable() && truncate_file_impl(fp, parent, sup, name, new_size);
+    trace_record(TRACE_OP_TRUNCATE_FILE, ok, parent->start_block, name, NULL, new_size, t0);
+    return ok;
+}
+
+int import_stream(FILE *fp, struct dir_entry *parent, struct superblock *sup, int fd, char *name,
+                  struct stream_stats *st) {
+    uint64_t t0 = trace_clock();
+    struct stream_stats local;
+    if (!st) st = &local;
+    memset(st, 0, sizeof(*st)); // Volume somente leitura: o impl não roda e o trace lê st->bytes
+    int ok = check_writable() && import_stream_impl(fp, parent, sup, fd, name, st);
+    trace_record(TRACE_OP_IMPORT_STREAM, ok, parent->start_block, name, NULL, st->bytes, t0);
+    return ok;
+}
+
+int move_item(FILE *fp, struct dir_entry *cwd, struct superblock *sup, char *src_path, char *dst_path) {
+    uint64_t t0 = trace_clock();
+    int ok = check_writable() && move_item_impl(fp, cwd, sup, src_path, dst_path);
+    dir_follow(cwd); // A cópia na escrita pode ter levado o diretório corrente para outro bloco
+    trace_record(TRACE_OP_MOVE, ok, cwd->start_block, src_path, dst_path, 0, t0);
+    return ok;
+}
+
+int copy_file(FILE *fp, struct dir_entry *cwd, struct superblock *sup, char *src_path, char *dst_path) {
+    uint64_t t0 = trace_clock();
+    int ok = check_writable() && copy_file_impl(fp, cwd, sup, src_path, dst_path);
+    dir_follow(cwd);
+    trace_record(TRACE_OP_COPY, ok, cwd->start_block, src_path, dst_path, 0, t0);
+    return ok;
+}
+
+int create_snapshot(FILE *fp, struct superblock *sup, char *name) {
+    uint64_t t0 = trace_clock();
+    int ok = check_writable() && create_snapshot_impl(fp, sup, name);
+    trace_record(TRACE_OP_SNAPSHOT, ok, sup->root_start, name, NULL, 0, t0);
+    return ok;
+}
+
+// Função auxiliar para ler o tamanho real de um diretório alvo
+uint64_t get_real_dir_size(FILE *fp, unsigned int block_index, unsigned int block_size) {
+    struct dir_entry target_dot;
+    long old_pos = ftell(fp);
+    
+    // Vai até o bloco do diretório e lê a primeira entrada "."
+    fseek(fp, (unsigned long)block_index * block_size, SEEK_SET);
+    read_entry(fp, &target_dot);
+    
+    fseek(fp, old_pos, SEEK_SET); // Restaura posição
+    return target_dot.size;
+}
+
+// Listar os arquivos no FS a partir do diretório atual.
+// O diretório é lido de uma vez; os blocos dos próximos PREFETCH_DIR_AHEAD subdiretórios
+// são pedidos ao kernel antes da descida, para que a leitura de cada um já esteja em
+// andamento (ou concluída) quando a recursão chegar nele.
+void list_recursive(FILE *fp, struct dir_entry *current_dir, struct superblock *sup, int level) {
+    unsigned int real_block_size = (1 << sup->sector_size) << sup->block_size;
+    const struct sacs_geometry *g = geom_for(real_block_size);
+    struct dir_entry entry;
+
+    dir_follow(current_dir);
+    size_t dir_bytes = (size_t)current_dir->length << g->block_shift;
+    unsigned char *buf = malloc(dir_bytes);
+    if (!buf) return;
+    fseek(fp, (long)((unsigned long)current_dir->start_block << g->block_shift), SEEK_SET);
+    unsigned int max_entries = fread(buf, 1, dir_bytes, fp) >> g->entry_shift;
+
+    char indent[50] = "";
+    for(int k=0; k<level; k++) strcat(indent, "   |");
+
+    int fd = volume_fd(fp);
+    unsigned int hint_pos = 0;   // Próxima entrada a examinar pela antecipação
+    unsigned int pending = 0;    // Subdiretórios antecipados e ainda não visitados
+
+    for (unsigned int i = 0; i < max_entries; i++) {
+        const unsigned char *raw = buf + ((size_t)i << g->entry_shift);
+        if (raw[0] != STATUS_VALID) continue;   // status é o primeiro byte nos dois formatos
+        raw_decode(raw, g->entry_bytes, &entry);
+
+        uint64_t display_size = entry.size;
+
+        // Se for "..", ignora o tamanho gravado e busca o tamanho real do pai
+        if (strncmp(entry.file_name, "..", 2) == 0) {
+             display_size = get_real_dir_size(fp, entry.start_block, real_block_size);
+        }
+
+        char type_char = (entry.file_type == TYPE_DIR) ? 'D' : 'F'; 
+        printf("%s-- [%c] %s (%" PRIu64 " bytes)\n", indent, type_char, entry.file_name, display_size);
+
+        // Recursão
+        if (entry.file_type == TYPE_DIR && strcmp(entry.file_name, ".") != 0 && strcmp(entry.file_name, "..") != 0) {
+            if (i < hint_pos) pending--;
+            while (pending < PREFETCH_DIR_AHEAD && hint_pos < max_entries) {
+                struct dir_entry next;
+                const unsigned char *ahead = buf + ((size_t)hint_pos << g->entry_shift);
+                if (hint_pos++ <= i || ahead[0] != STATUS_VALID) continue;
+                raw_decode(ahead, g->entry_bytes, &next);
+                if (next.file_type != TYPE_DIR || strcmp(next.file_name, ".") == 0 ||
+                    strcmp(next.file_name, "..") == 0) continue;
+                prefetch_range(fd, (uint64_t)next.start_block << g->block_shift,
+                               (uint64_t)next.length << g->block_shift);
+                pending++;
+            }
+            list_recursive(fp, &entry, sup, level + 1);
+        }
+    }
+    free(buf);
+}
+
+// --- ESPAÇO LIVRE (df) ---
+// Varre o bitmap em palavras de 64 bits: popcount para contar os ocupados e ctz para
+// medir os trechos livres sem olhar bit a bit. Palavras inteiras livres ou ocupadas
+// custam uma comparação.
+
+#define DF_CHUNK (1024 * 1024)
+
+static unsigned df_bucket(uint64_t run) {
+    return 63 - __builtin_clzll(run);
+}
+
+static void df_close_run(struct df_report *r, uint64_t *run) {
+    if (*run == 0) return;
+    unsigned k = df_bucket(*run);
+    if (k >= DF_BUCKETS) k = DF_BUCKETS - 1;
+    r->free_runs++;
+    r->histogram[k]++;
+    r->histogram_blocks[k] += *run;
+    if (*run > r->largest_run) r->largest_run = *run;
+    *run = 0;
+}
+
+int volume_df(FILE *fp, struct superblock *sup, struct df_report *r) {
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    uint64_t t0 = trace_clock();
+    long old_pos = ftell(fp);
+
+    memset(r, 0, sizeof(*r));
+    r->total_blocks = sup->total_blocks;
+    r->meta_blocks = sup->data_start;
+
+    // 8 bytes de folga: a última palavra de um trecho é completada além de chunk
+    unsigned char *buf = malloc(DF_CHUNK + 8);
+    if (!buf) return 0;
+
+    uint64_t bitmap_bytes = (sup->total_blocks + 7) / 8;
+    uint64_t block = 0, run = 0;
+    fseeko(fp, (off_t)sup->bitmap_start * real_block_size, SEEK_SET);
+
+    for (uint64_t done = 0; done < bitmap_bytes; ) {
+        size_t chunk = (bitmap_bytes - done < DF_CHUNK) ? (size_t)(bitmap_bytes - done) : DF_CHUNK;
+        if (fread(buf, 1, chunk, fp) != chunk) {
+            free(buf);
+            fseek(fp, old_pos, SEEK_SET);
+            return 0;
+        }
+        // Completa a última palavra com bits ocupados (fora do volume)
+        size_t words = (chunk + 7) / 8;
+        memset(buf + chunk, 0xFF, words * 8 - chunk);
+
+        for (size_t i = 0; i < words; i++) {
+            uint64_t w;
+            memcpy(&w, buf + i * 8, 8);
+            uint64_t valid = sup->total_blocks - block;
+            if (valid < 64) w |= ~0ULL << valid;
+
+            r->used_blocks += (uint64_t)__builtin_popcountll(w) - ((valid < 64) ? 64 - valid : 0);
+            block += (valid < 64) ? valid : 64;
+
+            uint64_t f = ~w;
+            if (f == 0) { df_close_run(r, &run); continue; }
+            if (f == ~0ULL) { run += 64; continue; }
+
+            unsigned pos = 0;
+            while (pos < 64) {
+                uint64_t rest = f >> pos;
+                if (rest == 0) { df_close_run(r, &run); break; }
+                if (rest & 1) {
+                    unsigned len = __builtin_ctzll(~rest);
+                    run += len;
+                    pos += len;
+                    if (pos < 64) df_close_run(r, &run);
+                } else {
+                    df_close_run(r, &run);
+                    pos += __builtin_ctzll(rest);
+                }
+            }
+        }
+        done += chunk;
+    }
+    df_close_run(r, &run);
+    r->free_blocks = r->total_blocks - r->used_blocks;
+    r->frag_index = r->free_blocks ? 1.0 - (double)r->largest_run / r->free_blocks : 0;
+
+    // Conferência com a região de resumo gravada em disco
+    r->summary_ok = 1;
+    if (sup->summary_start) {
+        struct bitmap_summary sum;
+        fseeko(fp, (off_t)sup->summary_start * real_block_size, SEEK_SET);
+        for (uint64_t c = 0; c < sup->bitmap_size; c++) {
+            if (fread(&sum, sizeof(sum), 1, fp) != 1) break;
+            r->summary_free += sum.free;
+        }
+        r->summary_ok = (r->summary_free == r->free_blocks);
+    }
+
+    // Conferência com o tamanho lógico da raiz: não pode passar do espaço alocado
+    struct dir_entry dot;
+    fseeko(fp, (off_t)sup->root_start * real_block_size, SEEK_SET);
+    read_entry(fp, &dot);
+    r->root_bytes = dot.size;
+    uint64_t data_used = (r->used_blocks > r->meta_blocks) ? r->used_blocks - r->meta_blocks : 0;
+    r->data_bytes = (data_used + sup->root_size) * real_block_size;
+    r->size_ok = (r->root_bytes <= r->data_bytes);
+
+    free(buf);
+    fseek(fp, old_pos, SEEK_SET);
+    r->elapsed_ns = trace_clock() - t0;
+    return 1;
+}
+
+void print_df(struct superblock *sup, struct df_report *r) {
+    unsigned real_block_size = (1 << sup->sector_size) << sup->block_size;
+    double pct = r->total_blocks ? 100.0 * r->used_blocks / r->total_blocks : 0;
+
+    printf("\n--- ESPACO (df) ---\n");
+    printf("Blocos: %" PRIu64 " total | %" PRIu64 " usados (%.1f%%) | %" PRIu64 " livres | %" PRIu64 " de metadados\n",
+           r->total_blocks, r->used_blocks, pct, r->free_blocks, r->meta_blocks);
+    printf("Bytes:  %" PRIu64 " total | %" PRIu64 " livres (blocos de %u bytes)\n",
+           r->total_blocks * real_block_size, r->free_blocks * real_block_size, real_block_size);
+    printf("Trechos livres: %" PRIu64 " | Maior: %" PRIu64 " blocos (maior arquivo contiguo: %" PRIu64 " bytes)\n",
+           r->free_runs, r->largest_run, r->largest_run * real_block_size);
+    printf("Indice de fragmentacao: %.3f\n", r->frag_index);
+
+    printf("Histograma de trechos livres (blocos: trechos / blocos livres):\n");
+    for (unsigned k = 0; k < DF_BUCKETS; k++) {
+        if (!r->histogram[k]) continue;
+        uint64_t lo = 1ULL << k, hi = (2ULL << k) - 1;
+        printf("  %10" PRIu64 " - %-10" PRIu64 ": %8" PRIu64 " / %" PRIu64 "\n", lo, hi, r->histogram[k], r->histogram_blocks[k]);
+    }
+
+    printf("Tamanho logico da raiz: %" PRIu64 " bytes | Alocado para dados e diretorios: %" PRIu64 " bytes %s\n",
+           r->root_bytes, r->data_bytes, r->size_ok ? "(ok)" : "(INCONSISTENTE)");
+    if (sup->summary_start) {
+        printf("Resumo do bitmap: %" PRIu64 " livres %s\n", r->summary_free, r->summary_ok ? "(ok)" : "(DIVERGENTE)");
+    }
+    printf("[DF] %.3f ms\n", r->elapsed_ns / 1e6);
+}
+
+// Printar Superbloco
+void print_sup(struct superblock *sup){
+    
+    printf("Sysid = %u (v%d)\n", sup->sysid, (sup->sysid == SACS_V2) ? 2 : 1);
+    printf("Sector_size = %hu = %u \n", sup->sector_size, 1 << (sup->sector_size));
+    printf("Total Blocks = %" PRIu64 "\n", sup->total_blocks);
+    printf("Block size = %hu = %u\n", sup->block_size, (1 << (sup->sector_size)) << sup->block_size);
+    printf("Bitmap Start = %" PRIu64 "\n", sup->bitmap_start);
+    printf("Bitmap Size = %" PRIu64 "\n", sup->bitmap_size);
+    printf("Root Start = %" PRIu64 "\n", sup->root_start);
+    printf("Root Size = %" PRIu64 "\n", sup->root_size);
+    printf("Data Start = %" PRIu64 "\n", sup->data_start);
+    printf("Pack Block = %" PRIu64 "\n", sup->pack_block);
+    printf("Alloc Cursor = %" PRIu64 "\n", sup->alloc_cursor);
+    printf("Summary Start = %" PRIu64 "\n", sup->summary_start);
+    printf("Summary Size = %" PRIu64 "\n", sup->summary_size);
+    printf("Refcount Start = %" PRIu64 "\n", sup->refcount_start);
+    printf("Refcount Size = %" PRIu64 "\n", sup->refcount_size);
+    printf("Snapshot Table = %" PRIu64 "\n", sup->snap_table);
+}
+
+
+// Formatador
+void format_sacs(const char *filename, unsigned int sysid, uint64_t sector_count, unsigned short sector_size, unsigned short block_size, unsigned int root_size){
+    
+    printf("--- FORMATANDO %s ---\n", filename);
+    FILE *fp = volume_open(filename, "wb"); // "wb" cria ou sobrescreve (lista com vírgulas = volume em faixas)
+    if (!fp) { perror("Erro ao abrir dispositivo/arquivo"); exit(1); }
+
+    struct superblock sup;
+    memset(&sup, 0, sizeof(struct superblock));
+
+    sup.sysid = sysid;
+    unsigned entry_bytes = entry_size_for(sysid);
+    slot_hints_reset();
+    pack_partials_reset();
+    sup.sector_size = sector_size;
+    sup.block_size = block_size;
+    unsigned int real_block_size = (1 << (sup.sector_size)) << sup.block_size;
+    sup.total_blocks = (sector_count + ((1 << sup.block_size)-1)) / (1 << sup.block_size);  
+    sup.bitmap_start = 1;
+    uint64_t bits_needed = sup.total_blocks;
+    uint64_t bytes_needed = (bits_needed + 7) / 8;
+    sup.bitmap_size = (bytes_needed + real_block_size - 1) / real_block_size;
+    if (sup.bitmap_size == 0) sup.bitmap_size = 1;
+    unsigned long summary_bytes = (unsigned long)sup.bitmap_size * sizeof(struct bitmap_summary);
+    sup.summary_start = sup.bitmap_start + sup.bitmap_size;
+    sup.summary_size = (summary_bytes + real_block_size - 1) / real_block_size;
+    sup.refcount_start = sup.summary_start + sup.summary_size;
+    sup.refcount_size = (sup.total_blocks + real_block_size - 1) / real_block_size;
+    sup.root_start = sup.refcount_start + sup.refcount_size;
+    sup.root_size = root_size;
+    sup.data_start = sup.root_start + sup.root_size;  
+    print_sup(&sup);
+    printf("Size of SuperBlock = %lu\nSize of DirEntry = %u\n",
+            (sysid == SACS_V2) ? sizeof(struct superblock) : sizeof(struct superblock_v1), entry_bytes);
+
+
+    unsigned char *buffer = calloc(1, real_block_size);
+    encode_superblock(&sup, buffer);
+    fwrite(buffer, real_block_size , 1, fp);
+
+    memset(buffer, 0, real_block_size);
+
+   // --- INICIALIZAR BITMAP ---
+    printf("Inicializando Bitmap (%" PRIu64 " blocos)...\n", sup.bitmap_size);
+
+    unsigned long bitmap_offset_bytes = (unsigned long)sup.bitmap_start * real_block_size;
+    unsigned long total_bitmap_bytes_on_disk = (unsigned long)sup.bitmap_size * real_block_size;
+    
+    // Zera a área do Bitmap marcando os Metadados (Superbloco + Bitmap + Resumo + Refcount + Raiz).
+    // Com blocos pequenos os metadados podem passar do primeiro bloco de bitmap.
+    unsigned long bits_per_block = (unsigned long)real_block_size * 8;
+    fseek(fp, bitmap_offset_bytes, SEEK_SET);
+    unsigned long bytes_written = 0;
+
+    // Escreve de 1 em 1 bloco
+    for (unsigned long c = 0; bytes_written < total_bitmap_bytes_on_disk; c++) {
+        memset(buffer, 0, real_block_size); 
+        for (uint64_t i = c * bits_per_block; i < sup.data_start && i < (c + 1) * bits_per_block; i++) {
+            set_bit(buffer, i - c * bits_per_block);
+        }
+        fwrite(buffer, 1, real_block_size, fp);
+        
+        bytes_written += real_block_size;
+    }
+    memset(buffer, 0, real_block_size);
+    // --- DIRETORIO RAIZ ---
+    // Preencher com zeros
+    for (unsigned int i = 0; i < sup.root_size; i++) {
+        fwrite(buffer, real_block_size, 1, fp);
+    }
+    
+    // Gravar pastas . e .. no diretorio raiz
+    struct dir_entry dot, dotdot;
+    memset(&dot, 0, sizeof(dot));
+    dot.status = STATUS_VALID;
+    strcpy(dot.file_name, ".");
+    dot.file_type = TYPE_DIR;
+    dot.start_block = sup.root_start;
+    dot.size = entry_bytes * 2;
+    dot.length = sup.root_size;
+
+    dotdot = dot;
+    strcpy(dotdot.file_name, "..");
+
+    fseek(fp, sup.root_start * real_block_size, SEEK_SET);
+    write_entry_as(fp, &dot, entry_bytes);
+    write_entry_as(fp, &dotdot, entry_bytes);
+
+    // Área de dados: numa imagem simples basta estender o arquivo (fica esparso, lê zeros);
+    // volumes em faixas não têm descritor e continuam sendo preenchidos com zeros
+    uint64_t data_blocks = sup.total_blocks - sup.data_start;
+    fflush(fp);
+    if (stripe_is(fp) || ftruncate(fileno(fp), (off_t)sup.total_blocks * real_block_size) != 0) {
+        fseeko(fp, (off_t)sup.data_start * real_block_size, SEEK_SET);
+        for(uint64_t i=0; i < data_blocks; i++){
+            fwrite(buffer, 1, real_block_size, fp);
+        }
+    }
+
+    memset(buffer, 0, real_block_size);
+    
+    // --- RESUMO DO BITMAP ---
+    // Só os primeiros blocos de bitmap têm bits de metadados; os demais começam livres
+    unsigned long bits_per_chunk = bits_per_block;
+    fseek(fp, (unsigned long)sup.summary_start * real_block_size, SEEK_SET);
+    for (unsigned c = 0; c < sup.bitmap_size; c++) {
+        unsigned long first = c * bits_per_chunk;
+        unsigned bits = 0;
+        if (first < sup.total_blocks) {
+            bits = (sup.total_blocks - first < bits_per_chunk) ? sup.total_blocks - first : bits_per_chunk;
+        }
+        memset(buffer, 0, real_block_size);
+        for (uint64_t i = first; i < sup.data_start && i < first + bits_per_chunk; i++) {
+            set_bit(buffer, i - first);
+        }
+        struct bitmap_summary sum;
+        summarize_chunk(buffer, bits, &sum);
+        fwrite(&sum, sizeof(sum), 1, fp);
+    }
+
+    // --- REFCOUNT ---
+    memset(buffer, 0, real_block_size);
+    fseeko(fp, (off_t)sup.refcount_start * real_block_size, SEEK_SET);
+    for (uint64_t i = 0; i < sup.refcount_size; i++) {
+        fwrite(buffer, 1, real_block_size, fp);
+    }
+
+    printf("Disco formatado com sucesso! (Root Start: %" PRIu64 " | Data Start: %" PRIu64 ")\n\n", sup.root_start, sup.data_start);
+
+    fclose(fp);
+    free(buffer);
+    printf("Arquivo %s criado com sucesso!\n", filename);
+}
+
@@ -1,79 +1,277 @@
-#ifndef SACS_H
-#define SACS_H
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <stdint.h>
-
-
-// --- CONFIGURAÇÕES DO SACS ---
-#define SACS 0x53414353
-#define ENTRY_SIZE 32
-#define TYPE_DIR 0x0002
-#define TYPE_FILE 0x0003
-#define STATUS_FREE 0
-#define STATUS_VALID 1
-
-// --- ESTRUTURAS ---
-
-struct __attribute__((__packed__)) superblock {
-    uint32_t sysid;           // 0
-    uint16_t sector_size;     // 4
-    uint32_t total_blocks;    // 10
-    uint16_t block_size;      // 14
-    uint32_t bitmap_start;    // 20
-    uint32_t bitmap_size;     // 24
-    uint32_t root_start;      // 28
-    uint32_t root_size;       // 32
-    uint32_t data_start;      // 36
-    char reserved[32];        // 40
-};
-
-struct __attribute__((__packed__)) dir_entry {
-    int8_t status;
-    char file_name[17];
-    uint16_t file_type;
-    uint32_t start_block;
-    uint32_t size;
-    uint32_t length; 
-};
-
-// --- PROTÓTIPOS DAS FUNÇÕES ---
-
-// Auxiliares de bits
-void set_bit(unsigned char *bitmap_buffer, int block_index);
-int get_bit(unsigned char *bitmap, int index);
-void unset_bit(unsigned char *bitmap_buffer, int block_index);
-
-// Alocação e manipulação de disco
-long int contiguous_alloc(FILE *fp, unsigned file_size, unsigned real_block_size, 
-                          unsigned bitmap_start, unsigned total_blocks);
-void contiguous_dealloc(FILE *fp, unsigned start_block, unsigned length_in_blocks, 
-                        unsigned bitmap_start, unsigned real_block_size,
-                        unsigned data_start);
-
-// Manipulação de diretórios e arquivos
-void update_hierarchy_size(FILE *fp, unsigned start_block, int delta, unsigned block_size);
-int check_duplicate(FILE *fp, struct dir_entry *parent, char *name, unsigned block_size);
-void prepare_dir_entry(struct dir_entry *entry, char *file_name, unsigned short file_type, 
-                       unsigned size, unsigned start_block, unsigned block_size);
-int add_entry_to_parent(FILE *fp, struct dir_entry *parent, struct dir_entry *new_entry, unsigned block_size);
-
-// Operações do Sistema de Arquivos (API)
-void create_file(FILE *fp, struct dir_entry *parent_dir, struct superblock *sup, 
-                 char *file_name, unsigned size, char *data);
-void create_dir(FILE *fp, struct dir_entry *parent_dir, struct superblock *sup, char *dir_name);
-int delete_item(FILE *fp, struct dir_entry *parent, struct superblock *sup, char *name);
-int change_directory(FILE *fp, struct dir_entry *current_dir, struct superblock *sup, char *target_name);
-void import_file(FILE *fp_sacs, struct dir_entry *parent, struct superblock *sup, char *external_path);
-void export_file(FILE *fp_sacs, struct dir_entry *parent, struct superblock *sup, 
-                 char *sacs_filename, char *dest_path);
-unsigned int get_real_dir_size(FILE *fp, unsigned int block_index, unsigned int block_size);
-void list_recursive(FILE *fp, struct dir_entry *current_dir, struct superblock *sup, int level);
-
-// Sistema e Formatação
-void print_sup(struct superblock *sup);
-void format_sacs(const char *filename, unsigned int sysid, unsigned sector_count, 
-                 unsigned short sector_size, unsigned short block_size, unsigned int root_size);
-
+#ifndef SACS_H
+#define SACS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+
+// --- CONFIGURAÇÕES DO SACS ---
+#define SACS 0x53414353      // Formato v1 (campos de 32 bits)
+#define SACS_V2 0x32434153   // "SAC2": formato v2 (tamanhos e blocos de 64 bits)
+#define ENTRY_SIZE_V1 32
+#define ENTRY_SIZE_V2 64
+#define ENTRY_SIZE sacs_entry_size() // Tamanho da entrada no formato do volume montado
+#define TYPE_DIR 0x0002
+#define TYPE_FILE 0x0003
+#define TYPE_PACKED 0x0004   // Arquivo pequeno em bloco compartilhado (length = offset no bloco)
+#define STATUS_FREE 0
+#define STATUS_VALID 1
+#define DIR_FULL -1          // dir_reserve_slot: nenhuma entrada livre
+#define DIR_DUPLICATE -2     // dir_reserve_slot: o nome já existe
+#define SACS_MAX_HANDLES 64
+#define SACS_PATH_MAX 1024
+
+// Políticas de alocação (escolhidas na montagem)
+#define ALLOC_BEST_FIT 0
+#define ALLOC_NEXT_FIT 1
+#define ALLOC_SEGREGATED 2
+#define ALLOC_LOCALITY 3
+#define SEG_CLASSES 32
+
+// Empacotamento de arquivos pequenos
+#define PACK_MAGIC 0x4B434150   // "PACK"
+#define PACK_UNIT 64
+#define PACK_MAP_BYTES 56
+
+// Snapshots
+#define SNAP_ENTRY_SIZE 64
+#define REFCOUNT_MAX 255      // Contagem saturada: o bloco nunca mais é liberado
+
+// Relatório de espaço (df)
+#define DF_BUCKETS 33         // Histograma de trechos livres por potência de 2
+
+// Importação em fluxo (tamanho desconhecido)
+#define STREAM_CHUNK (1 << 20)            // Leitura do descritor por vez
+#define STREAM_PREALLOC_MIN (4 << 20)     // Reserva especulativa inicial
+#define STREAM_PREALLOC_MAX (256 << 20)   // Maior crescimento de uma vez
+
+// Transferências com stdio movem 2^SACS_IO_SHIFT blocos por chamada
+#define SACS_IO_SHIFT 6
+
+// --- ESTRUTURAS ---
+
+// Superbloco em memória (igual ao formato v2 em disco)
+struct __attribute__((__packed__)) superblock {
+    uint32_t sysid;           // 0  SACS (v1) ou SACS_V2
+    uint16_t sector_size;     // 4
+    uint16_t block_size;      // 6
+    uint64_t total_blocks;    // 8
+    uint64_t bitmap_start;    // 16
+    uint64_t bitmap_size;     // 24
+    uint64_t root_start;      // 32
+    uint64_t root_size;       // 40
+    uint64_t data_start;      // 48
+    uint64_t pack_block;      // 56 Bloco de empacotamento corrente (0 = nenhum)
+    uint64_t alloc_cursor;    // 64 Cursor do next-fit
+    uint64_t summary_start;   // 72 Resumo por bloco de bitmap (0 = sem resumo)
+    uint64_t summary_size;    // 80
+    uint64_t refcount_start;  // 88 Referências extras por bloco (0 = sem snapshots)
+    uint64_t refcount_size;   // 96
+    uint64_t snap_table;      // 104 Bloco da tabela de snapshots (0 = nenhum)
+    char reserved[16];        // 112
+};
+
+// Superbloco no formato v1 em disco
+struct __attribute__((__packed__)) superblock_v1 {
+    uint32_t sysid;           // 0
+    uint16_t sector_size;     // 4
+    uint32_t total_blocks;    // 10
+    uint16_t block_size;      // 14
+    uint32_t bitmap_start;    // 20
+    uint32_t bitmap_size;     // 24
+    uint32_t root_start;      // 28
+    uint32_t root_size;       // 32
+    uint32_t data_start;      // 36
+    uint32_t pack_block;      // 40 Bloco de empacotamento corrente (0 = nenhum)
+    uint32_t alloc_cursor;    // 44 Cursor do next-fit
+    uint32_t summary_start;   // 48 Resumo por bloco de bitmap (0 = sem resumo)
+    uint32_t summary_size;    // 52
+    uint32_t refcount_start;  // 56 Referências extras por bloco (0 = sem snapshots)
+    uint32_t refcount_size;   // 60
+    uint32_t snap_table;      // 64 Bloco da tabela de snapshots (0 = nenhum)
+    char reserved[4];         // 68
+};
+
+// Entrada de diretório em memória (igual ao formato v2 em disco, 64 bytes)
+struct __attribute__((__packed__)) dir_entry {
+    int8_t status;
+    char file_name[17];
+    uint16_t file_type;
+    uint64_t start_block;
+    uint64_t size;
+    uint64_t length;
+    char reserved[20];
+};
+
+// Entrada de diretório no formato v1 em disco (32 bytes)
+struct __attribute__((__packed__)) dir_entry_v1 {
+    int8_t status;
+    char file_name[17];
+    uint16_t file_type;
+    uint32_t start_block;
+    uint32_t size;
+    uint32_t length; 
+};
+
+// Cabeçalho de um bloco compartilhado (ocupa a unidade 0)
+struct __attribute__((__packed__)) pack_header {
+    uint32_t magic;
+    uint16_t used;                    // Unidades de dados ocupadas
+    uint16_t units;                   // Total de unidades no bloco
+    unsigned char map[PACK_MAP_BYTES];// Bit por unidade
+};
+
+// Entrada da tabela de snapshots (um bloco, SNAP_ENTRY_SIZE bytes por snapshot)
+struct __attribute__((__packed__)) snap_entry {
+    int8_t status;
+    char name[17];
+    uint16_t reserved;
+    uint32_t created;         // time() na criação
+    uint64_t root_block;      // Cópia congelada do diretório raiz
+    uint64_t root_length;
+    uint64_t size;            // Tamanho da árvore no momento do snapshot
+    char pad[16];
+};
+
+// Resumo do espaço livre de um bloco de bitmap (um por bloco, na região de resumo)
+struct __attribute__((__packed__)) bitmap_summary {
+    uint32_t free;            // Bits livres no bloco
+    uint32_t longest;         // Maior trecho livre
+    uint32_t head;            // Trecho livre no início
+    uint32_t tail;            // Trecho livre no fim
+};
+
+// Relatório de espaço livre e fragmentação
+struct df_report {
+    uint64_t total_blocks;
+    uint64_t used_blocks;
+    uint64_t free_blocks;
+    uint64_t meta_blocks;     // Abaixo de data_start (superbloco, bitmap, resumo, refcount, raiz)
+    uint64_t free_runs;
+    uint64_t largest_run;
+    uint64_t histogram[DF_BUCKETS];   // Trechos com 2^k..2^(k+1)-1 blocos
+    uint64_t histogram_blocks[DF_BUCKETS];
+    double frag_index;        // 1 - maior trecho / livres (0 = todo o livre é contíguo)
+    uint64_t root_bytes;      // Tamanho lógico mantido em "." da raiz
+    uint64_t data_bytes;      // Bytes em blocos de dados alocados
+    uint64_t summary_free;    // Livres segundo a região de resumo (0 se não houver)
+    int summary_ok;
+    int size_ok;
+    uint64_t elapsed_ns;
+};
+
+// Estatísticas de uma importação em fluxo
+struct stream_stats {
+    uint64_t bytes;
+    uint64_t grown_in_place;  // Crescimentos sobre blocos livres vizinhos
+    uint64_t relocations;     // Crescimentos que precisaram mover o extent
+    uint64_t relocated_bytes;
+    uint64_t trimmed_blocks;  // Reserva especulativa devolvida no fim
+};
+
+// Geometria do volume montado (tudo potência de 2: deslocamentos e máscaras nos laços)
+struct sacs_geometry {
+    unsigned block_bytes;         // (1 << sector_size) << block_size
+    unsigned block_shift;
+    unsigned block_mask;
+    unsigned entry_bytes;         // ENTRY_SIZE
+    unsigned entry_shift;
+    unsigned entries_per_block;
+    unsigned entries_shift;
+    unsigned bits_shift;          // log2 dos bits por bloco de bitmap
+    unsigned bits_mask;
+};
+
+// --- PROTÓTIPOS DAS FUNÇÕES ---
+
+// Tamanho das entradas no formato do volume montado e no formato 'sysid'
+unsigned sacs_entry_size(void);
+unsigned entry_size_for(unsigned sysid);
+extern struct sacs_geometry sacs_geom;
+void geometry_init(struct sacs_geometry *g, unsigned block_bytes, unsigned entry_bytes);
+
+// Auxiliares de bits
+void set_bit(unsigned char *bitmap_buffer, uint64_t block_index);
+int get_bit(const unsigned char *bitmap, uint64_t index);
+void unset_bit(unsigned char *bitmap_buffer, uint64_t block_index);
+void summarize_chunk(const unsigned char *chunk, unsigned bits, struct bitmap_summary *out);
+
+// Formatos v1/v2 em disco
+int read_entry(FILE *fp, struct dir_entry *entry);
+void write_entry(FILE *fp, const struct dir_entry *entry);
+void entry_from_v1(const struct dir_entry_v1 *raw, struct dir_entry *entry);
+int read_superblock(FILE *fp, struct superblock *sup);
+uint64_t max_file_size(const struct superblock *sup);
+
+// Alocação e manipulação de disco
+long int contiguous_alloc(FILE *fp, uint64_t file_size, unsigned real_block_size, 
+                          unsigned bitmap_start, unsigned total_blocks);
+long int contiguous_alloc_near(FILE *fp, uint64_t file_size, unsigned real_block_size,
+                               unsigned bitmap_start, unsigned total_blocks, unsigned hint);
+void contiguous_dealloc(FILE *fp, unsigned start_block, unsigned length_in_blocks, 
+                        unsigned bitmap_start, unsigned real_block_size,
+                        unsigned data_start);
+
+// Manipulação de diretórios e arquivos
+void update_hierarchy_size(FILE *fp, unsigned start_block, int64_t delta, unsigned block_size);
+void prepare_dir_entry(struct dir_entry *entry, char *file_name, unsigned short file_type, 
+                       uint64_t size, uint64_t start_block, unsigned block_size);
+int add_entry_to_parent(FILE *fp, struct dir_entry *parent, struct dir_entry *new_entry, unsigned block_size);
+int find_entry(FILE *fp, struct dir_entry *parent, char *name, unsigned block_size, struct dir_entry *out);
+void dir_follow(struct dir_entry *dir); // Segue o diretório até o bloco da cópia na escrita
+long dir_reserve_slot(FILE *fp, struct dir_entry *parent, char *name, unsigned block_size);
+void dir_write_slot(FILE *fp, struct dir_entry *parent, long slot, struct dir_entry *entry, unsigned block_size);
+int is_regular_file(struct dir_entry *entry);
+unsigned long entry_data_pos(struct dir_entry *entry, unsigned real_block_size);
+
+// Operações do Sistema de Arquivos (API)
+void create_file(FILE *fp, struct dir_entry *parent_dir, struct superblock *sup, 
+                 char *file_name, uint64_t size, char *data);
+void create_dir(FILE *fp, struct dir_entry *parent_dir, struct superblock *sup, char *dir_name);
+int create_dir_blocks(FILE *fp, struct dir_entry *parent_dir, struct superblock *sup, char *dir_name, unsigned blocks);
+int delete_item(FILE *fp, struct dir_entry *parent, struct superblock *sup, char *name);
+int delete_tree(FILE *fp, struct dir_entry *parent, struct superblock *sup, char *name);
+int change_directory(FILE *fp, struct dir_entry *current_dir, struct superblock *sup, char *target_name);
+void import_file(FILE *fp_sacs, struct dir_entry *parent, struct superblock *sup, char *external_path);
+void export_file(FILE *fp_sacs, struct dir_entry *parent, struct superblock *sup, 
+                 char *sacs_filename, char *dest_path);
+int append_file(FILE *fp, struct dir_entry *parent, struct superblock *sup,
+                char *name, const char *data, uint64_t size);
+int truncate_file(FILE *fp, struct dir_entry *parent, struct superblock *sup, char *name, uint64_t new_size);
+int import_stream(FILE *fp, struct dir_entry *parent, struct superblock *sup, int fd, char *name,
+                  struct stream_stats *st);
+void stream_print_stats(const struct stream_stats *st);
+
+// Caminhos, mover e copiar dentro da imagem
+int resolve_path(FILE *fp, struct dir_entry *cwd, struct superblock *sup, const char *path,
+                 struct dir_entry *dir, char *name);
+int move_item(FILE *fp, struct dir_entry *cwd, struct superblock *sup, char *src_path, char *dst_path);
+int copy_file(FILE *fp, struct dir_entry *cwd, struct superblock *sup, char *src_path, char *dst_path);
+
+// Snapshots (cópia na escrita)
+int create_snapshot(FILE *fp, struct superblock *sup, char *name);
+void list_snapshots(FILE *fp, struct superblock *sup);
+int mount_snapshot(FILE *fp, struct superblock *sup, int policy, char *name, struct dir_entry *root);
+
+// Handles de arquivo (acesso aleatório). O diretório pai passado ao sacs_open é atualizado
+// pelas escritas que crescem o arquivo e deve continuar válido até sacs_close
+int sacs_open(FILE *fp, struct dir_entry *parent, struct superblock *sup, char *name);
+long sacs_pread(int h, void *buf, unsigned long count, unsigned long offset);
+long sacs_pwrite(int h, const void *buf, unsigned long count, unsigned long offset);
+long sacs_size(int h);
+int sacs_close(int h);
+uint64_t get_real_dir_size(FILE *fp, unsigned int block_index, unsigned int block_size);
+void list_recursive(FILE *fp, struct dir_entry *current_dir, struct superblock *sup, int level);
+
+// Sistema e Formatação
+int mount_sacs(FILE *fp, struct superblock *sup, int policy);
+int parse_alloc_policy(const char *name);
+const char *alloc_policy_name(int policy);
+void print_sup(struct superblock *sup);
+int volume_df(FILE *fp, struct superblock *sup, struct df_report *report);
+void print_df(struct superblock *sup, struct df_report *report);
+void format_sacs(const char *filename, unsigned int sysid, uint64_t sector_count, 
+                 unsigned short sector_size, unsigned short block_size, unsigned int root_size);
+
 #endif // SACS_H
\ No newline at end of file
@@ -0,0 +1,224 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "sacs_client.h"
+
+// --- E/S NO SOCKET ---
+
+static int recv_full(int fd, void *buf, size_t len) {
+    char *p = buf;
+    while (len > 0) {
+        ssize_t n = recv(fd, p, len, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 0;
+        p += n;
+        len -= (size_t)n;
+    }
+    return 1;
+}
+
+static int send_full(int fd, const void *buf, size_t len) {
+    const char *p = buf;
+    while (len > 0) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 0;
+        p += n;
+        len -= (size_t)n;
+    }
+    return 1;
+}
+
+// Envia cabeçalho e caminho. Os dados do import seguem com send_full
+static int send_request(struct sacs_client *c, uint16_t op, uint16_t flags, const char *path,
+                        uint64_t offset, uint64_t length) {
+    size_t path_len = path ? strlen(path) : 0;
+    if (path_len >= SACS_PATH_MAX) return SACSD_EINVAL;
+
+    struct sacsd_request req = { op, flags, (uint16_t)path_len, 0, offset, length };
+    if (!send_full(c->fd, &req, sizeof(req)) || !send_full(c->fd, path, path_len)) return SACSD_EPROTO;
+    return SACSD_OK;
+}
+
+static int recv_reply(struct sacs_client *c, struct sacsd_reply *rep) {
+    if (!recv_full(c->fd, rep, sizeof(*rep))) return SACSD_EPROTO;
+    return rep->status;
+}
+
+// Descarta o corpo de uma resposta que o chamador não pode receber
+static int skip_body(struct sacs_client *c, uint64_t length) {
+    char buf[4096];
+    while (length > 0) {
+        size_t chunk = (length < sizeof(buf)) ? (size_t)length : sizeof(buf);
+        if (!recv_full(c->fd, buf, chunk)) return 0;
+        length -= chunk;
+    }
+    return 1;
+}
+
+// Resposta sem corpo esperado
+static int finish_call(struct sacs_client *c) {
+    struct sacsd_reply rep;
+    int st = recv_reply(c, &rep);
+    if (st != SACSD_EPROTO && rep.length && !skip_body(c, rep.length)) return SACSD_EPROTO;
+    return st;
+}
+
+static int simple_call(struct sacs_client *c, uint16_t op, uint16_t flags, const char *path,
+                       uint64_t offset, uint64_t length) {
+    int st = send_request(c, op, flags, path, offset, length);
+    return (st == SACSD_OK) ? finish_call(c) : st;
+}
+
+// --- CONEXÃO ---
+
+struct sacs_client *sacsc_connect(const char *socket_path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) return NULL;
+    strcpy(addr.sun_path, socket_path);
+
+    struct sacs_client *c = malloc(sizeof(*c));
+    if (!c) return NULL;
+    c->fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (c->fd < 0 || connect(c->fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        simple_call(c, SACSD_OP_HELLO, 0, NULL, SACSD_MAGIC, SACSD_VERSION) != SACSD_OK) {
+        if (c->fd >= 0) close(c->fd);
+        free(c);
+        return NULL;
+    }
+    return c;
+}
+
+void sacsc_disconnect(struct sacs_client *c) {
+    if (!c) return;
+    close(c->fd);
+    free(c);
+}
+
+// --- OPERAÇÕES ---
+
+int sacsc_lookup(struct sacs_client *c, const char *path, struct dir_entry *out) {
+    struct sacsd_reply rep;
+    int st = send_request(c, SACSD_OP_LOOKUP, 0, path, 0, 0);
+    if (st != SACSD_OK) return st;
+    st = recv_reply(c, &rep);
+    if (st != SACSD_OK) return st;
+    if (rep.count != 1 || rep.length != sizeof(*out)) return SACSD_EPROTO;
+    return recv_full(c->fd, out, sizeof(*out)) ? SACSD_OK : SACSD_EPROTO;
+}
+
+// Retorna o número de entradas em *out (alocado aqui)
+long sacsc_list(struct sacs_client *c, const char *path, struct dir_entry **out) {
+    struct sacsd_reply rep;
+    *out = NULL;
+    int st = send_request(c, SACSD_OP_LIST, 0, path, 0, 0);
+    if (st != SACSD_OK) return st;
+    st = recv_reply(c, &rep);
+    if (st != SACSD_OK) return st;
+    if (rep.length != (uint64_t)rep.count * sizeof(struct dir_entry)) return SACSD_EPROTO;
+
+    *out = malloc(rep.length ? rep.length : 1);
+    if (!*out) return skip_body(c, rep.length) ? SACSD_EFAIL : SACSD_EPROTO;
+    if (!recv_full(c->fd, *out, rep.length)) {
+        free(*out);
+        *out = NULL;
+        return SACSD_EPROTO;
+    }
+    return rep.count;
+}
+
+// Retorna os bytes lidos (menos que count no fim do arquivo)
+long sacsc_read(struct sacs_client *c, const char *path, void *buf, uint64_t count, uint64_t offset) {
+    struct sacsd_reply rep;
+    int st = send_request(c, SACSD_OP_READ, 0, path, offset, count);
+    if (st != SACSD_OK) return st;
+    st = recv_reply(c, &rep);
+    if (st != SACSD_OK) return st;
+    if (rep.length > count) return SACSD_EPROTO;
+    return recv_full(c->fd, buf, rep.length) ? (long)rep.length : SACSD_EPROTO;
+}
+
+int sacsc_import(struct sacs_client *c, const char *path, const void *data, uint64_t size) {
+    int st = send_request(c, SACSD_OP_IMPORT, 0, path, 0, size);
+    if (st != SACSD_OK) return st;
+    if (!send_full(c->fd, data, size)) return SACSD_EPROTO;
+    return finish_call(c);
+}
+
+// Envia o arquivo local em trechos; o tamanho vai no cabeçalho
+int sacsc_import_file(struct sacs_client *c, const char *path, const char *local_path) {
+    FILE *src = fopen(local_path, "rb");
+    struct stat stbuf;
+    if (!src) return SACSD_ENOENT;
+    if (fstat(fileno(src), &stbuf) != 0 || !S_ISREG(stbuf.st_mode)) {
+        fclose(src);
+        return SACSD_EINVAL;
+    }
+
+    uint64_t left = (uint64_t)stbuf.st_size;
+    int st = send_request(c, SACSD_OP_IMPORT, 0, path, 0, left);
+    char *buf = malloc(STREAM_CHUNK);
+    while (st == SACSD_OK && left > 0) {
+        size_t chunk = (left < STREAM_CHUNK) ? (size_t)left : STREAM_CHUNK;
+        // O servidor espera exatamente o tamanho anunciado: sem ele, a conexão não tem volta
+        if (!buf || fread(buf, 1, chunk, src) != chunk || !send_full(c->fd, buf, chunk)) st = SACSD_EPROTO;
+        left -= chunk;
+    }
+    free(buf);
+    fclose(src);
+    return (st == SACSD_OK) ? finish_call(c) : st;
+}
+
+// Grava o arquivo inteiro em local_path. Retorna os bytes exportados
+long sacsc_export(struct sacs_client *c, const char *path, const char *local_path) {
+    struct sacsd_reply rep;
+    int st = send_request(c, SACSD_OP_EXPORT, 0, path, 0, 0);
+    if (st != SACSD_OK) return st;
+    st = recv_reply(c, &rep);
+    if (st != SACSD_OK) return st;
+
+    FILE *dst = fopen(local_path, "wb");
+    if (!dst) return skip_body(c, rep.length) ? SACSD_EINVAL : SACSD_EPROTO;
+
+    char *buf = malloc(STREAM_CHUNK);
+    uint64_t left = rep.length;
+    while (buf && left > 0) {
+        size_t chunk = (left < STREAM_CHUNK) ? (size_t)left : STREAM_CHUNK;
+        if (!recv_full(c->fd, buf, chunk)) break;
+        if (fwrite(buf, 1, chunk, dst) != chunk) st = SACSD_EFAIL;
+        left -= chunk;
+    }
+    free(buf);
+    if (fclose(dst) != 0) st = SACSD_EFAIL;
+    if (left > 0) return SACSD_EPROTO;
+    return (st == SACSD_OK) ? (long)rep.length : st;
+}
+
+int sacsc_mkdir(struct sacs_client *c, const char *path) {
+    return simple_call(c, SACSD_OP_MKDIR, 0, path, 0, 0);
+}
+
+int sacsc_delete(struct sacs_client *c, const char *path, int recursive) {
+    return simple_call(c, SACSD_OP_DELETE, recursive ? SACSD_F_RECURSIVE : 0, path, 0, 0);
+}
+
+const char *sacsc_strerror(int status) {
+    switch (status) {
+        case SACSD_OK:      return "ok";
+        case SACSD_ENOENT:  return "nao encontrado";
+        case SACSD_EEXIST:  return "ja existe";
+        case SACSD_ENOTDIR: return "nao e um diretorio";
+        case SACSD_EISDIR:  return "e um diretorio";
+        case SACSD_EINVAL:  return "pedido invalido";
+        case SACSD_EFAIL:   return "falha no volume";
+        case SACSD_EPROTO:  return "conexao perdida";
+    }
+    return "erro desconhecido";
+}
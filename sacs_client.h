@@ -0,0 +1,29 @@
+#ifndef SACS_CLIENT_H
+#define SACS_CLIENT_H
+
+#include <stdint.h>
+#include "sacsd.h"
+
+// --- CLIENTE DO SERVIDOR LOCAL ---
+// Uma conexão atende um pedido por vez; threads diferentes usam conexões diferentes.
+// As funções retornam SACSD_OK (ou uma contagem >= 0) em caso de sucesso e um estado
+// SACSD_E* negativo em caso de erro. Depois de SACSD_EPROTO a conexão não serve mais.
+
+struct sacs_client {
+    int fd;
+};
+
+struct sacs_client *sacsc_connect(const char *socket_path);
+void sacsc_disconnect(struct sacs_client *c);
+
+int sacsc_lookup(struct sacs_client *c, const char *path, struct dir_entry *out);
+long sacsc_list(struct sacs_client *c, const char *path, struct dir_entry **out);   // *out: free()
+long sacsc_read(struct sacs_client *c, const char *path, void *buf, uint64_t count, uint64_t offset);
+int sacsc_import(struct sacs_client *c, const char *path, const void *data, uint64_t size);
+int sacsc_import_file(struct sacs_client *c, const char *path, const char *local_path);
+long sacsc_export(struct sacs_client *c, const char *path, const char *local_path);
+int sacsc_mkdir(struct sacs_client *c, const char *path);
+int sacsc_delete(struct sacs_client *c, const char *path, int recursive);
+const char *sacsc_strerror(int status);
+
+#endif // SACS_CLIENT_H
@@ -0,0 +1,505 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "sacs.h"
+#include "sacsd.h"
+#include "trace.h"
+#include "stripe.h"
+#include "prefetch.h"
+
+// Servidor local: mantém um volume montado e atende clientes por um socket Unix.
+// Uso: sacsd <imagem> <socket> [-v]
+//   -v : mantém as mensagens da API em stdout (por padrão vão para /dev/null)
+// Variáveis: SACS_ALLOC, SACS_SNAPSHOT (monta o snapshot somente leitura), SACS_TRACE,
+// SACS_PREFETCH e SACS_PREFETCH_MAX.
+//
+// Um thread por cliente. Toda chamada à API passa por volume_lock: o estado montado
+// (superbloco, resumo do bitmap, listas segregadas, dicas de entradas livres, buffer do
+// stdio) é global no processo e continua quente entre pedidos. Os dados de READ/EXPORT
+// são lidos com pread fora do lock e validados por volume_seq, que fica ímpar durante
+// uma mutação; se uma mutação começou no meio, o trecho é relido sob o lock.
+
+static FILE *volume;
+static struct superblock sup;
+static unsigned real_block_size;
+static int data_fd = -1;                 // -1: volume em faixas, sem pread direto
+static struct dir_entry snapshot_root;   // Raiz servida com SACS_SNAPSHOT
+static int snapshot_mounted;
+static pthread_mutex_t volume_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t volume_seq;
+static volatile sig_atomic_t stopping;
+static int active_clients;
+static unsigned long served[SACSD_OP_MAX + 1];
+static unsigned long failed[SACSD_OP_MAX + 1];
+
+static const char *op_names[] = {
+    "hello", "lookup", "list", "read", "import", "export", "mkdir", "delete"
+};
+
+// --- E/S NO SOCKET ---
+
+static int recv_full(int fd, void *buf, size_t len) {
+    char *p = buf;
+    while (len > 0) {
+        ssize_t n = recv(fd, p, len, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 0;
+        p += n;
+        len -= (size_t)n;
+    }
+    return 1;
+}
+
+static int send_full(int fd, const void *buf, size_t len) {
+    const char *p = buf;
+    while (len > 0) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 0;
+        p += n;
+        len -= (size_t)n;
+    }
+    return 1;
+}
+
+// Envia o cabeçalho da resposta. Retorna status, ou SACSD_EPROTO se a conexão caiu
+static int send_reply(int fd, int status, uint32_t count, uint64_t length) {
+    struct sacsd_reply rep = { status, count, length };
+    return send_full(fd, &rep, sizeof(rep)) ? status : SACSD_EPROTO;
+}
+
+// --- VOLUME (chamadas com volume_lock) ---
+
+static void mutation_begin(void) {
+    __atomic_add_fetch(&volume_seq, 1, __ATOMIC_SEQ_CST);
+}
+
+// Descarrega o stdio antes de liberar os leitores que usam pread
+static void mutation_end(void) {
+    fflush(volume);
+    __atomic_add_fetch(&volume_seq, 1, __ATOMIC_SEQ_CST);
+}
+
+// Resolve um caminho absoluto até o diretório que contém o último componente.
+// Com um snapshot montado o caminho é resolvido a partir da raiz congelada, como relativo
+// a ela: o ".." dessa raiz aponta para ela mesma e nada escapa para a árvore atual.
+static int resolve_locked(const char *path, struct dir_entry *parent, char *name) {
+    if (path[0] != '/') return SACSD_EINVAL;
+    int ok;
+    if (snapshot_mounted) {
+        while (*path == '/') path++;
+        ok = resolve_path(volume, &snapshot_root, &sup, path, parent, name);
+    } else {
+        struct dir_entry unused;   // cwd só é usado por caminhos relativos
+        ok = resolve_path(volume, &unused, &sup, path, parent, name);
+    }
+    return ok ? SACSD_OK : SACSD_ENOENT;
+}
+
+// Entrada final do caminho; "/" devolve o "." da raiz
+static int lookup_locked(const char *path, struct dir_entry *parent, char *name, struct dir_entry *out) {
+    int st = resolve_locked(path, parent, name);
+    if (st != SACSD_OK) return st;
+    if (name[0] == '\0') {
+        *out = *parent;
+        return SACSD_OK;
+    }
+    return (find_entry(volume, parent, name, real_block_size, out) >= 0) ? SACSD_OK : SACSD_ENOENT;
+}
+
+// Diretório pai existe e o nome está livre
+static int prepare_create(const char *path, struct dir_entry *parent, char *name) {
+    int st = resolve_locked(path, parent, name);
+    if (st != SACSD_OK) return st;
+    if (name[0] == '\0' || strcmp(name, ".") == 0 || strcmp(name, "..") == 0) return SACSD_EEXIST;
+    if (find_entry(volume, parent, name, real_block_size, NULL) >= 0) return SACSD_EEXIST;
+    return SACSD_OK;
+}
+
+// --- OPERAÇÕES ---
+
+static int serve_lookup(int fd, const char *path) {
+    struct dir_entry parent, entry;
+    char name[SACS_PATH_MAX];
+
+    pthread_mutex_lock(&volume_lock);
+    int st = lookup_locked(path, &parent, name, &entry);
+    pthread_mutex_unlock(&volume_lock);
+
+    if (st != SACSD_OK) return send_reply(fd, st, 0, 0);
+    if (send_reply(fd, st, 1, sizeof(entry)) != SACSD_OK) return SACSD_EPROTO;
+    return send_full(fd, &entry, sizeof(entry)) ? SACSD_OK : SACSD_EPROTO;
+}
+
+static int serve_list(int fd, const char *path) {
+    struct dir_entry parent, dir;
+    char name[SACS_PATH_MAX];
+    struct dir_entry *entries = NULL;
+    uint32_t count = 0;
+
+    pthread_mutex_lock(&volume_lock);
+    int st = lookup_locked(path, &parent, name, &dir);
+    if (st == SACSD_OK && dir.file_type != TYPE_DIR) st = SACSD_ENOTDIR;
+    if (st == SACSD_OK) {
+        // Entradas contíguas no extent do diretório: leitura sequencial pelo buffer do stdio
+        unsigned long max_entries = (unsigned long)dir.length * real_block_size / ENTRY_SIZE;
+        entries = malloc(max_entries * sizeof(*entries));
+        fseek(volume, (long)(dir.start_block * real_block_size), SEEK_SET);
+        for (unsigned long i = 0; entries && i < max_entries; i++) {
+            if (!read_entry(volume, &entries[count])) break;
+            if (entries[count].status == STATUS_VALID) count++;
+        }
+        if (!entries) st = SACSD_EFAIL;
+    }
+    pthread_mutex_unlock(&volume_lock);
+
+    if (st != SACSD_OK) return send_reply(fd, st, 0, 0);
+    uint64_t bytes = (uint64_t)count * sizeof(*entries);
+    int ok = send_reply(fd, st, count, bytes) == SACSD_OK && send_full(fd, entries, bytes);
+    free(entries);
+    return ok ? SACSD_OK : SACSD_EPROTO;
+}
+
+// READ e EXPORT. A entrada é resolvida uma vez; cada trecho é lido sem o lock e
+// conferido contra volume_seq. Se o arquivo foi trocado no meio, a conexão é encerrada
+// (o cabeçalho com o tamanho já foi enviado). ra acompanha a conexão: READs seguidos
+// sobre o mesmo arquivo continuam a mesma sequência de leitura antecipada.
+static int serve_read(int fd, const char *path, uint64_t offset, uint64_t length, int whole,
+                      struct prefetch_stream *ra) {
+    struct dir_entry parent, entry;
+    char name[SACS_PATH_MAX];
+
+    pthread_mutex_lock(&volume_lock);
+    int st = lookup_locked(path, &parent, name, &entry);
+    if (st == SACSD_OK && !is_regular_file(&entry)) {
+        st = (entry.file_type == TYPE_DIR) ? SACSD_EISDIR : SACSD_EINVAL;
+    }
+    uint64_t seq = volume_seq;
+    uint64_t data_pos = entry_data_pos(&entry, real_block_size);
+    pthread_mutex_unlock(&volume_lock);
+    if (st != SACSD_OK) return send_reply(fd, st, 0, 0);
+
+    if (whole) {
+        offset = 0;
+        length = entry.size;
+    }
+    if (offset >= entry.size) length = 0;
+    else if (length > entry.size - offset) length = entry.size - offset;
+    if (send_reply(fd, SACSD_OK, 0, length) != SACSD_OK) return SACSD_EPROTO;
+    if (ra->start != data_pos || ra->end != data_pos + entry.size) {
+        prefetch_begin(ra, data_fd, data_pos, data_pos + entry.size);
+    }
+
+    char *buf = malloc(length < STREAM_CHUNK ? (length ? length : 1) : STREAM_CHUNK);
+    if (!buf) return SACSD_EPROTO;
+
+    uint64_t done = 0;
+    while (done < length) {
+        size_t chunk = (length - done < STREAM_CHUNK) ? (size_t)(length - done) : STREAM_CHUNK;
+        off_t pos = (off_t)(data_pos + offset + done);
+        int fresh = 0;
+
+        prefetch_access(ra, (uint64_t)pos, chunk);
+        if (data_fd >= 0 && pread(data_fd, buf, chunk, pos) == (ssize_t)chunk) {
+            fresh = (__atomic_load_n(&volume_seq, __ATOMIC_SEQ_CST) == seq);
+        }
+        if (!fresh) {
+            pthread_mutex_lock(&volume_lock);
+            if (volume_seq != seq) {
+                struct dir_entry now;
+                if (lookup_locked(path, &parent, name, &now) != SACSD_OK ||
+                    now.file_type != entry.file_type || now.start_block != entry.start_block ||
+                    now.length != entry.length || now.size != entry.size) {
+                    pthread_mutex_unlock(&volume_lock);
+                    free(buf);
+                    return SACSD_EPROTO;
+                }
+                seq = volume_seq;
+            }
+            fseek(volume, pos, SEEK_SET);
+            fresh = (fread(buf, 1, chunk, volume) == chunk);
+            pthread_mutex_unlock(&volume_lock);
+        }
+        if (!fresh || !send_full(fd, buf, chunk)) {
+            free(buf);
+            return SACSD_EPROTO;
+        }
+        done += chunk;
+    }
+    free(buf);
+    return SACSD_OK;
+}
+
+// Os dados chegam antes do lock ser pego: um cliente lento não segura o volume.
+// Até SACSD_INLINE_MAX ficam em memória; acima disso vão para um arquivo temporário
+// que é importado em fluxo.
+static int serve_import(int fd, const char *path, uint64_t length) {
+    char *data = NULL;
+    FILE *spool = NULL;
+
+    if (length <= SACSD_INLINE_MAX) {
+        data = malloc(length ? length : 1);
+        if (!data || !recv_full(fd, data, length)) {
+            free(data);
+            return SACSD_EPROTO;
+        }
+    } else {
+        spool = tmpfile();
+        char *buf = malloc(STREAM_CHUNK);
+        uint64_t left = length;
+        while (spool && buf && left > 0) {
+            size_t chunk = (left < STREAM_CHUNK) ? (size_t)left : STREAM_CHUNK;
+            if (!recv_full(fd, buf, chunk) || fwrite(buf, 1, chunk, spool) != chunk) break;
+            left -= chunk;
+        }
+        free(buf);
+        if (!spool || left > 0 || fflush(spool) != 0) {
+            if (spool) fclose(spool);
+            return SACSD_EPROTO;
+        }
+        rewind(spool);
+    }
+
+    struct dir_entry parent;
+    char name[SACS_PATH_MAX];
+
+    pthread_mutex_lock(&volume_lock);
+    int st = prepare_create(path, &parent, name);
+    if (st == SACSD_OK) {
+        int ok;
+        mutation_begin();
+        if (spool) {
+            ok = import_stream(volume, &parent, &sup, fileno(spool), name, NULL);
+        } else {
+            create_file(volume, &parent, &sup, name, length, data);
+            ok = find_entry(volume, &parent, name, real_block_size, NULL) >= 0;
+        }
+        mutation_end();
+        if (!ok) st = SACSD_EFAIL;
+    }
+    pthread_mutex_unlock(&volume_lock);
+
+    free(data);
+    if (spool) fclose(spool);
+    return send_reply(fd, st, 0, 0);
+}
+
+static int serve_mkdir(int fd, const char *path) {
+    struct dir_entry parent;
+    char name[SACS_PATH_MAX];
+
+    pthread_mutex_lock(&volume_lock);
+    int st = prepare_create(path, &parent, name);
+    if (st == SACSD_OK) {
+        mutation_begin();
+        create_dir(volume, &parent, &sup, name);
+        if (find_entry(volume, &parent, name, real_block_size, NULL) < 0) st = SACSD_EFAIL;
+        mutation_end();
+    }
+    pthread_mutex_unlock(&volume_lock);
+    return send_reply(fd, st, 0, 0);
+}
+
+static int serve_delete(int fd, const char *path, int recursive) {
+    struct dir_entry parent, entry;
+    char name[SACS_PATH_MAX];
+
+    pthread_mutex_lock(&volume_lock);
+    int st = lookup_locked(path, &parent, name, &entry);
+    if (st == SACSD_OK && (name[0] == '\0' || strcmp(name, ".") == 0 || strcmp(name, "..") == 0)) {
+        st = SACSD_EINVAL;
+    }
+    if (st == SACSD_OK) {
+        mutation_begin();
+        int ok = recursive ? delete_tree(volume, &parent, &sup, name)
+                           : delete_item(volume, &parent, &sup, name);
+        mutation_end();
+        if (!ok) st = SACSD_EFAIL;
+    }
+    pthread_mutex_unlock(&volume_lock);
+    return send_reply(fd, st, 0, 0);
+}
+
+// --- CONEXÕES ---
+
+static void *client_thread(void *arg) {
+    int fd = (int)(intptr_t)arg;
+    struct sacsd_request req;
+    char path[SACS_PATH_MAX];
+    struct prefetch_stream ra;
+    prefetch_begin(&ra, -1, 0, 0);
+
+    while (recv_full(fd, &req, sizeof(req))) {
+        if (req.path_len >= SACS_PATH_MAX || !recv_full(fd, path, req.path_len)) break;
+        path[req.path_len] = '\0';
+
+        int st;
+        switch (req.op) {
+            case SACSD_OP_HELLO:
+                st = (req.offset == SACSD_MAGIC && req.length == SACSD_VERSION) ? SACSD_OK : SACSD_EINVAL;
+                st = send_reply(fd, st, 0, 0);
+                break;
+            case SACSD_OP_LOOKUP: st = serve_lookup(fd, path); break;
+            case SACSD_OP_LIST:   st = serve_list(fd, path); break;
+            case SACSD_OP_READ:   st = serve_read(fd, path, req.offset, req.length, 0, &ra); break;
+            case SACSD_OP_EXPORT: st = serve_read(fd, path, 0, 0, 1, &ra); break;
+            case SACSD_OP_IMPORT: st = serve_import(fd, path, req.length); break;
+            case SACSD_OP_MKDIR:  st = serve_mkdir(fd, path); break;
+            case SACSD_OP_DELETE: st = serve_delete(fd, path, req.flags & SACSD_F_RECURSIVE); break;
+            default:
+                st = send_reply(fd, SACSD_EINVAL, 0, 0);
+                break;
+        }
+        if (st == SACSD_EPROTO) break;
+        if (req.op <= SACSD_OP_MAX) {
+            __atomic_add_fetch(&served[req.op], 1, __ATOMIC_RELAXED);
+            if (st != SACSD_OK) __atomic_add_fetch(&failed[req.op], 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    close(fd);
+    __atomic_sub_fetch(&active_clients, 1, __ATOMIC_SEQ_CST);
+    return NULL;
+}
+
+static void on_signal(int sig) {
+    (void)sig;
+    stopping = 1;
+}
+
+// Cria o socket de escuta. Um caminho antigo só é removido se ninguém responde nele
+static int listen_on(const char *socket_path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Erro: Caminho do socket muito longo.\n");
+        return -1;
+    }
+    strcpy(addr.sun_path, socket_path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+        fprintf(stderr, "Erro: Ja existe um servidor em '%s'.\n", socket_path);
+        close(fd);
+        return -1;
+    }
+    unlink(socket_path);
+
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        perror("bind/listen");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        printf("Uso: %s <imagem> <socket> [-v]\n", argv[0]);
+        return 1;
+    }
+    int verbose = (argc > 3 && strcmp(argv[3], "-v") == 0);
+
+    char *prefetch_mode = getenv("SACS_PREFETCH");
+    char *prefetch_max = getenv("SACS_PREFETCH_MAX");
+    if (prefetch_mode || prefetch_max) {
+        prefetch_configure(!(prefetch_mode && strcmp(prefetch_mode, "0") == 0),
+                           prefetch_max ? (unsigned)atoi(prefetch_max) : PREFETCH_DEFAULT_MAX);
+    }
+
+    char *trace_path = getenv("SACS_TRACE");
+    if (trace_path && trace_start(trace_path)) {
+        printf("Gravando trace em '%s'\n", trace_path);
+    }
+
+    volume = volume_open(argv[1], "r+b");
+    if (!volume) {
+        perror("Erro ao abrir imagem");
+        return 1;
+    }
+
+    int policy = parse_alloc_policy(getenv("SACS_ALLOC"));
+    char *snapshot_name = getenv("SACS_SNAPSHOT");
+    snapshot_mounted = (snapshot_name && *snapshot_name);
+    int mounted = snapshot_mounted
+                  ? mount_snapshot(volume, &sup, policy, snapshot_name, &snapshot_root)
+                  : mount_sacs(volume, &sup, policy);
+    if (!mounted) {
+        fclose(volume);
+        return 1;
+    }
+    if (snapshot_mounted) strcpy(snapshot_root.file_name, "/");
+    real_block_size = (1 << sup.sector_size) << sup.block_size;
+    if (!stripe_is(volume)) data_fd = fileno(volume);
+
+    int listen_fd = listen_on(argv[2]);
+    if (listen_fd < 0) {
+        fclose(volume);
+        return 1;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;   // Sem SA_RESTART: accept volta com EINTR
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    fprintf(stderr, "sacsd: '%s' montado (%s%s), ouvindo em '%s'\n", argv[1], alloc_policy_name(policy),
+            snapshot_mounted ? ", snapshot" : "", argv[2]);
+    fflush(stdout);
+    if (!verbose && !freopen("/dev/null", "w", stdout)) {
+        perror("freopen");
+    }
+
+    while (!stopping) {
+        int fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0) {
+            if (errno != EINTR) perror("accept");
+            continue;
+        }
+        if (__atomic_add_fetch(&active_clients, 1, __ATOMIC_SEQ_CST) > SACSD_MAX_CLIENTS) {
+            __atomic_sub_fetch(&active_clients, 1, __ATOMIC_SEQ_CST);
+            close(fd);
+            continue;
+        }
+
+        pthread_t tid;
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        if (pthread_create(&tid, &attr, client_thread, (void *)(intptr_t)fd) != 0) {
+            __atomic_sub_fetch(&active_clients, 1, __ATOMIC_SEQ_CST);
+            close(fd);
+        }
+        pthread_attr_destroy(&attr);
+    }
+
+    // Espera a operação em andamento terminar; as conexões abertas morrem com o processo
+    close(listen_fd);
+    unlink(argv[2]);
+    pthread_mutex_lock(&volume_lock);
+    fflush(volume);
+    trace_stop();
+
+    fprintf(stderr, "\n--- SACSD ---\n%-8s %10s %8s\n", "Operacao", "Pedidos", "Erros");
+    for (int op = 0; op <= SACSD_OP_MAX; op++) {
+        unsigned long n = __atomic_load_n(&served[op], __ATOMIC_RELAXED);
+        if (n) fprintf(stderr, "%-8s %10lu %8lu\n", op_names[op], n, __atomic_load_n(&failed[op], __ATOMIC_RELAXED));
+    }
+    fclose(volume);
+    return 0;
+}
@@ -0,0 +1,57 @@
+#ifndef SACSD_H
+#define SACSD_H
+
+#include <stdint.h>
+#include "sacs.h"
+
+// --- PROTOCOLO DO SERVIDOR LOCAL (sacsd) ---
+// Cada pedido é um cabeçalho fixo, o caminho (path_len bytes, sem '\0') e, no import,
+// length bytes de dados. Cada resposta é um cabeçalho fixo seguido de length bytes:
+// entradas de diretório (struct dir_entry, 64 bytes, layout v2) ou dados do arquivo.
+// Caminhos são sempre absolutos dentro da imagem.
+
+#define SACSD_MAGIC 0x44434153   // "SACD"
+#define SACSD_VERSION 1
+
+// Operações
+#define SACSD_OP_HELLO 0         // Confere magic e versão (offset = magic, length = versão)
+#define SACSD_OP_LOOKUP 1        // Uma entrada
+#define SACSD_OP_LIST 2          // Entradas válidas do diretório (inclui "." e "..")
+#define SACSD_OP_READ 3          // length bytes a partir de offset
+#define SACSD_OP_IMPORT 4        // Cria o arquivo com os length bytes que seguem o caminho
+#define SACSD_OP_EXPORT 5        // Arquivo inteiro
+#define SACSD_OP_MKDIR 6
+#define SACSD_OP_DELETE 7        // SACSD_F_RECURSIVE remove a subárvore
+#define SACSD_OP_MAX SACSD_OP_DELETE
+
+#define SACSD_F_RECURSIVE 0x0001
+
+// Estados da resposta (0 = sucesso)
+#define SACSD_OK 0
+#define SACSD_ENOENT -1          // Caminho não existe
+#define SACSD_EEXIST -2          // Nome já existe
+#define SACSD_ENOTDIR -3         // Esperava um diretório
+#define SACSD_EISDIR -4          // Esperava um arquivo
+#define SACSD_EINVAL -5          // Pedido inválido (caminho relativo, nome longo, ...)
+#define SACSD_EFAIL -6           // A operação falhou no volume (sem espaço, somente leitura)
+#define SACSD_EPROTO -7          // Conexão perdida ou resposta malformada (só no cliente)
+
+#define SACSD_MAX_CLIENTS 256
+#define SACSD_INLINE_MAX STREAM_CHUNK   // Imports maiores passam por um arquivo temporário
+
+struct __attribute__((__packed__)) sacsd_request {
+    uint16_t op;
+    uint16_t flags;
+    uint16_t path_len;
+    uint16_t reserved;
+    uint64_t offset;
+    uint64_t length;
+};
+
+struct __attribute__((__packed__)) sacsd_reply {
+    int32_t status;
+    uint32_t count;          // LOOKUP/LIST: entradas que seguem
+    uint64_t length;         // Bytes que seguem o cabeçalho
+};
+
+#endif // SACSD_H
@@ -0,0 +1,369 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "stripe.h"
+
+#define STRIPE_MAX_OPEN 8
+#define STRIPE_COPY_CHUNK (1024 * 1024)
+
+// Volume aberto: um descritor por membro e a posição lógica corrente
+struct stripe {
+    int fds[STRIPE_MAX_MEMBERS];
+    unsigned members;
+    unsigned unit;
+    off_t pos;
+};
+
+// Configuração global
+static unsigned cfg_unit = STRIPE_DEFAULT_UNIT;
+
+// FILE* abertos por volume_open que são volumes em faixas
+static struct {
+    FILE *fp;
+    struct stripe *s;
+} open_volumes[STRIPE_MAX_OPEN];
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void stripe_configure(unsigned unit) {
+    if (unit < STRIPE_ALIGN) unit = STRIPE_DEFAULT_UNIT;
+    cfg_unit = (unit + STRIPE_ALIGN - 1) / STRIPE_ALIGN * STRIPE_ALIGN;
+}
+
+// --- MAPEAMENTO ---
+
+// Converte a posição lógica em (membro, offset no membro); retorna quantos bytes
+// seguem contíguos no mesmo membro
+static size_t stripe_map(struct stripe *s, off_t logical, unsigned *member, off_t *member_off) {
+    uint64_t stripe = (uint64_t)logical / s->unit;
+    unsigned inside = (unsigned)((uint64_t)logical % s->unit);
+    *member = (unsigned)(stripe % s->members);
+    *member_off = STRIPE_HEADER_SIZE + (off_t)(stripe / s->members) * s->unit + inside;
+    return s->unit - inside;
+}
+
+// --- FUNÇÕES DO FILE* (fopencookie) ---
+
+static ssize_t cookie_read(void *cookie, char *buf, size_t size) {
+    struct stripe *s = cookie;
+    size_t done = 0;
+    while (done < size) {
+        unsigned member;
+        off_t member_off;
+        size_t run = stripe_map(s, s->pos, &member, &member_off);
+        if (run > size - done) run = size - done;
+
+        ssize_t r = pread(s->fds[member], buf + done, run, member_off);
+        if (r < 0) return done ? (ssize_t)done : -1;
+        if (r == 0) break;   // Fim do volume
+        done += (size_t)r;
+        s->pos += r;
+    }
+    return (ssize_t)done;
+}
+
+static ssize_t cookie_write(void *cookie, const char *buf, size_t size) {
+    struct stripe *s = cookie;
+    size_t done = 0;
+    while (done < size) {
+        unsigned member;
+        off_t member_off;
+        size_t run = stripe_map(s, s->pos, &member, &member_off);
+        if (run > size - done) run = size - done;
+
+        ssize_t w = pwrite(s->fds[member], buf + done, run, member_off);
+        if (w <= 0) return done ? (ssize_t)done : -1;
+        done += (size_t)w;
+        s->pos += w;
+    }
+    return (ssize_t)done;
+}
+
+// Tamanho lógico: soma das áreas de dados dos membros
+static off_t stripe_size(struct stripe *s) {
+    off_t total = 0;
+    for (unsigned i = 0; i < s->members; i++) {
+        struct stat sb;
+        if (fstat(s->fds[i], &sb) == 0 && sb.st_size > STRIPE_HEADER_SIZE) {
+            total += sb.st_size - STRIPE_HEADER_SIZE;
+        }
+    }
+    return total;
+}
+
+static int cookie_seek(void *cookie, off64_t *offset, int whence) {
+    struct stripe *s = cookie;
+    off_t base = (whence == SEEK_SET) ? 0 : (whence == SEEK_CUR) ? s->pos : stripe_size(s);
+    if (base + *offset < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    s->pos = base + *offset;
+    *offset = s->pos;
+    return 0;
+}
+
+static int cookie_close(void *cookie) {
+    struct stripe *s = cookie;
+    for (unsigned i = 0; i < STRIPE_MAX_OPEN; i++) {
+        if (open_volumes[i].s == s) {
+            open_volumes[i].fp = NULL;
+            open_volumes[i].s = NULL;
+        }
+    }
+    for (unsigned i = 0; i < s->members; i++) close(s->fds[i]);
+    free(s);
+    return 0;
+}
+
+// --- ABERTURA ---
+
+static void stripe_close_members(struct stripe *s, unsigned count) {
+    for (unsigned i = 0; i < count; i++) close(s->fds[i]);
+    free(s);
+}
+
+static FILE *stripe_open(const char *path, const char *mode) {
+    char list[1024];
+    if (strlen(path) >= sizeof(list)) {
+        errno = ENAMETOOLONG;
+        return NULL;
+    }
+    strcpy(list, path);
+
+    char *names[STRIPE_MAX_MEMBERS];
+    unsigned count = 0;
+    for (char *tok = strtok(list, ","); tok; tok = strtok(NULL, ",")) {
+        if (count == STRIPE_MAX_MEMBERS) {
+            printf("Erro: Volume em faixas aceita no maximo %d imagens.\n", STRIPE_MAX_MEMBERS);
+            errno = EINVAL;
+            return NULL;
+        }
+        names[count++] = tok;
+    }
+    if (count == 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    // Sem posição na tabela o FILE* não seria reconhecido por stripe_is: recusa antes
+    // de abrir (e, na criação, truncar) qualquer imagem
+    unsigned slot = 0;
+    while (slot < STRIPE_MAX_OPEN && open_volumes[slot].fp) slot++;
+    if (slot == STRIPE_MAX_OPEN) {
+        printf("Erro: Limite de %d volumes em faixas abertos atingido.\n", STRIPE_MAX_OPEN);
+        errno = EMFILE;
+        return NULL;
+    }
+
+    int creating = (mode[0] == 'w');
+    int flags = creating ? (O_RDWR | O_CREAT | O_TRUNC) : (strchr(mode, '+') ? O_RDWR : O_RDONLY);
+
+    struct stripe *s = calloc(1, sizeof(*s));
+    if (!s) return NULL;
+    s->members = count;
+
+    struct stripe_header hdr;
+    uint64_t volume_id = ((uint64_t)time(NULL) << 20) ^ (uint64_t)getpid() ^ ((uint64_t)rand() << 32);
+
+    for (unsigned i = 0; i < count; i++) {
+        s->fds[i] = open(names[i], flags, 0644);
+        if (s->fds[i] < 0) {
+            stripe_close_members(s, i);
+            return NULL;
+        }
+
+        if (creating) {
+            unsigned char block[STRIPE_HEADER_SIZE];
+            memset(block, 0, sizeof(block));
+            memset(&hdr, 0, sizeof(hdr));
+            hdr.magic = STRIPE_MAGIC;
+            hdr.version = STRIPE_VERSION;
+            hdr.members = (uint16_t)count;
+            hdr.index = (uint16_t)i;
+            hdr.unit = cfg_unit;
+            hdr.volume_id = volume_id;
+            memcpy(block, &hdr, sizeof(hdr));
+            if (pwrite(s->fds[i], block, sizeof(block), 0) != (ssize_t)sizeof(block)) {
+                stripe_close_members(s, i + 1);
+                return NULL;
+            }
+            s->unit = cfg_unit;
+            continue;
+        }
+
+        // Confere se as imagens formam o mesmo volume, na mesma ordem
+        if (pread(s->fds[i], &hdr, sizeof(hdr), 0) != (ssize_t)sizeof(hdr) || hdr.magic != STRIPE_MAGIC) {
+            printf("Erro: '%s' nao e membro de um volume em faixas.\n", names[i]);
+        } else if (hdr.unit == 0 || hdr.unit % STRIPE_ALIGN != 0) {
+            printf("Erro: '%s' tem tamanho de faixa invalido (%u bytes).\n", names[i], hdr.unit);
+        } else if (hdr.members != count || hdr.index != i) {
+            printf("Erro: '%s' e o membro %u de %u, mas foi passado na posicao %u de %u.\n",
+                   names[i], hdr.index + 1, hdr.members, i + 1, count);
+        } else if (i > 0 && (hdr.volume_id != volume_id || hdr.unit != s->unit)) {
+            printf("Erro: '%s' pertence a outro volume.\n", names[i]);
+        } else {
+            volume_id = hdr.volume_id;
+            s->unit = hdr.unit;
+            continue;
+        }
+        stripe_close_members(s, i + 1);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    cookie_io_functions_t io = { cookie_read, cookie_write, cookie_seek, cookie_close };
+    FILE *fp = fopencookie(s, mode, io);
+    if (!fp) {
+        stripe_close_members(s, count);
+        return NULL;
+    }
+
+    open_volumes[slot].fp = fp;
+    open_volumes[slot].s = s;
+    return fp;
+}
+
+FILE *volume_open(const char *path, const char *mode) {
+    if (!strchr(path, STRIPE_SEPARATOR)) return fopen(path, mode);
+    return stripe_open(path, mode);
+}
+
+static struct stripe *stripe_of(FILE *fp) {
+    for (unsigned i = 0; i < STRIPE_MAX_OPEN; i++) {
+        if (open_volumes[i].fp == fp) return open_volumes[i].s;
+    }
+    return NULL;
+}
+
+int stripe_is(FILE *fp) {
+    return stripe_of(fp) != NULL;
+}
+
+// --- CÓPIA PARALELA ---
+
+// Uma thread por membro: percorre só as faixas que caem nele
+struct stripe_job {
+    struct stripe *s;
+    unsigned member;
+    int host_fd;
+    off_t vol_off, host_off;
+    unsigned long len;
+    int to_volume;
+    unsigned long bytes, segments;
+    int error;
+};
+
+static void *stripe_worker(void *arg) {
+    struct stripe_job *job = arg;
+    struct stripe *s = job->s;
+    size_t buf_size = (s->unit < STRIPE_COPY_CHUNK) ? s->unit : STRIPE_COPY_CHUNK;
+    unsigned char *buf = malloc(buf_size);
+    if (!buf) { job->error = 1; return NULL; }
+
+    off_t end = job->vol_off + (off_t)job->len;
+    uint64_t first = (uint64_t)job->vol_off / s->unit;
+    uint64_t last = (uint64_t)(end - 1) / s->unit;
+    uint64_t k = first + (job->member + s->members - first % s->members) % s->members;
+
+    for (; k <= last && !job->error; k += s->members) {
+        off_t seg_start = (off_t)(k * s->unit);
+        off_t seg_end = seg_start + s->unit;
+        if (seg_start < job->vol_off) seg_start = job->vol_off;
+        if (seg_end > end) seg_end = end;
+
+        unsigned member;
+        off_t member_off;
+        stripe_map(s, seg_start, &member, &member_off);
+        int fd = s->fds[member];
+        off_t host_pos = job->host_off + (seg_start - job->vol_off);
+
+        for (off_t done = 0; done < seg_end - seg_start; ) {
+            size_t chunk = (size_t)(seg_end - seg_start - done);
+            if (chunk > buf_size) chunk = buf_size;
+            int in_fd = job->to_volume ? job->host_fd : fd;
+            off_t in_off = job->to_volume ? host_pos + done : member_off + done;
+            int out_fd = job->to_volume ? fd : job->host_fd;
+            off_t out_off = job->to_volume ? member_off + done : host_pos + done;
+
+            ssize_t r = pread(in_fd, buf, chunk, in_off);
+            if (r <= 0) { job->error = 1; break; }
+            for (ssize_t w = 0; w < r; ) {
+                ssize_t n = pwrite(out_fd, buf + w, (size_t)(r - w), out_off + w);
+                if (n <= 0) { job->error = 1; break; }
+                w += n;
+            }
+            done += r;
+            job->bytes += (unsigned long)r;
+        }
+        job->segments++;
+    }
+    free(buf);
+    return NULL;
+}
+
+int stripe_copy(FILE *vol, off_t vol_off, int host_fd, off_t host_off,
+                unsigned long len, int to_volume, struct stripe_stats *stats) {
+    struct stripe *s = stripe_of(vol);
+    if (!s || host_fd < 0) return -1;
+
+    struct stripe_stats st;
+    memset(&st, 0, sizeof(st));
+    st.members = s->members;
+    if (len == 0) {
+        if (stats) *stats = st;
+        return 0;
+    }
+
+    // O buffer do FILE* precisa estar vazio: a cópia fala direto com os membros
+    fflush(vol);
+
+    struct stripe_job jobs[STRIPE_MAX_MEMBERS];
+    pthread_t threads[STRIPE_MAX_MEMBERS];
+    int started[STRIPE_MAX_MEMBERS];
+    uint64_t t0 = now_ns();
+
+    for (unsigned i = 0; i < s->members; i++) {
+        memset(&jobs[i], 0, sizeof(jobs[i]));
+        jobs[i].s = s;
+        jobs[i].member = i;
+        jobs[i].host_fd = host_fd;
+        jobs[i].vol_off = vol_off;
+        jobs[i].host_off = host_off;
+        jobs[i].len = len;
+        jobs[i].to_volume = to_volume;
+        started[i] = (pthread_create(&threads[i], NULL, stripe_worker, &jobs[i]) == 0);
+        if (!started[i]) stripe_worker(&jobs[i]);   // Sem thread: faz no chamador
+    }
+
+    int error = 0;
+    for (unsigned i = 0; i < s->members; i++) {
+        if (started[i]) pthread_join(threads[i], NULL);
+        error |= jobs[i].error;
+        st.bytes += jobs[i].bytes;
+        st.segments += jobs[i].segments;
+    }
+    st.elapsed_ns = now_ns() - t0;
+
+    if (stats) *stats = st;
+    return error ? -1 : 0;
+}
+
+void stripe_print_stats(const struct stripe_stats *stats) {
+    double secs = stats->elapsed_ns / 1e9;
+    double mbps = (secs > 0) ? (stats->bytes / (1024.0 * 1024.0)) / secs : 0;
+    printf("[STRIPE x%u] %lu bytes em %.3f ms | %.1f MB/s | %lu trechos de faixa\n",
+           stats->members, stats->bytes, stats->elapsed_ns / 1e6, mbps, stats->segments);
+}
@@ -0,0 +1,57 @@
+#ifndef STRIPE_H
+#define STRIPE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+// --- CONFIGURAÇÕES DO VOLUME EM FAIXAS ---
+// Um volume em faixas é aberto por uma lista de imagens separadas por vírgula
+// ("a.img,b.img,c.img"). Cada imagem começa com um cabeçalho próprio; o volume
+// lógico é distribuído em faixas de 'unit' bytes, em rodízio entre os membros.
+#define STRIPE_MAGIC 0x50525453          // "STRP"
+#define STRIPE_VERSION 1
+#define STRIPE_HEADER_SIZE 4096          // Mantém os dados dos membros alinhados
+#define STRIPE_MAX_MEMBERS 16
+#define STRIPE_ALIGN 4096
+#define STRIPE_DEFAULT_UNIT (64 * 1024)
+#define STRIPE_SEPARATOR ','
+
+// --- ESTRUTURAS ---
+
+// Cabeçalho no início de cada imagem membro
+struct __attribute__((__packed__)) stripe_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t members;         // Quantidade de imagens do volume
+    uint16_t index;           // Posição desta imagem na lista
+    uint16_t reserved;
+    uint32_t unit;            // Tamanho da faixa em bytes
+    uint64_t volume_id;       // Igual em todos os membros do mesmo volume
+};
+
+// Resultado de uma cópia paralela
+struct stripe_stats {
+    unsigned members;
+    unsigned long bytes;
+    uint64_t elapsed_ns;
+    unsigned long segments;   // Trechos de faixa transferidos
+};
+
+// --- PROTÓTIPOS DAS FUNÇÕES ---
+
+// Tamanho da faixa para volumes novos (lido de SACS_STRIPE_UNIT pelo main)
+void stripe_configure(unsigned unit);
+
+// Abre uma imagem simples (fopen) ou, se o caminho tiver vírgulas, um volume em faixas.
+// Modo "wb" cria os membros e grava os cabeçalhos.
+FILE *volume_open(const char *path, const char *mode);
+int stripe_is(FILE *fp);
+
+// Copia len bytes entre o volume (vol_off) e um descritor externo (host_off), uma thread
+// por membro. to_volume = 1 para importar, 0 para exportar. Retorna 0 ou -1.
+int stripe_copy(FILE *vol, off_t vol_off, int host_fd, off_t host_off,
+                unsigned long len, int to_volume, struct stripe_stats *stats);
+void stripe_print_stats(const struct stripe_stats *stats);
+
+#endif // STRIPE_H
@@ -0,0 +1,93 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include "trace.h"
+
+// Arquivo de trace ativo (NULL = desligado)
+static FILE *trace_fp = NULL;
+static uint64_t trace_t0 = 0;
+
+uint64_t trace_clock(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Abre o log binário e grava o cabeçalho
+int trace_start(const char *path) {
+    if (trace_fp) trace_stop();
+
+    trace_fp = fopen(path, "wb");
+    if (!trace_fp) {
+        perror("Erro ao criar arquivo de trace");
+        return 0;
+    }
+
+    struct trace_header hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = TRACE_MAGIC;
+    hdr.version = TRACE_VERSION;
+    hdr.start_ns = trace_clock();
+    trace_t0 = hdr.start_ns;
+
+    fwrite(&hdr, sizeof(hdr), 1, trace_fp);
+    return 1;
+}
+
+void trace_stop(void) {
+    if (!trace_fp) return;
+    fclose(trace_fp);
+    trace_fp = NULL;
+}
+
+int trace_enabled(void) {
+    return trace_fp != NULL;
+}
+
+// Grava uma chamada. t0 é o valor de trace_clock() no início da chamada
+void trace_record(uint8_t op, int result, uint32_t parent_block, const char *name,
+                  const char *arg, uint64_t size, uint64_t t0) {
+    if (!trace_fp) return;
+
+    uint64_t now = trace_clock();
+    size_t name_len = name ? strlen(name) : 0;
+    size_t arg_len = arg ? strlen(arg) : 0;
+    if (name_len > 255) name_len = 255;
+    if (arg_len > 255) arg_len = 255;
+
+    struct trace_record rec;
+    rec.op = op;
+    rec.result = (int8_t)result;
+    rec.name_len = (uint8_t)name_len;
+    rec.arg_len = (uint8_t)arg_len;
+    rec.parent_block = parent_block;
+    rec.size = size;
+    rec.offset_ns = (t0 > trace_t0) ? t0 - trace_t0 : 0;
+    rec.elapsed_ns = now - t0;
+
+    fwrite(&rec, sizeof(rec), 1, trace_fp);
+    if (name_len) fwrite(name, 1, name_len, trace_fp);
+    if (arg_len) fwrite(arg, 1, arg_len, trace_fp);
+}
+
+// Retorna 1 se o cabeçalho é válido
+int trace_read_header(FILE *fp, struct trace_header *hdr) {
+    if (fread(hdr, sizeof(*hdr), 1, fp) != 1) return 0;
+    if (hdr->magic != TRACE_MAGIC || hdr->version != TRACE_VERSION) return 0;
+    return 1;
+}
+
+// Lê o próximo registro. name e arg devem ter pelo menos 256 bytes. Retorna 0 no fim do log
+int trace_read_record(FILE *fp, struct trace_record *rec, char *name, char *arg) {
+    if (fread(rec, sizeof(*rec), 1, fp) != 1) return 0;
+
+    if (rec->name_len && fread(name, 1, rec->name_len, fp) != rec->name_len) return 0;
+    name[rec->name_len] = '\0';
+
+    if (rec->arg_len && fread(arg, 1, rec->arg_len, fp) != rec->arg_len) return 0;
+    arg[rec->arg_len] = '\0';
+
+    return 1;
+}
@@ -0,0 +1,62 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+// --- CONFIGURAÇÕES DO TRACE ---
+#define TRACE_MAGIC 0x54434153   // "SACT"
+#define TRACE_VERSION 1
+
+// Operações registradas (uma por função da API)
+#define TRACE_OP_CREATE_FILE 1
+#define TRACE_OP_IMPORT_FILE 2
+#define TRACE_OP_DELETE_ITEM 3
+#define TRACE_OP_CREATE_DIR  4
+#define TRACE_OP_CHANGE_DIR  5
+#define TRACE_OP_EXPORT_FILE 6
+#define TRACE_OP_APPEND_FILE 7
+#define TRACE_OP_TRUNCATE_FILE 8
+#define TRACE_OP_DELETE_TREE 9
+#define TRACE_OP_SNAPSHOT 10
+#define TRACE_OP_MOVE 11
+#define TRACE_OP_COPY 12
+#define TRACE_OP_IMPORT_STREAM 13
+#define TRACE_OP_MAX TRACE_OP_IMPORT_STREAM
+
+// --- ESTRUTURAS ---
+
+// Cabeçalho do arquivo de trace (gravado uma vez)
+struct __attribute__((__packed__)) trace_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    uint64_t start_ns;        // Relógio monotônico no início da gravação
+};
+
+// Registro de uma chamada. Seguido de name_len bytes (nome) e arg_len bytes (argumento extra)
+struct __attribute__((__packed__)) trace_record {
+    uint8_t op;
+    int8_t result;            // Retorno da chamada (1 = sucesso, 0 = falha)
+    uint8_t name_len;
+    uint8_t arg_len;
+    uint32_t parent_block;    // Diretório onde a operação foi executada
+    uint64_t size;            // Bytes envolvidos (arquivo criado/importado/exportado/removido)
+    uint64_t offset_ns;       // Início da chamada em relação ao início do trace
+    uint64_t elapsed_ns;      // Duração da chamada
+};
+
+// --- PROTÓTIPOS DAS FUNÇÕES ---
+
+int trace_start(const char *path);
+void trace_stop(void);
+int trace_enabled(void);
+uint64_t trace_clock(void);
+void trace_record(uint8_t op, int result, uint32_t parent_block, const char *name,
+                  const char *arg, uint64_t size, uint64_t t0);
+
+// Leitura (usado pelo replay)
+int trace_read_header(FILE *fp, struct trace_header *hdr);
+int trace_read_record(FILE *fp, struct trace_record *rec, char *name, char *arg);
+
+#endif // TRACE_H